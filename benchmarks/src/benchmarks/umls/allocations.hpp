@@ -0,0 +1,94 @@
+// allocations.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _BENCH_BENCHMARKS_UMLS_ALLOCATIONS_HPP_
+#define _BENCH_BENCHMARKS_UMLS_ALLOCATIONS_HPP_
+#include <benchmark/benchmark.h>
+#include <benchmarks/umls/catalog.hpp>
+#include <benchmarks/umls/catalog_generator.hpp>
+#include <umls/allocation_counter.hpp>
+#include <umls/catalog.hpp>
+#include <umls/format.hpp>
+#include <umls/translator.hpp>
+
+namespace mjx {
+    namespace bench {
+        // Note: These benchmarks run with the allocation counter installed, so their timings
+        //       include the counting overhead. Use them for allocs/op, not for ns/op.
+
+        inline void _Report_allocations(::benchmark::State& _State, const allocation_scope& _Scope) {
+            using _Counter                      = ::benchmark::Counter;
+            const allocation_statistics& _Stats = _Scope.statistics();
+            _State.counters["allocs/op"] =
+                _Counter(static_cast<double>(_Stats.allocations), _Counter::kAvgIterations);
+            _State.counters["bytes/op"] =
+                _Counter(static_cast<double>(_Stats.allocated_bytes), _Counter::kAvgIterations);
+        }
+
+        void bm_allocs_make_format_args(::benchmark::State& _State) {
+            allocation_scope _Scope;
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(::mjx::make_format_args(L"first", L"second", L"third", L"fourth"));
+            }
+
+            _Report_allocations(_State, _Scope);
+        }
+
+        void bm_allocs_format_string(::benchmark::State& _State) {
+            const format_args& _Args = ::mjx::make_format_args(L"oak", L"proud", L"branches", L"sky", L"seasons");
+            allocation_scope _Scope;
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(::mjx::format_string(
+                    L"The old {%0} tree stood tall and {%1}, its {%2} reaching towards the {%3}, "
+                    L"whispering stories of {%4} gone by.", _Args));
+            }
+
+            _Report_allocations(_State, _Scope);
+        }
+
+        void bm_allocs_catalog_get_message(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(1000);
+            const message_catalog _Catalog(_Synthetic.data);
+            const format_args& _Args = ::mjx::make_format_args(L"first", L"second", L"third", L"fourth");
+            size_t _Idx              = 0;
+            allocation_scope _Scope;
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(_Catalog.get_message(_Synthetic.ids[_Idx], _Args));
+                _Idx = (_Idx + 1) % _Synthetic.ids.size();
+            }
+
+            _Report_allocations(_State, _Scope);
+        }
+
+        void bm_allocs_translator_get_message(::benchmark::State& _State) {
+            // install and load the catalog outside of the scope, so that only the lookups are counted
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(1000);
+            const unicode_string& _Name         = _Make_bench_catalog_name(L"bench.umc");
+            const _Synthetic_catalog_file _File(translator_settings::catalogs_directory(), _Name, _Synthetic);
+            if (!_File._Installed() || !translator::global().use_catalog(_Name)) { // failed to install, break
+                _State.SkipWithError("failed to install the synthetic catalog");
+                return;
+            }
+
+            size_t _Idx = 0;
+            allocation_scope _Scope;
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(
+                    ::mjx::get_message(_Synthetic.ids[_Idx], L"first", L"second", L"third", L"fourth"));
+                _Idx = (_Idx + 1) % _Synthetic.ids.size();
+            }
+
+            _Report_allocations(_State, _Scope);
+        }
+
+        BENCHMARK(bm_allocs_make_format_args)->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_allocs_format_string)->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_allocs_catalog_get_message)->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_allocs_translator_get_message)->Unit(::benchmark::TimeUnit::kNanosecond);
+    } // namespace bench
+} // namespace mjx
+
+#endif // _BENCH_BENCHMARKS_UMLS_ALLOCATIONS_HPP_
\ No newline at end of file
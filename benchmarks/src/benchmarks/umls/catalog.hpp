@@ -0,0 +1,308 @@
+// catalog.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _BENCH_BENCHMARKS_UMLS_CATALOG_HPP_
+#define _BENCH_BENCHMARKS_UMLS_CATALOG_HPP_
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <benchmarks/umls/catalog_generator.hpp>
+#include <cwchar>
+#include <mjfs/directory.hpp>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjfs/status.hpp>
+#include <umls/catalog.hpp>
+#include <umls/impl/tinywin.hpp>
+#include <umls/translator.hpp>
+#include <vector>
+
+namespace mjx {
+    namespace bench {
+        // visits the messages in a scattered order, so that consecutive lookups do not share cache lines
+        inline constexpr size_t _Lookup_stride = 7919;
+
+        inline size_t _Next_lookup(const size_t _Idx, const size_t _Count) noexcept {
+            return (_Idx + _Lookup_stride) % _Count;
+        }
+
+        inline path _Get_bench_directory() {
+            // a temporary directory for the catalogs that are opened directly, without the translator
+            return ::mjx::current_path() / L"umls_bench";
+        }
+
+        inline unicode_string _Make_bench_catalog_name(const unicode_string_view _Name) {
+            // makes the name unique to this process, so that the real catalogs are never touched
+            wchar_t _Prefix[32];
+            ::swprintf(_Prefix, 32, L"umls_bench_%lu_", static_cast<unsigned long>(::GetCurrentProcessId()));
+            unicode_string _Result = _Prefix;
+            _Result.append(_Name.data(), _Name.size());
+            return _Result;
+        }
+
+        class _Synthetic_catalog_file { // installs a synthetic catalog for a single benchmark and removes it afterwards
+        public:
+            _Synthetic_catalog_file(
+                const path& _Dir, const unicode_string_view _Name, const synthetic_catalog& _Catalog)
+                : _Mytarget(_Dir / _Name), _Mydir_created(false), _Myfile_created(false), _Myinstalled(false) {
+                if (!::mjx::exists(_Dir)) { // create the directory, remove it afterwards
+                    if (!::mjx::create_directory(_Dir)) { // failed to create the directory, break
+                        return;
+                    }
+
+                    _Mydir_created = true;
+                }
+
+                file _File;
+                if (::mjx::exists(_Mytarget) || !::mjx::create_file(_Mytarget, ::std::addressof(_File))) {
+                    return; // never overwrite a file that the benchmark does not own
+                }
+
+                _Myfile_created = true;
+                file_stream _Stream(_File);
+                _Myinstalled = _Stream.is_open() && _Stream.write(_Catalog.data.data(), _Catalog.data.size());
+            }
+
+            ~_Synthetic_catalog_file() noexcept {
+                if (_Myfile_created) {
+                    ::mjx::delete_file(_Mytarget);
+                }
+
+                if (_Mydir_created) {
+                    ::mjx::remove_directory(_Mytarget.parent_path());
+                }
+            }
+
+            _Synthetic_catalog_file(const _Synthetic_catalog_file&)            = delete;
+            _Synthetic_catalog_file& operator=(const _Synthetic_catalog_file&) = delete;
+
+            bool _Installed() const noexcept {
+                return _Myinstalled;
+            }
+
+            const path& _Path() const noexcept {
+                return _Mytarget;
+            }
+
+        private:
+            path _Mytarget;
+            bool _Mydir_created;
+            bool _Myfile_created;
+            bool _Myinstalled;
+        };
+
+        inline void _Report_catalog_memory(::benchmark::State& _State, const message_catalog& _Catalog) {
+            const catalog_memory_usage& _Usage = _Catalog.memory_usage();
+            _State.counters["table_bytes"]     = static_cast<double>(_Usage.table_bytes);
+            _State.counters["blob_bytes"]      = static_cast<double>(_Usage.blob_bytes);
+            _State.counters["heap_bytes"]      = static_cast<double>(_Usage.heap_bytes);
+            _State.counters["mapped_bytes"]    = static_cast<double>(_Usage.mapped_bytes);
+            _State.counters["borrowed_bytes"]  = static_cast<double>(_Usage.borrowed_bytes);
+        }
+
+        void bm_catalog_open(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            for (const auto& _Step : _State) {
+                message_catalog _Catalog;
+                ::benchmark::DoNotOptimize(_Catalog.open(_Synthetic.data, catalog_buffer_mode::copy));
+            }
+
+            _State.SetBytesProcessed(_State.iterations() * _Synthetic.data.size());
+            _Report_catalog_memory(_State, message_catalog{_Synthetic.data, catalog_buffer_mode::copy});
+        }
+
+        void bm_catalog_open_borrowed(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            for (const auto& _Step : _State) {
+                message_catalog _Catalog;
+                ::benchmark::DoNotOptimize(_Catalog.open(_Synthetic.data, catalog_buffer_mode::borrow));
+            }
+
+            _State.SetBytesProcessed(_State.iterations() * _Synthetic.data.size());
+            _Report_catalog_memory(_State, message_catalog{_Synthetic.data, catalog_buffer_mode::borrow});
+        }
+
+        void bm_catalog_open_mapped(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            const _Synthetic_catalog_file _File(_Get_bench_directory(), L"bench.umc", _Synthetic);
+            if (!_File._Installed()) { // failed to install the catalog, break
+                _State.SkipWithError("failed to install the synthetic catalog");
+                return;
+            }
+
+            const path& _Target = _File._Path();
+            for (const auto& _Step : _State) {
+                message_catalog _Catalog;
+                ::benchmark::DoNotOptimize(_Catalog.open(_Target, catalog_load_mode::map));
+            }
+
+            _State.SetBytesProcessed(_State.iterations() * _Synthetic.data.size());
+            _Report_catalog_memory(_State, message_catalog{_Target, catalog_load_mode::map});
+        }
+
+        void bm_catalog_warm_up_mapped(::benchmark::State& _State) {
+            // warms up a startup set of 256 messages in a freshly mapped catalog
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            const _Synthetic_catalog_file _File(_Get_bench_directory(), L"bench.umc", _Synthetic);
+            if (!_File._Installed()) { // failed to install the catalog, break
+                _State.SkipWithError("failed to install the synthetic catalog");
+                return;
+            }
+
+            const size_t _Count = (::std::min)(_Synthetic.ids.size(), size_t{256});
+            ::std::vector<utf8_string_view> _Ids;
+            _Ids.reserve(_Count);
+            for (size_t _Idx = 0, _Lookup = 0; _Idx < _Count; ++_Idx) {
+                _Ids.push_back(_Synthetic.ids[_Lookup]);
+                _Lookup = _Next_lookup(_Lookup, _Synthetic.ids.size());
+            }
+
+            const path& _Target = _File._Path();
+            for (const auto& _Step : _State) {
+                _State.PauseTiming();
+                message_catalog _Catalog(_Target, catalog_load_mode::map);
+                _State.ResumeTiming();
+                ::benchmark::DoNotOptimize(_Catalog.warm_up(_Ids.data(), _Ids.size()));
+            }
+
+            _State.SetItemsProcessed(_State.iterations() * _Count);
+        }
+
+        void bm_catalog_has_message(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            const message_catalog _Catalog(_Synthetic.data);
+            size_t _Idx = 0;
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(_Catalog.has_message(_Synthetic.ids[_Idx]));
+                _Idx = _Next_lookup(_Idx, _Synthetic.ids.size());
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+        }
+
+        void bm_catalog_get_message_hit(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            const message_catalog _Catalog(_Synthetic.data);
+            const format_args& _Args = ::mjx::make_format_args(L"first", L"second", L"third", L"fourth");
+            size_t _Idx              = 0;
+            int64_t _Bytes           = 0;
+            for (const auto& _Step : _State) {
+                const auto& _Result = _Catalog.get_message(_Synthetic.ids[_Idx], _Args);
+                _Bytes             += static_cast<int64_t>(_Result.message.size() * sizeof(wchar_t));
+                ::benchmark::DoNotOptimize(_Result);
+                _Idx = _Next_lookup(_Idx, _Synthetic.ids.size());
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+            _State.SetBytesProcessed(_Bytes);
+        }
+
+        void bm_catalog_get_utf8_message_hit(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            const message_catalog _Catalog(_Synthetic.data);
+            const utf8_format_args& _Args = ::mjx::make_utf8_format_args("first", "second", "third", "fourth");
+            size_t _Idx                   = 0;
+            int64_t _Bytes                = 0;
+            for (const auto& _Step : _State) {
+                const auto& _Result = _Catalog.get_utf8_message(_Synthetic.ids[_Idx], _Args);
+                _Bytes             += static_cast<int64_t>(_Result.message.size());
+                ::benchmark::DoNotOptimize(_Result);
+                _Idx = _Next_lookup(_Idx, _Synthetic.ids.size());
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+            _State.SetBytesProcessed(_Bytes);
+        }
+
+        void bm_catalog_has_message_strict(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic =
+                ::mjx::bench::get_synthetic_catalog(_State.range(0), synthetic_script::latin, true);
+            message_catalog _Catalog(_Synthetic.data);
+            _Catalog.strict_lookup(true);
+            size_t _Idx = 0;
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(_Catalog.has_message(_Synthetic.ids[_Idx]));
+                _Idx = _Next_lookup(_Idx, _Synthetic.ids.size());
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+        }
+
+        void bm_catalog_get_namespace(::benchmark::State& _State) {
+            // retrieves roughly a tenth of the catalog with a single call
+            const synthetic_catalog& _Synthetic =
+                ::mjx::bench::get_synthetic_catalog(_State.range(0), synthetic_script::latin, true);
+            const message_catalog _Catalog(_Synthetic.data);
+            int64_t _Items = 0;
+            for (const auto& _Step : _State) {
+                const auto& _Result = _Catalog.get_namespace("bench.message.1");
+                _Items             += static_cast<int64_t>(_Result.messages.size());
+                ::benchmark::DoNotOptimize(_Result);
+            }
+
+            _State.SetItemsProcessed(_Items);
+        }
+
+        void bm_catalog_get_message_miss(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            const message_catalog _Catalog(_Synthetic.data);
+            const utf8_string& _Id = ::mjx::bench::make_synthetic_message_id("bench.missing.", 0);
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(_Catalog.get_message(_Id));
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+        }
+
+        void bm_translator_get_message(::benchmark::State& _State) {
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(_State.range(0));
+            // the translator only loads catalogs from its own directory
+            const unicode_string& _Name = _Make_bench_catalog_name(L"bench.umc");
+            const _Synthetic_catalog_file _File(translator_settings::catalogs_directory(), _Name, _Synthetic);
+            if (!_File._Installed() || !translator::global().use_catalog(_Name)) { // failed to install, break
+                _State.SkipWithError("failed to install the synthetic catalog");
+                return;
+            }
+
+            size_t _Idx    = 0;
+            int64_t _Bytes = 0;
+            for (const auto& _Step : _State) {
+                const unicode_string& _Msg =
+                    ::mjx::get_message(_Synthetic.ids[_Idx], L"first", L"second", L"third", L"fourth");
+                _Bytes                    += static_cast<int64_t>(_Msg.size() * sizeof(wchar_t));
+                ::benchmark::DoNotOptimize(_Msg);
+                _Idx = _Next_lookup(_Idx, _Synthetic.ids.size());
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+            _State.SetBytesProcessed(_Bytes);
+        }
+
+        BENCHMARK(bm_catalog_open)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kMicrosecond);
+        BENCHMARK(bm_catalog_open_borrowed)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kMicrosecond);
+        BENCHMARK(bm_catalog_open_mapped)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kMicrosecond);
+        BENCHMARK(bm_catalog_warm_up_mapped)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kMicrosecond);
+        BENCHMARK(bm_catalog_has_message)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_catalog_get_message_hit)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_catalog_get_utf8_message_hit)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_catalog_has_message_strict)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_catalog_get_namespace)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kMicrosecond);
+        BENCHMARK(bm_catalog_get_message_miss)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_translator_get_message)->RangeMultiplier(10)->Range(100, 1'000'000)
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+    } // namespace bench
+} // namespace mjx
+
+#endif // _BENCH_BENCHMARKS_UMLS_CATALOG_HPP_
\ No newline at end of file
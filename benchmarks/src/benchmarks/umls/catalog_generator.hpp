@@ -0,0 +1,244 @@
+// catalog_generator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _BENCH_BENCHMARKS_UMLS_CATALOG_GENERATOR_HPP_
+#define _BENCH_BENCHMARKS_UMLS_CATALOG_GENERATOR_HPP_
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mjstr/string.hpp>
+#include <mjstr/string_view.hpp>
+#include <tuple>
+#include <vector>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    namespace bench {
+        enum class synthetic_script : unsigned char {
+            latin, // ASCII words
+            cyrillic, // 2-byte sequences
+            cjk // 3-byte sequences
+        };
+
+        struct synthetic_catalog_options {
+            size_t message_count      = 1000;
+            size_t min_message_length = 16; // in bytes, placeholders excluded
+            size_t max_message_length = 128; // in bytes, placeholders excluded
+            uint32_t formattable_ratio = 25; // percentage of messages that contain placeholders
+            size_t max_placeholders    = 4;
+            synthetic_script script    = synthetic_script::latin;
+            uint64_t seed              = 0x9E3779B97F4A7C15;
+            bool include_ids           = false; // append the optional section with the original IDs
+        };
+
+        struct synthetic_catalog {
+            byte_string data; // UMC image
+            ::std::vector<utf8_string> ids; // IDs of all messages, in the order they were generated
+            size_t message_bytes = 0; // total size of all messages
+        };
+
+        class _Synthetic_random { // SplitMix64, produces the same sequence on every platform
+        public:
+            explicit _Synthetic_random(const uint64_t _Seed) noexcept : _Mystate(_Seed) {}
+
+            uint64_t _Next() noexcept {
+                uint64_t _Val = (_Mystate += 0x9E3779B97F4A7C15);
+                _Val          = (_Val ^ (_Val >> 30)) * 0xBF58476D1CE4E5B9;
+                _Val          = (_Val ^ (_Val >> 27)) * 0x94D049BB133111EB;
+                return _Val ^ (_Val >> 31);
+            }
+
+            size_t _Next_in_range(const size_t _Min, const size_t _Max) noexcept {
+                return _Min + static_cast<size_t>(_Next() % (_Max - _Min + 1));
+            }
+
+        private:
+            uint64_t _Mystate;
+        };
+
+        inline void _Append_synthetic_integer(byte_string& _Str, uint64_t _Value, const size_t _Size) {
+            for (size_t _Idx = 0; _Idx < _Size; ++_Idx) { // little-endian, as expected by the loader
+                _Str.push_back(static_cast<byte_t>(_Value & 0xFF));
+                _Value >>= 8;
+            }
+        }
+
+        inline utf8_string make_synthetic_message_id(const char* const _Prefix, size_t _Idx) {
+            char _Buf[20];
+            size_t _Off = sizeof(_Buf);
+            do {
+                _Buf[--_Off] = static_cast<char>('0' + _Idx % 10);
+                _Idx        /= 10;
+            } while (_Idx > 0);
+
+            utf8_string _Id(_Prefix);
+            _Id.append(_Buf + _Off, sizeof(_Buf) - _Off);
+            return _Id;
+        }
+
+        inline void _Append_synthetic_code_point(utf8_string& _Str, const uint32_t _Code_point) {
+            // encodes a code point from the BMP as UTF-8
+            if (_Code_point < 0x80) {
+                _Str.push_back(static_cast<char>(_Code_point));
+            } else if (_Code_point < 0x800) {
+                _Str.push_back(static_cast<char>(0xC0 | (_Code_point >> 6)));
+                _Str.push_back(static_cast<char>(0x80 | (_Code_point & 0x3F)));
+            } else {
+                _Str.push_back(static_cast<char>(0xE0 | (_Code_point >> 12)));
+                _Str.push_back(static_cast<char>(0x80 | ((_Code_point >> 6) & 0x3F)));
+                _Str.push_back(static_cast<char>(0x80 | (_Code_point & 0x3F)));
+            }
+        }
+
+        inline void _Append_synthetic_word(
+            utf8_string& _Msg, _Synthetic_random& _Random, const synthetic_script _Script) {
+            static constexpr const char* _Words[] = {"the", "catalog", "message", "was", "not", "found",
+                "please", "try", "again", "later", "file", "could", "be", "opened", "settings", "saved"};
+            constexpr size_t _Word_count = sizeof(_Words) / sizeof(_Words[0]);
+
+            switch (_Script) {
+            case synthetic_script::cyrillic: // lowercase letters, U+0430 to U+044F
+                for (size_t _Count = _Random._Next_in_range(2, 8); _Count > 0; --_Count) {
+                    _Append_synthetic_code_point(_Msg, static_cast<uint32_t>(_Random._Next_in_range(0x430, 0x44F)));
+                }
+
+                break;
+            case synthetic_script::cjk: // unified ideographs, U+4E00 to U+9FFF
+                for (size_t _Count = _Random._Next_in_range(1, 4); _Count > 0; --_Count) {
+                    _Append_synthetic_code_point(_Msg, static_cast<uint32_t>(_Random._Next_in_range(0x4E00, 0x9FFF)));
+                }
+
+                break;
+            default:
+                _Msg.append(_Words[_Random._Next() % _Word_count]);
+                break;
+            }
+        }
+
+        inline void _Generate_synthetic_message(
+            utf8_string& _Msg, _Synthetic_random& _Random, const synthetic_catalog_options& _Options) {
+            const size_t _Length = _Random._Next_in_range(_Options.min_message_length, _Options.max_message_length);
+            const bool _Formattable = _Random._Next() % 100 < _Options.formattable_ratio;
+            size_t _Placeholders    = _Formattable ? _Random._Next_in_range(1, _Options.max_placeholders) : 0;
+            size_t _Next_arg        = 0;
+            _Msg.clear();
+            while (_Msg.size() < _Length) {
+                if (!_Msg.empty()) {
+                    _Msg.push_back(' ');
+                }
+
+                if (_Placeholders > 0 && _Random._Next() % 4 == 0) { // insert a placeholder between the words
+                    _Msg.append("{%");
+                    _Msg.push_back(static_cast<char>('0' + _Next_arg++ % 10));
+                    _Msg.push_back('}');
+                    --_Placeholders;
+                } else {
+                    _Append_synthetic_word(_Msg, _Random, _Options.script);
+                }
+            }
+
+            while (_Placeholders-- > 0) { // append the remaining placeholders
+                _Msg.append(" {%");
+                _Msg.push_back(static_cast<char>('0' + _Next_arg++ % 10));
+                _Msg.push_back('}');
+            }
+        }
+
+        inline void _Append_synthetic_id_section(byte_string& _Data, const ::std::vector<utf8_string>& _Ids) {
+            // the records are sorted by the ID bytes, as expected by the loader
+            ::std::vector<const utf8_string*> _Sorted;
+            _Sorted.reserve(_Ids.size());
+            for (const utf8_string& _Id : _Ids) {
+                _Sorted.push_back(&_Id);
+            }
+
+            ::std::sort(_Sorted.begin(), _Sorted.end(), [](const utf8_string* _Left, const utf8_string* _Right) {
+                const int _Result = ::memcmp(
+                    _Left->data(), _Right->data(), (::std::min)(_Left->size(), _Right->size()));
+                return _Result != 0 ? _Result < 0 : _Left->size() < _Right->size();
+            });
+
+            size_t _Pool_size = 0;
+            for (const utf8_string& _Id : _Ids) {
+                _Pool_size += _Id.size();
+            }
+
+            _Data.append(reinterpret_cast<const byte_t*>("UMI\0"), 4);
+            _Append_synthetic_integer(_Data, _Ids.size(), 4);
+            _Append_synthetic_integer(_Data, _Pool_size, 4);
+            size_t _Offset = 0;
+            for (const utf8_string* const _Id : _Sorted) {
+                _Append_synthetic_integer(_Data, ::XXH3_64bits(_Id->data(), _Id->size()), 8);
+                _Append_synthetic_integer(_Data, _Offset, 4);
+                _Append_synthetic_integer(_Data, _Id->size(), 4);
+                _Offset += _Id->size();
+            }
+
+            for (const utf8_string* const _Id : _Sorted) {
+                _Data.append(reinterpret_cast<const byte_t*>(_Id->data()), _Id->size());
+            }
+        }
+
+        inline synthetic_catalog generate_synthetic_catalog(const synthetic_catalog_options& _Options) {
+            // Note: The generated image follows the same layout as the catalogs produced by the tools,
+            //       the lookup table is stored in the generation order, not sorted by hash.
+            synthetic_catalog _Catalog;
+            _Synthetic_random _Random(_Options.seed);
+            byte_string _Blob;
+            utf8_string _Msg;
+            _Catalog.ids.reserve(_Options.message_count);
+            _Blob.reserve(_Options.message_count * (_Options.min_message_length + _Options.max_message_length) / 2);
+
+            byte_string& _Data = _Catalog.data;
+            _Data.reserve(32 + _Options.message_count * 20);
+            _Data.append(reinterpret_cast<const byte_t*>("UMC\0"), 4);
+            _Data.push_back(static_cast<byte_t>(5));
+            _Data.append(reinterpret_cast<const byte_t*>("en-US"), 5);
+            _Append_synthetic_integer(_Data, 0x0409, 4);
+            _Append_synthetic_integer(_Data, _Options.message_count, 4);
+            for (size_t _Idx = 0; _Idx < _Options.message_count; ++_Idx) {
+                utf8_string _Id = ::mjx::bench::make_synthetic_message_id("bench.message.", _Idx);
+                _Generate_synthetic_message(_Msg, _Random, _Options);
+                _Append_synthetic_integer(_Data, ::XXH3_64bits(_Id.data(), _Id.size()), 8);
+                _Append_synthetic_integer(_Data, _Blob.size(), 8);
+                _Append_synthetic_integer(_Data, _Msg.size(), 4);
+                _Blob.append(reinterpret_cast<const byte_t*>(_Msg.data()), _Msg.size());
+                _Catalog.ids.push_back(::std::move(_Id));
+            }
+
+            _Catalog.message_bytes = _Blob.size();
+            _Data.append(_Blob);
+            if (_Options.include_ids) {
+                ::mjx::bench::_Append_synthetic_id_section(_Data, _Catalog.ids);
+            }
+
+            return _Catalog;
+        }
+
+        inline const synthetic_catalog& get_synthetic_catalog(const size_t _Message_count,
+            const synthetic_script _Script = synthetic_script::latin, const bool _Include_ids = false) {
+            // Note: Generating the largest catalogs takes a while, and every benchmark sweeps all sizes,
+            //       so each generated catalog is cached by its size and options for the whole run.
+            using _Key = ::std::tuple<size_t, synthetic_script, bool>;
+            static ::std::map<_Key, synthetic_catalog> _Cache;
+            const _Key _Cache_key{_Message_count, _Script, _Include_ids};
+            const auto _Iter = _Cache.find(_Cache_key);
+            if (_Iter != _Cache.end()) { // already generated
+                return _Iter->second;
+            }
+
+            synthetic_catalog_options _Options;
+            _Options.message_count = _Message_count;
+            _Options.script        = _Script;
+            _Options.include_ids   = _Include_ids;
+            return _Cache.emplace(_Cache_key, ::mjx::bench::generate_synthetic_catalog(_Options)).first->second;
+        }
+    } // namespace bench
+} // namespace mjx
+
+#endif // _BENCH_BENCHMARKS_UMLS_CATALOG_GENERATOR_HPP_
\ No newline at end of file
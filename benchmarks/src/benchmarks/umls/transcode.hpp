@@ -0,0 +1,79 @@
+// transcode.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _BENCH_BENCHMARKS_UMLS_TRANSCODE_HPP_
+#define _BENCH_BENCHMARKS_UMLS_TRANSCODE_HPP_
+#include <benchmark/benchmark.h>
+#include <benchmarks/umls/catalog_generator.hpp>
+#include <mjstr/conversion.hpp>
+#include <umls/catalog.hpp>
+
+namespace mjx {
+    namespace bench {
+        inline constexpr size_t _Transcode_message_count = 10'000;
+
+        inline uint64_t _Read_synthetic_integer(const byte_t* const _Data, const size_t _Size) noexcept {
+            uint64_t _Value = 0;
+            for (size_t _Idx = _Size; _Idx > 0; --_Idx) {
+                _Value = (_Value << 8) | _Data[_Idx - 1];
+            }
+
+            return _Value;
+        }
+
+        inline byte_string_view _Synthetic_message(const synthetic_catalog& _Catalog, const size_t _Idx) noexcept {
+            // the header takes 18 bytes (en-US), followed by 20-byte table entries and the blob
+            const byte_t* const _Data  = _Catalog.data.data();
+            const byte_t* const _Entry = _Data + 18 + _Idx * 20;
+            const byte_t* const _Blob  = _Data + _Catalog.data.size() - _Catalog.message_bytes;
+            return byte_string_view{_Blob + _Read_synthetic_integer(_Entry + 8, 8),
+                static_cast<size_t>(_Read_synthetic_integer(_Entry + 16, 4))};
+        }
+
+        void bm_transcode_mjstr(::benchmark::State& _State) {
+            // baseline, decodes the messages with the generic conversion routine
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(
+                _Transcode_message_count, static_cast<synthetic_script>(_State.range(0)));
+            size_t _Idx    = 0;
+            int64_t _Bytes = 0;
+            for (const auto& _Step : _State) {
+                const byte_string_view _Msg = _Synthetic_message(_Synthetic, _Idx);
+                ::benchmark::DoNotOptimize(::mjx::to_unicode_string(_Msg));
+                _Bytes += static_cast<int64_t>(_Msg.size());
+                _Idx    = (_Idx + 1) % _Synthetic.ids.size();
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+            _State.SetBytesProcessed(_Bytes);
+        }
+
+        void bm_transcode_catalog_fetch(::benchmark::State& _State) {
+            // copied catalogs are validated once when loaded, borrowed catalogs are validated by each fetch
+            const synthetic_catalog& _Synthetic = ::mjx::bench::get_synthetic_catalog(
+                _Transcode_message_count, static_cast<synthetic_script>(_State.range(0)));
+            const message_catalog _Catalog(
+                _Synthetic.data, _State.range(1) != 0 ? catalog_buffer_mode::borrow : catalog_buffer_mode::copy);
+            const format_args& _Args = ::mjx::make_format_args(L"first", L"second", L"third", L"fourth");
+            size_t _Idx              = 0;
+            int64_t _Bytes           = 0;
+            for (const auto& _Step : _State) {
+                ::benchmark::DoNotOptimize(_Catalog.get_message(_Synthetic.ids[_Idx], _Args));
+                _Bytes += static_cast<int64_t>(_Synthetic_message(_Synthetic, _Idx).size());
+                _Idx    = (_Idx + 1) % _Synthetic.ids.size();
+            }
+
+            _State.SetItemsProcessed(_State.iterations());
+            _State.SetBytesProcessed(_Bytes);
+        }
+
+        BENCHMARK(bm_transcode_mjstr)->ArgName("script")->DenseRange(0, 2)
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_transcode_catalog_fetch)->ArgNames({"script", "borrowed"})->ArgsProduct({{0, 1, 2}, {0, 1}})
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+    } // namespace bench
+} // namespace mjx
+
+#endif // _BENCH_BENCHMARKS_UMLS_TRANSCODE_HPP_
\ No newline at end of file
@@ -0,0 +1,179 @@
+// translator_contention.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _BENCH_BENCHMARKS_UMLS_TRANSLATOR_CONTENTION_HPP_
+#define _BENCH_BENCHMARKS_UMLS_TRANSLATOR_CONTENTION_HPP_
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <benchmarks/umls/catalog.hpp>
+#include <benchmarks/umls/catalog_generator.hpp>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <umls/translator.hpp>
+#include <vector>
+
+namespace mjx {
+    namespace bench {
+        // the number of messages in the contended catalogs
+        inline constexpr size_t _Contention_message_count = 10'000;
+
+        // the number of lookups between two catalog reloads performed by the writer thread
+        inline constexpr size_t _Contention_writer_period = 4096;
+
+        // the maximum number of latency samples kept per thread
+        inline constexpr size_t _Contention_max_samples = 65'536;
+
+        inline const synthetic_catalog& _Get_contention_catalog(const uint32_t _Formattable_ratio) {
+            synthetic_catalog_options _Options;
+            _Options.message_count     = _Contention_message_count;
+            _Options.formattable_ratio = _Formattable_ratio;
+            if (_Formattable_ratio == 0) { // plain messages only
+                static const synthetic_catalog& _Plain = ::mjx::bench::generate_synthetic_catalog(_Options);
+                return _Plain;
+            } else {
+                static const synthetic_catalog& _Mixed = ::mjx::bench::generate_synthetic_catalog(_Options);
+                return _Mixed;
+            }
+        }
+
+        class _Latency_recorder { // stores the latency of the most recent lookups of a single thread
+        public:
+            _Latency_recorder() : _Mysamples(_Contention_max_samples), _Mycount(0) {}
+
+            void _Record(const ::std::chrono::steady_clock::duration _Elapsed) noexcept {
+                _Mysamples[_Mycount++ % _Contention_max_samples] = static_cast<double>(
+                    ::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Elapsed).count());
+            }
+
+            const double* _Samples() const noexcept {
+                return _Mysamples.data();
+            }
+
+            size_t _Sample_count() const noexcept {
+                return (::std::min)(_Mycount, _Contention_max_samples);
+            }
+
+        private:
+            ::std::vector<double> _Mysamples;
+            size_t _Mycount;
+        };
+
+        class _Latency_pool { // merges the samples of all threads, so that the percentiles cover every lookup
+        public:
+            _Latency_pool() : _Mymtx(), _Mysamples(), _Myfinished(0) {}
+
+            bool _Merge(const _Latency_recorder& _Recorder, const size_t _Threads) {
+                // returns true for the last thread to merge its samples, which then reports the percentiles
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                _Mysamples.insert(_Mysamples.end(), _Recorder._Samples(),
+                    _Recorder._Samples() + _Recorder._Sample_count());
+                return ++_Myfinished == _Threads;
+            }
+
+            double _Percentile(const double _Rank) {
+                // called only by the last thread, once all other threads have merged their samples
+                if (_Mysamples.empty()) { // no samples, break
+                    return 0.0;
+                }
+
+                const auto _Nth = _Mysamples.begin()
+                    + static_cast<ptrdiff_t>(_Rank * static_cast<double>(_Mysamples.size() - 1));
+                ::std::nth_element(_Mysamples.begin(), _Nth, _Mysamples.end());
+                return *_Nth;
+            }
+
+            void _Reset() noexcept {
+                // prepares the pool for the next run
+                _Mysamples.clear();
+                _Myfinished = 0;
+            }
+
+        private:
+            ::std::mutex _Mymtx;
+            ::std::vector<double> _Mysamples;
+            size_t _Myfinished;
+        };
+
+        inline _Latency_pool& _Get_latency_pool() {
+            static _Latency_pool _Pool;
+            return _Pool;
+        }
+
+        inline void _Run_translator_contention(
+            ::benchmark::State& _State, const unicode_string_view _Name, const uint32_t _Formattable_ratio,
+            const bool _With_writer) {
+            const synthetic_catalog& _Synthetic = _Get_contention_catalog(_Formattable_ratio);
+            ::std::optional<_Synthetic_catalog_file> _File;
+            if (_State.thread_index() == 0) { // install and load the catalog once, before other threads start
+                const unicode_string& _Unique_name = _Make_bench_catalog_name(_Name);
+                _File.emplace(translator_settings::catalogs_directory(), _Unique_name, _Synthetic);
+                if (!_File->_Installed() || !translator::global().use_catalog(_Unique_name)) {
+                    _State.SkipWithError("failed to install the synthetic catalog");
+                }
+            }
+
+            // Note: Each thread starts at a different message, so that the threads do not read
+            //       the same entries in lockstep. The writer is always the first thread, it performs
+            //       lookups like the others and additionally reloads the catalog periodically.
+            const bool _Writer = _With_writer && _State.thread_index() == 0;
+            size_t _Idx        = static_cast<size_t>(_State.thread_index()) * _Lookup_stride % _Synthetic.ids.size();
+            size_t _Lookups    = 0;
+            _Latency_recorder _Recorder;
+            for (const auto& _Step : _State) {
+                const auto _Start          = ::std::chrono::steady_clock::now();
+                const unicode_string& _Msg =
+                    ::mjx::get_message(_Synthetic.ids[_Idx], L"first", L"second", L"third", L"fourth");
+                _Recorder._Record(::std::chrono::steady_clock::now() - _Start);
+                ::benchmark::DoNotOptimize(_Msg);
+                _Idx = _Next_lookup(_Idx, _Synthetic.ids.size());
+                if (_Writer && ++_Lookups % _Contention_writer_period == 0) { // reload the catalog
+                    ::benchmark::DoNotOptimize(translator::global().use_catalog(_Name));
+                }
+            }
+
+            using _Counter = ::benchmark::Counter;
+            _State.SetItemsProcessed(_State.iterations());
+            _State.counters["per_thread"] =
+                _Counter(static_cast<double>(_State.iterations()), _Counter::kAvgThreadsRate);
+
+            // Note: The counters of all threads are summed, so only the last thread reports the percentiles
+            //       of the merged samples, the others leave them at zero.
+            _Latency_pool& _Pool = _Get_latency_pool();
+            if (_Pool._Merge(_Recorder, static_cast<size_t>(_State.threads()))) {
+                _State.counters["p50_ns"]  = _Pool._Percentile(0.50);
+                _State.counters["p99_ns"]  = _Pool._Percentile(0.99);
+                _State.counters["p999_ns"] = _Pool._Percentile(0.999);
+                _Pool._Reset();
+            } else {
+                _State.counters["p50_ns"]  = 0.0;
+                _State.counters["p99_ns"]  = 0.0;
+                _State.counters["p999_ns"] = 0.0;
+            }
+        }
+
+        void bm_translator_readers(::benchmark::State& _State) {
+            _Run_translator_contention(_State, L"bench_plain.umc", 0, false);
+        }
+
+        void bm_translator_readers_mixed(::benchmark::State& _State) {
+            _Run_translator_contention(_State, L"bench_mixed.umc", 50, false);
+        }
+
+        void bm_translator_readers_with_writer(::benchmark::State& _State) {
+            _Run_translator_contention(_State, L"bench_mixed.umc", 50, true);
+        }
+
+        BENCHMARK(bm_translator_readers)->ThreadRange(8, 64)->UseRealTime()
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_translator_readers_mixed)->ThreadRange(8, 64)->UseRealTime()
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+        BENCHMARK(bm_translator_readers_with_writer)->ThreadRange(8, 64)->UseRealTime()
+            ->Unit(::benchmark::TimeUnit::kNanosecond);
+    } // namespace bench
+} // namespace mjx
+
+#endif // _BENCH_BENCHMARKS_UMLS_TRANSLATOR_CONTENTION_HPP_
\ No newline at end of file
@@ -5,7 +5,11 @@
 
 #define BENCHMARK_STATIC_DEFINE
 #include <benchmark/benchmark.h>
+#include <benchmarks/umls/allocations.hpp>
+#include <benchmarks/umls/catalog.hpp>
 #include <benchmarks/umls/string_fmt.hpp>
+#include <benchmarks/umls/transcode.hpp>
+#include <benchmarks/umls/translator_contention.hpp>
 #include <benchmarks/ure/color_cvt.hpp>
 
 BENCHMARK_MAIN();
\ No newline at end of file
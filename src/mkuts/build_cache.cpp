@@ -0,0 +1,232 @@
+// build_cache.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjfs/status.hpp>
+#include <mjstr/char_traits.hpp>
+#include <mkuts/build_cache.hpp>
+#include <mkuts/embedded_catalog.hpp>
+#include <mkuts/logger.hpp>
+#include <mkuts/options.hpp>
+#include <mkuts/tinywin.hpp>
+#include <umls/impl/trace.hpp>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    bool _Has_same_contents(const path& _Target, const byte_string_view _Data) {
+        // Note: The file is compared 64 KiB at a time and only opened for reading, so that processes
+        //       which map or watch it are not disturbed if it is up to date.
+        constexpr size_t _Chunk_size = 64 * 1024;
+        file _File(_Target, file_access::read, file_share::read);
+        file_stream _Stream(_File);
+        if (!_Stream.is_open() || _File.size() != _Data.size()) { // unreadable or the size differs
+            return false;
+        }
+
+        byte_string _Buf(_Chunk_size, byte_t{0});
+        for (size_t _Off = 0; _Off < _Data.size(); _Off += _Chunk_size) {
+            const size_t _Size = (::std::min)(_Chunk_size, _Data.size() - _Off);
+            if (!_Stream.read_exactly(_Buf.data(), _Size) || ::memcmp(_Buf.data(), _Data.data() + _Off, _Size) != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    _Output_update_result _Update_output_file(const path& _Target, const byte_string_view _Data) {
+        // Note: The new contents are written to a temporary file in the same directory, which then
+        //       replaces the target in a single rename. A reader that maps or opens the target sees either
+        //       the old file or the new one, never a partially written one, and a failed build leaves
+        //       the old file intact.
+        if (::mjx::exists(_Target) && _Has_same_contents(_Target, _Data)) { // already up to date
+            return _Output_update_result::_Unchanged;
+        }
+
+        path _Temp = _Target;
+        _Temp += L".tmp";
+        {
+            file _File;
+            if (::mjx::exists(_Temp)) { // left behind by an interrupted build, overwrite it
+                if (!_File.open(_Temp, file_access::write) || !_File.resize(0)) {
+                    return _Output_update_result::_Failed;
+                }
+            } else if (!::mjx::create_file(_Temp, ::std::addressof(_File))) {
+                return _Output_update_result::_Failed;
+            }
+
+            file_stream _Stream(_File);
+            if (!_Stream.is_open() || (!_Data.empty() && !_Stream.write(_Data))) { // failed to write the file
+                _Stream.close();
+                _File.close();
+                ::mjx::delete_file(_Temp);
+                return _Output_update_result::_Failed;
+            }
+        } // the file must be closed before it is renamed
+
+        if (!::MoveFileExW(_Temp.c_str(), _Target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            ::mjx::delete_file(_Temp);
+            return _Output_update_result::_Failed;
+        }
+
+        return _Output_update_result::_Written;
+    }
+
+    uint64_t _Build_output_key(const path& _Output, const path& _Source) noexcept {
+        const unicode_string& _Output_path = _Output.native();
+        const unicode_string& _Source_path = _Source.native();
+        const uint64_t _Seed = ::XXH3_64bits(_Output_path.data(), _Output_path.size() * sizeof(wchar_t));
+        return ::XXH3_64bits_withSeed(_Source_path.data(), _Source_path.size() * sizeof(wchar_t), _Seed);
+    }
+
+    uint64_t _Build_input_hash(const _Build_output_kind _Kind, const path& _Source,
+        const byte_string_view _Data, const uint64_t _Extra) noexcept {
+        // the source path is included, as the embedded catalog identifier is derived from it
+        const unicode_string& _Source_path = _Source.native();
+        uint64_t _Seed = (static_cast<uint64_t>(_Build_cache::_Version) << 8) | static_cast<uint8_t>(_Kind);
+        _Seed          = ::XXH3_64bits_withSeed(_Source_path.data(), _Source_path.size() * sizeof(wchar_t), _Seed);
+        _Seed          = ::XXH3_64bits_withSeed(&_Extra, sizeof(uint64_t), _Seed);
+        return ::XXH3_64bits_withSeed(_Data.data(), _Data.size(), _Seed);
+    }
+
+    _Build_cache::_Build_cache() noexcept : _Myprev(), _Mynext(), _Mykept(0) {}
+
+    _Build_cache::~_Build_cache() noexcept {}
+
+    _Build_cache& _Build_cache::_Global() noexcept {
+        static _Build_cache _Cache;
+        return _Cache;
+    }
+
+    bool _Build_cache::_Load(const path& _Target) {
+        using _Traits                  = char_traits<byte_t>;
+        constexpr byte_t _Signature[4] = {'U', 'B', 'C', '\0'};
+        constexpr size_t _Header_size  = 3 * sizeof(uint32_t);
+        byte_string _Data;
+        if (!_Read_binary_file(_Target, _Data) || _Data.size() < _Header_size
+            || !_Traits::eq(_Data.data(), _Signature, sizeof(_Signature))) { // signature not recognized
+            return false;
+        }
+
+        uint32_t _File_version;
+        uint32_t _Count;
+        ::memcpy(&_File_version, _Data.data() + 4, sizeof(uint32_t));
+        ::memcpy(&_Count, _Data.data() + 8, sizeof(uint32_t));
+        if (_File_version != _Version || _Data.size() - _Header_size != _Count * sizeof(_Build_cache_entry)) {
+            return false; // outdated or truncated cache
+        }
+
+        _Myprev.resize(_Count);
+        if (_Count > 0) {
+            ::memcpy(_Myprev.data(), _Data.data() + _Header_size, _Count * sizeof(_Build_cache_entry));
+        }
+
+        if (!::std::is_sorted(_Myprev.begin(), _Myprev.end(),
+            [](const _Build_cache_entry& _Left, const _Build_cache_entry& _Right) noexcept {
+                return _Left._Key < _Right._Key;
+            })) { // corrupted cache, lookups would fail
+            _Myprev.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool _Build_cache::_Save(const path& _Target) {
+        // Note: Only the entries recorded by this run are saved, so the outputs that are no longer produced
+        //       drop out of the cache. When an output is recorded more than once, the last entry wins.
+        ::std::stable_sort(_Mynext.begin(), _Mynext.end(),
+            [](const _Build_cache_entry& _Left, const _Build_cache_entry& _Right) noexcept {
+                return _Left._Key < _Right._Key;
+            });
+        size_t _Count = 0;
+        for (size_t _Idx = 0; _Idx < _Mynext.size(); ++_Idx) {
+            if (_Idx + 1 < _Mynext.size() && _Mynext[_Idx + 1]._Key == _Mynext[_Idx]._Key) { // superseded
+                continue;
+            }
+
+            _Mynext[_Count++] = _Mynext[_Idx];
+        }
+
+        _Mynext.resize(_Count);
+        const uint32_t _Short_count = static_cast<uint32_t>(_Count);
+        byte_string _Data;
+        _Data.reserve(3 * sizeof(uint32_t) + _Count * sizeof(_Build_cache_entry));
+        _Data.append(reinterpret_cast<const byte_t*>("UBC\0"), 4);
+        _Data.append(reinterpret_cast<const byte_t*>(&_Version), sizeof(uint32_t));
+        _Data.append(reinterpret_cast<const byte_t*>(&_Short_count), sizeof(uint32_t));
+        _Data.append(reinterpret_cast<const byte_t*>(_Mynext.data()), _Count * sizeof(_Build_cache_entry));
+        return _Update_output_file(_Target, _Data) != _Output_update_result::_Failed;
+    }
+
+    const _Build_cache_entry* _Build_cache::_Find(const uint64_t _Key) const noexcept {
+        const auto _Iter = ::std::lower_bound(_Myprev.begin(), _Myprev.end(), _Key,
+            [](const _Build_cache_entry& _Entry, const uint64_t _Value) noexcept {
+                return _Entry._Key < _Value;
+            });
+        return _Iter != _Myprev.end() && _Iter->_Key == _Key ? ::std::addressof(*_Iter) : nullptr;
+    }
+
+    bool _Build_cache::_Is_up_to_date(const path& _Output, const uint64_t _Key, const uint64_t _Input_hash) const {
+        const _Build_cache_entry* const _Entry = _Find(_Key);
+        if (!_Entry || _Entry->_Input_hash != _Input_hash) { // never built or the inputs changed
+            return false;
+        }
+
+        byte_string _Data;
+        if (!::mjx::exists(_Output) || !_Read_binary_file(_Output, _Data)) { // the output is gone
+            return false;
+        }
+
+        return _Data.size() == _Entry->_Output_size
+            && ::XXH3_64bits(_Data.data(), _Data.size()) == _Entry->_Output_hash;
+    }
+
+    void _Build_cache::_Record(const _Build_cache_entry& _Entry) {
+        _Mynext.push_back(_Entry);
+    }
+
+    void _Build_cache::_Keep(const _Build_cache_entry& _Entry) {
+        _Mynext.push_back(_Entry);
+        ++_Mykept;
+    }
+
+    size_t _Build_cache::_Kept_count() const noexcept {
+        return _Mykept;
+    }
+
+    bool _Write_cached_output(const path& _Target, const byte_string_view _Data, const uint64_t _Key,
+        const uint64_t _Input_hash) {
+        if (_Update_output_file(_Target, _Data) == _Output_update_result::_Failed) {
+            return false;
+        }
+
+        _Build_cache::_Global()._Record(
+            _Build_cache_entry{_Key, _Input_hash, _Data.size(), ::XXH3_64bits(_Data.data(), _Data.size())});
+        return true;
+    }
+
+    void load_build_cache() {
+        _UMLS_TRACE_SPAN("load_build_cache");
+        const path& _Path = program_options::global().output_dir / L"mkuts.cache";
+        if (::mjx::exists(_Path) && !_Build_cache::_Global()._Load(_Path)) { // rebuild everything
+            rtlog(L"Warning: The build cache is invalid or outdated, all outputs will be rebuilt.");
+        }
+    }
+
+    void save_build_cache() {
+        _UMLS_TRACE_SPAN("save_build_cache");
+        _Build_cache& _Cache = _Build_cache::_Global();
+        if (!_Cache._Save(program_options::global().output_dir / L"mkuts.cache")) {
+            rtlog(L"Warning: Failed to save the build cache.");
+        }
+
+        if (_Cache._Kept_count() > 0) {
+            rtlog(L"Reused %zu outputs whose inputs did not change.", _Cache._Kept_count());
+        }
+    }
+} // namespace mjx
\ No newline at end of file
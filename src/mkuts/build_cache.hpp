@@ -0,0 +1,100 @@
+// build_cache.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MKUTS_BUILD_CACHE_HPP_
+#define _MKUTS_BUILD_CACHE_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjfs/path.hpp>
+#include <mjstr/string.hpp>
+#include <mjstr/string_view.hpp>
+#include <mkuts/utils.hpp>
+
+namespace mjx {
+    enum class _Output_update_result : unsigned char {
+        _Failed,
+        _Unchanged, // the file already had the same contents, nothing was written
+        _Written // the file was written to a temporary file, which replaced the target
+    };
+
+    // replaces the file with _Data atomically, leaves the file untouched if it already has the same contents
+    _Output_update_result _Update_output_file(const path& _Target, const byte_string_view _Data);
+
+    enum class _Build_output_kind : uint8_t {
+        _Native    = 0,
+        _Reordered = 1,
+        _Embedded  = 2,
+        _Bundled   = 3 // a catalog stored in the bundle
+    };
+
+#pragma pack(push)
+#pragma pack(4) // must match the layout of the cache entry
+    struct _Build_cache_entry {
+        uint64_t _Key; // hash of the output path, and of the source path for bundled catalogs
+        uint64_t _Input_hash; // hash of the source and everything else the output depends on
+        uint64_t _Output_size;
+        uint64_t _Output_hash;
+    };
+#pragma pack(pop)
+
+    // returns the key of the output, bundled catalogs are keyed by the bundle and their source
+    uint64_t _Build_output_key(const path& _Output, const path& _Source = path{}) noexcept;
+
+    // returns the hash of the source, seeded with the kind of the output and the extra inputs
+    uint64_t _Build_input_hash(const _Build_output_kind _Kind, const path& _Source,
+        const byte_string_view _Data, const uint64_t _Extra = 0) noexcept;
+
+    class _Build_cache { // hashes of the inputs and outputs of the previous run
+    public:
+        // Note: The cache is stored next to the outputs as 'mkuts.cache'. Its layout is the 4-byte signature,
+        //       4-byte version, 4-byte entry count and the entries, sorted by key. An entry is only trusted
+        //       if the output still has the recorded contents, so edited or deleted outputs are rebuilt.
+        static constexpr uint32_t _Version = 1; // must be changed whenever the outputs are laid out differently
+
+        _Build_cache() noexcept;
+        ~_Build_cache() noexcept;
+
+        _Build_cache(const _Build_cache&)            = delete;
+        _Build_cache& operator=(const _Build_cache&) = delete;
+
+        static _Build_cache& _Global() noexcept;
+
+        // loads the entries of the previous run, an invalid cache is treated as empty
+        bool _Load(const path& _Target);
+
+        // saves the entries recorded by this run
+        bool _Save(const path& _Target);
+
+        // returns the entry of the previous run, or null if there is none
+        const _Build_cache_entry* _Find(const uint64_t _Key) const noexcept;
+
+        // checks whether the output was built from the same inputs and still has the recorded contents
+        bool _Is_up_to_date(const path& _Output, const uint64_t _Key, const uint64_t _Input_hash) const;
+
+        // records the entry for the next run, must not be called concurrently
+        void _Record(const _Build_cache_entry& _Entry);
+
+        // records the entry of the previous run again, as its output was not rebuilt
+        void _Keep(const _Build_cache_entry& _Entry);
+
+        // returns the number of outputs that were not rebuilt
+        size_t _Kept_count() const noexcept;
+
+    private:
+        vector<_Build_cache_entry> _Myprev; // sorted by key
+        vector<_Build_cache_entry> _Mynext;
+        size_t _Mykept;
+    };
+
+    // writes the output and records it in the cache, returns false if the output could not be written
+    bool _Write_cached_output(const path& _Target, const byte_string_view _Data, const uint64_t _Key,
+        const uint64_t _Input_hash);
+
+    void load_build_cache();
+    void save_build_cache();
+} // namespace mjx
+
+#endif // _MKUTS_BUILD_CACHE_HPP_
\ No newline at end of file
@@ -0,0 +1,194 @@
+// bundle_file.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjfs/status.hpp>
+#include <mkuts/build_cache.hpp>
+#include <mkuts/bundle_file.hpp>
+#include <mkuts/embedded_catalog.hpp>
+#include <mkuts/logger.hpp>
+#include <mkuts/native_catalog.hpp>
+#include <mkuts/options.hpp>
+#include <mkuts/parallel.hpp>
+#include <umls/impl/trace.hpp>
+#include <unordered_map>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    enum class _Bundled_image_state : uint8_t {
+        _Failed,
+        _Rebuilt,
+        _Reused // copied from the previous bundle
+    };
+
+    using _Bundled_image_map = ::std::unordered_map<uint64_t, byte_string_view, ::std::hash<uint64_t>,
+        ::std::equal_to<uint64_t>, object_allocator<::std::pair<const uint64_t, byte_string_view>>>;
+
+    size_t _Umc_table_offset(const byte_string_view _Image) noexcept {
+        // the table follows the signature, the encoding byte (versioned formats only), the language and
+        // the 4-byte LCID and message count
+        if (_Image.size() < 6) { // not a catalog, nothing to align
+            return 0;
+        }
+
+        return _Image[3] == 0 ? 5 + static_cast<size_t>(_Image[4]) + 8 : 6 + static_cast<size_t>(_Image[5]) + 8;
+    }
+
+    bool _Make_bundle_image(const vector<_Uts_catalog>& _Catalogs, const vector<byte_string>& _Images,
+        const uint32_t _Default_lcid, const uint32_t _Preferred_lcid, byte_string& _Bundle) {
+        const size_t _Count = _Catalogs.size();
+        if (_Count != _Images.size() || _Count > 0xFFFF) { // the count must fit in 2-byte integer
+            return false;
+        }
+
+        const uint16_t _Short_count = static_cast<uint16_t>(_Count);
+        _Bundle.clear();
+        _Bundle.append(reinterpret_cast<const byte_t*>("UMB\0"), 4);
+        _Bundle.append(reinterpret_cast<const byte_t*>(&_Default_lcid), sizeof(uint32_t));
+        _Bundle.append(reinterpret_cast<const byte_t*>(&_Preferred_lcid), sizeof(uint32_t));
+        _Bundle.append(reinterpret_cast<const byte_t*>(&_Short_count), sizeof(uint16_t));
+
+        // Note: The catalog header has a variable length, so aligning the catalog itself would leave
+        //       the lookup table misaligned. Instead, each catalog starts just far enough past the previous
+        //       one that its table lands on an aligned offset, the mapping itself is page-aligned.
+        const auto _Align = [](const uint64_t _Off) noexcept {
+            return (_Off + _Umb_table_alignment - 1) & ~static_cast<uint64_t>(_Umb_table_alignment - 1);
+        };
+        vector<uint64_t> _Offsets(_Count);
+        uint64_t _End = _Umb_header_size + _Count * _Umb_index_entry_size;
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            const uint64_t _Table_off = _Umc_table_offset(_Images[_Idx]);
+            const uint64_t _Size      = _Images[_Idx].size();
+            _Offsets[_Idx]            = _Align(_End + _Table_off) - _Table_off;
+            _End                      = _Offsets[_Idx] + _Size;
+            _Bundle.append(reinterpret_cast<const byte_t*>(&_Catalogs[_Idx]), sizeof(_Uts_catalog));
+            _Bundle.append(reinterpret_cast<const byte_t*>(&_Offsets[_Idx]), sizeof(uint64_t));
+            _Bundle.append(reinterpret_cast<const byte_t*>(&_Size), sizeof(uint64_t));
+        }
+
+        _Bundle.reserve(static_cast<size_t>(_End));
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            _Bundle.resize(static_cast<size_t>(_Offsets[_Idx]), byte_t{0}); // pad up to the catalog
+            _Bundle.append(_Images[_Idx]);
+        }
+
+        return true;
+    }
+
+    _Bundled_image_map _Map_bundled_images(const byte_string_view _Bundle) {
+        // maps the hash of every catalog image stored in the bundle to the image, invalid entries are skipped
+        _Bundled_image_map _Map;
+        if (_Bundle.size() < _Umb_header_size || ::memcmp(_Bundle.data(), "UMB\0", 4) != 0) { // not a bundle
+            return _Map;
+        }
+
+        uint16_t _Count;
+        ::memcpy(&_Count, _Bundle.data() + _Umb_header_size - sizeof(uint16_t), sizeof(uint16_t));
+        if (static_cast<size_t>(_Count) * _Umb_index_entry_size > _Bundle.size() - _Umb_header_size) {
+            return _Map; // truncated index
+        }
+
+        const byte_t* _Entry = _Bundle.data() + _Umb_header_size;
+        for (uint16_t _Idx = 0; _Idx < _Count; ++_Idx, _Entry += _Umb_index_entry_size) {
+            uint64_t _Off;
+            uint64_t _Size;
+            ::memcpy(&_Off, _Entry + sizeof(_Uts_catalog), sizeof(uint64_t));
+            ::memcpy(&_Size, _Entry + sizeof(_Uts_catalog) + sizeof(uint64_t), sizeof(uint64_t));
+            if (_Off <= _Bundle.size() && _Size <= _Bundle.size() - _Off) {
+                const byte_string_view _Image{_Bundle.data() + _Off, static_cast<size_t>(_Size)};
+                _Map.emplace(::XXH3_64bits(_Image.data(), _Image.size()), _Image);
+            }
+        }
+
+        return _Map;
+    }
+
+    void create_bundle_file() {
+        _UMLS_TRACE_SPAN("create_bundle_file");
+        const program_options& _Options = program_options::global();
+        if (_Options.bundle.empty()) { // no bundle requested
+            return;
+        }
+
+        vector<_Uts_catalog> _Catalogs;
+        if (!_Make_uts_catalogs_from_umc(_Options.catalogs, _Catalogs)) {
+            rtlog(L"Error: Failed to create the bundle index.");
+            return;
+        }
+
+        const size_t _Count = _Uts_file_writer::_Checked_catalog_count(_Catalogs.size());
+        _Catalogs.resize(_Count);
+
+        // Note: Every catalog is validated and stored in the latest format, along with its ID section.
+        //       A catalog whose source has not changed since the previous run is copied from the previous
+        //       bundle instead, the cache records the hash of its image, so it can be found there.
+        _Build_cache& _Cache = _Build_cache::_Global();
+        byte_string _Previous;
+        if (::mjx::exists(_Options.bundle) && !_Read_binary_file(_Options.bundle, _Previous)) {
+            _Previous.clear(); // rebuild every catalog
+        }
+
+        const _Bundled_image_map& _Reusable = _Map_bundled_images(_Previous);
+        vector<byte_string> _Images(_Count);
+        vector<uint64_t> _Inputs(_Count, 0);
+        vector<_Bundled_image_state> _States(_Count, _Bundled_image_state::_Failed);
+        const bool _Done = ::mjx::_Parallel_for(_Count, [&](const size_t _Idx) {
+            const path& _Catalog = _Options.catalogs[_Idx];
+            byte_string _Source;
+            if (!_Read_binary_file(_Catalog, _Source)) { // failed to read the catalog, break
+                return;
+            }
+
+            _Inputs[_Idx] = _Build_input_hash(_Build_output_kind::_Bundled, _Catalog, _Source);
+            const _Build_cache_entry* const _Entry = _Cache._Find(_Build_output_key(_Options.bundle, _Catalog));
+            if (_Entry && _Entry->_Input_hash == _Inputs[_Idx]) { // unchanged, look for its previous image
+                const auto _Iter = _Reusable.find(_Entry->_Output_hash);
+                if (_Iter != _Reusable.end() && _Iter->second.size() == _Entry->_Output_size) {
+                    _Images[_Idx].assign(_Iter->second.data(), _Iter->second.size());
+                    _States[_Idx] = _Bundled_image_state::_Reused;
+                    return;
+                }
+            }
+
+            _Umc_catalog_image _Image;
+            if (_Load_umc_image(_Source, _Image)) {
+                _Images[_Idx] = _Serialize_umc_image(_Image);
+                _States[_Idx] = _Bundled_image_state::_Rebuilt;
+            }
+        });
+        if (!_Done) {
+            rtlog(L"Error: Failed to load the catalogs.");
+            return;
+        }
+
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            if (_States[_Idx] == _Bundled_image_state::_Failed) { // invalid or corrupted catalog, break
+                rtlog(L"Error: Failed to load the catalog '%s'.", _Options.catalogs[_Idx].c_str());
+                return;
+            }
+        }
+
+        byte_string _Bundle;
+        if (!_Make_bundle_image(_Catalogs, _Images, _Options.default_lcid, _Options.preferred_lcid, _Bundle)) {
+            rtlog(L"Error: Failed to create the bundle.");
+            return;
+        }
+
+        if (_Update_output_file(_Options.bundle, _Bundle) == _Output_update_result::_Failed) {
+            rtlog(L"Error: Failed to write the bundle '%s'.", _Options.bundle.c_str());
+            return;
+        }
+
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            const byte_string& _Image = _Images[_Idx];
+            const _Build_cache_entry _Entry{_Build_output_key(_Options.bundle, _Options.catalogs[_Idx]),
+                _Inputs[_Idx], _Image.size(), ::XXH3_64bits(_Image.data(), _Image.size())};
+            if (_States[_Idx] == _Bundled_image_state::_Reused) {
+                _Cache._Keep(_Entry);
+            } else {
+                _Cache._Record(_Entry);
+            }
+        }
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,34 @@
+// bundle_file.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MKUTS_BUNDLE_FILE_HPP_
+#define _MKUTS_BUNDLE_FILE_HPP_
+#include <cstddef>
+#include <mjstr/string.hpp>
+#include <mkuts/settings_file.hpp>
+#include <mkuts/utils.hpp>
+
+namespace mjx {
+    // Note: The bundle starts with the same 14-byte header as 'settings.uts', with the "UMB\0" signature.
+    //       The header is followed by the index, which holds the 64-byte UTF-8 name, 4-byte LCID,
+    //       8-byte offset and 8-byte size of each catalog, and the catalogs themselves. Each catalog is
+    //       placed so that its lookup table starts at a _Umb_table_alignment boundary, which lets
+    //       the runtime borrow the table from the mapped bundle instead of copying it.
+    inline constexpr size_t _Umb_header_size       = 14;
+    inline constexpr size_t _Umb_index_entry_size  = sizeof(_Uts_catalog) + 2 * sizeof(uint64_t);
+    inline constexpr size_t _Umb_table_alignment   = 16;
+
+    // returns the offset of the lookup table within a UMC image
+    size_t _Umc_table_offset(const byte_string_view _Image) noexcept;
+
+    // packs the settings and the catalogs into a single bundle image
+    bool _Make_bundle_image(const vector<_Uts_catalog>& _Catalogs, const vector<byte_string>& _Images,
+        const uint32_t _Default_lcid, const uint32_t _Preferred_lcid, byte_string& _Bundle);
+
+    void create_bundle_file();
+} // namespace mjx
+
+#endif // _MKUTS_BUNDLE_FILE_HPP_
\ No newline at end of file
@@ -0,0 +1,151 @@
+// catalog_profile.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjstr/char_traits.hpp>
+#include <mkuts/build_cache.hpp>
+#include <mkuts/catalog_profile.hpp>
+#include <mkuts/logger.hpp>
+#include <mkuts/native_catalog.hpp>
+#include <mkuts/options.hpp>
+#include <umls/impl/trace.hpp>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    bool _Load_message_profile(const path& _Target, vector<_Ump_entry>& _Profile) {
+        file _File(_Target, file_access::read, file_share::read);
+        file_stream _Stream(_File);
+        if (!_Stream.is_open()) { // invalid stream, break
+            return false;
+        }
+
+        // Note: The UMP layout is the 4-byte signature, 4-byte entry count and the entries,
+        //       each made of the 8-byte message hash and 8-byte access count.
+        using _Traits                  = char_traits<byte_t>;
+        constexpr byte_t _Signature[4] = {'U', 'M', 'P', '\0'};
+        byte_t _Header[8];
+        if (!_Stream.read_exactly(_Header, sizeof(_Header)) || !_Traits::eq(_Header, _Signature, 4)) {
+            return false; // signature not recognized
+        }
+
+        uint32_t _Count;
+        ::memcpy(&_Count, _Header + 4, sizeof(uint32_t));
+        if (static_cast<uint64_t>(_Count) * sizeof(_Ump_entry) > _File.size() - sizeof(_Header)) {
+            return false; // truncated profile
+        }
+
+        _Profile.resize(_Count);
+        if (_Count > 0 && !_Stream.read_exactly(
+            reinterpret_cast<byte_t*>(_Profile.data()), _Count * sizeof(_Ump_entry))) {
+            return false;
+        }
+
+        ::std::sort(_Profile.begin(), _Profile.end(), [](const _Ump_entry& _Left, const _Ump_entry& _Right) noexcept {
+            return _Left._Hash < _Right._Hash;
+        });
+        return true;
+    }
+
+    uint64_t _Hash_message_profile(const vector<_Ump_entry>& _Profile) noexcept {
+        return _Profile.empty() ? 0 : ::XXH3_64bits(_Profile.data(), _Profile.size() * sizeof(_Ump_entry));
+    }
+
+    uint64_t _Message_access_count(const vector<_Ump_entry>& _Profile, const uint64_t _Hash) noexcept {
+        const auto _Iter = ::std::lower_bound(_Profile.begin(), _Profile.end(), _Hash,
+            [](const _Ump_entry& _Entry, const uint64_t _Value) noexcept {
+                return _Entry._Hash < _Value;
+            });
+        return _Iter != _Profile.end() && _Iter->_Hash == _Hash ? _Iter->_Count : 0;
+    }
+
+    void _Reorder_umc_image(_Umc_catalog_image& _Image, const vector<_Ump_entry>& _Profile) {
+        // Note: Messages that were never accessed keep their relative order, so that messages
+        //       written next to each other (usually by the same feature) stay close together.
+        //       The access counts are looked up once per message, not once per comparison.
+        const size_t _Count = _Image._Table.size();
+        vector<uint64_t> _Access_counts(_Count);
+        vector<size_t> _Order(_Count);
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            _Access_counts[_Idx] = _Message_access_count(_Profile, _Image._Table[_Idx]._Hash);
+            _Order[_Idx]         = _Idx;
+        }
+
+        ::std::stable_sort(_Order.begin(), _Order.end(),
+            [&_Access_counts](const size_t _Left, const size_t _Right) noexcept {
+                return _Access_counts[_Left] > _Access_counts[_Right];
+            });
+
+        vector<_Umc_table_entry> _Table;
+        byte_string _Blob;
+        _Table.reserve(_Count);
+        _Blob.reserve(_Image._Blob.size());
+        for (const size_t _Idx : _Order) { // lay out the messages in the table order
+            _Umc_table_entry _Entry  = _Image._Table[_Idx];
+            const size_t _Old_offset = static_cast<size_t>(_Entry._Offset);
+            _Entry._Offset           = _Blob.size();
+            _Blob.append(_Image._Blob.data() + _Old_offset, _Entry._Length);
+            _Table.push_back(_Entry);
+        }
+
+        _Image._Table = ::std::move(_Table);
+        _Image._Blob  = ::std::move(_Blob);
+    }
+
+    void create_reordered_catalogs() {
+        _UMLS_TRACE_SPAN("create_reordered_catalogs");
+        const program_options& _Options = program_options::global();
+        if (_Options.reordered_catalogs.empty()) { // nothing to reorder
+            return;
+        }
+
+        vector<_Ump_entry> _Profile;
+        if (!_Load_message_profile(_Options.message_profile, _Profile)) {
+            rtlog(L"Error: Failed to load the message profile '%s'.", _Options.message_profile.c_str());
+            return;
+        }
+
+        _Build_cache& _Cache         = _Build_cache::_Global();
+        const uint64_t _Profile_hash = _Hash_message_profile(_Profile);
+        for (const path& _Catalog : _Options.reordered_catalogs) {
+            if (::std::find(_Options.native_catalogs.begin(), _Options.native_catalogs.end(), _Catalog)
+                != _Options.native_catalogs.end()) { // already reordered along with the native copy
+                continue;
+            }
+
+            const path& _Target = _Options.output_dir / _Catalog.filename();
+            if (_Target == _Catalog) { // the catalog would be overwritten while being read, skip it
+                rtlog(L"Error: The reordered catalog '%s' would overwrite its source.", _Catalog.c_str());
+                continue;
+            }
+
+            byte_string _Source;
+            if (!_Read_binary_file(_Catalog, _Source)) { // failed to read the catalog, skip it
+                rtlog(L"Error: Failed to load the catalog '%s'.", _Catalog.c_str());
+                continue;
+            }
+
+            const uint64_t _Key   = _Build_output_key(_Target);
+            const uint64_t _Input =
+                _Build_input_hash(_Build_output_kind::_Reordered, _Catalog, _Source, _Profile_hash);
+            if (_Cache._Is_up_to_date(_Target, _Key, _Input)) { // built from the same catalog and profile, skip it
+                _Cache._Keep(*_Cache._Find(_Key));
+                continue;
+            }
+
+            _Umc_catalog_image _Image;
+            if (!_Load_umc_image(_Source, _Image)) { // invalid or corrupted catalog, skip it
+                rtlog(L"Error: Failed to load the catalog '%s'.", _Catalog.c_str());
+                continue;
+            }
+
+            _Reorder_umc_image(_Image, _Profile);
+            if (!_Write_cached_output(_Target, _Serialize_umc_image(_Image), _Key, _Input)) {
+                rtlog(L"Error: Failed to write the reordered catalog '%s'.", _Target.c_str());
+            }
+        }
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,32 @@
+// catalog_profile.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MKUTS_CATALOG_PROFILE_HPP_
+#define _MKUTS_CATALOG_PROFILE_HPP_
+#include <cstdint>
+#include <mjfs/path.hpp>
+#include <mkuts/embedded_catalog.hpp>
+#include <mkuts/utils.hpp>
+
+namespace mjx {
+    struct _Ump_entry { // access count of a single message, as recorded by umls
+        uint64_t _Hash  = 0;
+        uint64_t _Count = 0;
+    };
+
+    // loads the message profile, the entries are sorted by hash
+    bool _Load_message_profile(const path& _Target, vector<_Ump_entry>& _Profile);
+
+    // returns the hash of the loaded profile, 0 if it is empty
+    uint64_t _Hash_message_profile(const vector<_Ump_entry>& _Profile) noexcept;
+
+    // places the most accessed messages first, both in the table and in the blob
+    void _Reorder_umc_image(_Umc_catalog_image& _Image, const vector<_Ump_entry>& _Profile);
+
+    void create_reordered_catalogs();
+} // namespace mjx
+
+#endif // _MKUTS_CATALOG_PROFILE_HPP_
\ No newline at end of file
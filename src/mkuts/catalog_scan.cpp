@@ -0,0 +1,199 @@
+// catalog_scan.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <mjfs/directory.hpp>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjstr/char_traits.hpp>
+#include <mkuts/catalog_scan.hpp>
+#include <mkuts/embedded_catalog.hpp>
+#include <mkuts/logger.hpp>
+#include <mkuts/options.hpp>
+#include <mkuts/parallel.hpp>
+#include <umls/impl/trace.hpp>
+
+namespace mjx {
+    bool _Read_umc_header(const path& _Target, _Umc_header_info& _Info) {
+        file _File(_Target, file_access::read, file_share::read);
+        file_stream _Stream(_File);
+        if (!_Stream.is_open()) { // invalid stream, break
+            return false;
+        }
+
+        // Note: The header is at most 269 bytes long, that is the 4-byte signature, 1-byte text encoding,
+        //       1-byte language name length, up to 255-byte language name, 4-byte LCID and 4-byte message
+        //       count. Reading the longest possible header at once is cheaper than seeking to each component.
+        using _Traits                     = char_traits<byte_t>;
+        constexpr size_t _Max_header_size = 6 + 255 + 2 * sizeof(uint32_t);
+        constexpr byte_t _Magic[3]        = {'U', 'M', 'C'};
+        constexpr uint8_t _Max_version    = 1;
+        byte_t _Buf[_Max_header_size];
+        const size_t _Size = _Stream.read(_Buf, _Max_header_size);
+        if (_Size < 5 || !_Traits::eq(_Buf, _Magic, sizeof(_Magic)) || _Buf[3] > _Max_version) {
+            return false; // signature or version not recognized
+        }
+
+        const size_t _Len_off = _Buf[3] == 0 ? 4 : 5; // offset of the language name length component
+        if (_Buf[3] > 0 && _Buf[4] > static_cast<uint8_t>(_Umc_text_encoding::_Utf32)) { // unknown encoding
+            return false;
+        }
+
+        const size_t _Off = _Len_off + 1 + static_cast<size_t>(_Buf[_Len_off]); // offset of the LCID
+        if (_Size < _Off + 2 * sizeof(uint32_t)) { // truncated header
+            return false;
+        }
+
+        ::memcpy(&_Info._Lcid, _Buf + _Off, sizeof(uint32_t));
+        ::memcpy(&_Info._Message_count, _Buf + _Off + sizeof(uint32_t), sizeof(uint32_t));
+        return true;
+    }
+
+    void _Scan_directory(const path& _Dir, _Directory_scan_result& _Result) {
+        for (const directory_entry& _Entry : directory_iterator(_Dir)) {
+            const path& _Path = _Entry.absolute_path();
+            if (_Entry.is_directory()) { // links are not followed, so that a tree cannot contain cycles
+                if (!_Entry.is_symlink() && !_Entry.is_junction()) {
+                    _Result._Subdirectories.push_back(_Path);
+                }
+            } else if (_Path.extension() == L".umc") { // catalog found
+                _Result._Catalogs.push_back(_Path);
+            }
+        }
+
+        // sort the entries, so that the order does not depend on the file system
+        const auto _Less = [](const path& _Left, const path& _Right) noexcept {
+            return _Left.native().compare(_Right.native()) < 0;
+        };
+        ::std::sort(_Result._Catalogs.begin(), _Result._Catalogs.end(), _Less);
+        ::std::sort(_Result._Subdirectories.begin(), _Result._Subdirectories.end(), _Less);
+    }
+
+    void _Scan_catalog_directories(_Catalog_scan_totals& _Totals) {
+        _UMLS_TRACE_SPAN("_Scan_catalog_directories");
+        program_options& _Options               = program_options::global();
+        const vector<catalog_directory>& _Roots = _Options.catalog_dirs;
+        if (_Roots.empty()) { // no directories specified, break
+            return;
+        }
+
+        struct _Pending_directory {
+            path _Dir;
+            size_t _Root; // index of the specified directory that contains this one
+        };
+
+        // Note: The directories of each level are scanned in parallel, the subdirectories found form
+        //       the next level. Catalogs of each specified directory are kept apart, so that they can be
+        //       placed where the directory was specified.
+        vector<vector<path>> _Found(_Roots.size());
+        vector<_Pending_directory> _Level;
+        _Level.reserve(_Roots.size());
+        for (size_t _Idx = 0; _Idx < _Roots.size(); ++_Idx) {
+            _Level.push_back(_Pending_directory{_Roots[_Idx].dir, _Idx});
+        }
+
+        while (!_Level.empty()) {
+            vector<_Directory_scan_result> _Results(_Level.size());
+            const bool _Scanned = ::mjx::_Parallel_for(_Level.size(), [&_Level, &_Results](const size_t _Idx) {
+                _Scan_directory(_Level[_Idx]._Dir, _Results[_Idx]);
+            });
+            if (!_Scanned) { // some directories might have been skipped
+                rtlog(L"Error: Failed to scan some of the catalog directories.");
+            }
+
+            vector<_Pending_directory> _Next;
+            for (size_t _Idx = 0; _Idx < _Level.size(); ++_Idx) {
+                const size_t _Root              = _Level[_Idx]._Root;
+                _Directory_scan_result& _Result = _Results[_Idx];
+                _Totals._Found += _Result._Catalogs.size();
+                for (path& _Catalog : _Result._Catalogs) {
+                    _Found[_Root].push_back(::std::move(_Catalog));
+                }
+
+                if (_Roots[_Root].recursive) {
+                    for (path& _Subdir : _Result._Subdirectories) {
+                        _Next.push_back(_Pending_directory{::std::move(_Subdir), _Root});
+                    }
+                }
+            }
+
+            _Totals._Directories += _Level.size();
+            _Level = ::std::move(_Next);
+        }
+
+        // insert the found catalogs between the catalogs specified with '--catalog', in the order of options
+        vector<path>& _Catalogs = _Options.catalogs;
+        vector<path> _Merged;
+        _Merged.reserve(_Catalogs.size() + _Totals._Found);
+        size_t _Next_catalog = 0;
+        for (size_t _Root = 0; _Root < _Roots.size(); ++_Root) {
+            for (; _Next_catalog < _Roots[_Root].position; ++_Next_catalog) {
+                _Merged.push_back(::std::move(_Catalogs[_Next_catalog]));
+            }
+
+            for (path& _Catalog : _Found[_Root]) {
+                if (_Mark_catalog_included(_Catalog)) { // catalog not included, include it
+                    _Merged.push_back(::std::move(_Catalog));
+                } else { // catalog already specified
+                    rtlog(L"Warning: The catalog '%s' already specified, ignored.", _Catalog.c_str());
+                    ++_Totals._Duplicates;
+                }
+            }
+        }
+
+        for (; _Next_catalog < _Catalogs.size(); ++_Next_catalog) {
+            _Merged.push_back(::std::move(_Catalogs[_Next_catalog]));
+        }
+
+        _Catalogs = ::std::move(_Merged);
+    }
+
+    void _Validate_catalogs(_Catalog_scan_totals& _Totals) {
+        _UMLS_TRACE_SPAN("_Validate_catalogs");
+        program_options& _Options = program_options::global();
+        vector<path>& _Catalogs   = _Options.catalogs;
+        vector<uint8_t> _Valid(_Catalogs.size(), 0);
+        const bool _Validated = ::mjx::_Parallel_for(_Catalogs.size(),
+            [&_Catalogs, &_Valid, _Full = _Options.full_validation](const size_t _Idx) {
+                if (_Full) { // parse the whole catalog
+                    _Umc_catalog_image _Image;
+                    _Valid[_Idx] = _Load_umc_image(_Catalogs[_Idx], _Image);
+                } else { // parse just the header
+                    _Umc_header_info _Info;
+                    _Valid[_Idx] = _Read_umc_header(_Catalogs[_Idx], _Info);
+                }
+            });
+        if (!_Validated) { // keep all catalogs, the unchecked ones will be reported when used
+            rtlog(L"Error: Failed to validate the catalogs.");
+            return;
+        }
+
+        size_t _Count = 0;
+        for (size_t _Idx = 0; _Idx < _Catalogs.size(); ++_Idx) {
+            if (_Valid[_Idx]) {
+                if (_Count != _Idx) {
+                    _Catalogs[_Count] = ::std::move(_Catalogs[_Idx]);
+                }
+
+                ++_Count;
+            } else { // invalid or corrupted catalog, skip it
+                rtlog(L"Warning: The catalog '%s' is invalid, ignored.", _Catalogs[_Idx].c_str());
+                ++_Totals._Invalid;
+            }
+        }
+
+        _Catalogs.resize(_Count);
+    }
+
+    void scan_catalogs() {
+        _UMLS_TRACE_SPAN("scan_catalogs");
+        _Catalog_scan_totals _Totals;
+        _Scan_catalog_directories(_Totals);
+        _Validate_catalogs(_Totals);
+        rtlog(L"Included %zu catalogs, found %zu in %zu directories, skipped %zu duplicates and %zu invalid.",
+            program_options::global().catalogs.size(), _Totals._Found, _Totals._Directories, _Totals._Duplicates,
+            _Totals._Invalid);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,47 @@
+// catalog_scan.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MKUTS_CATALOG_SCAN_HPP_
+#define _MKUTS_CATALOG_SCAN_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjfs/path.hpp>
+#include <mkuts/utils.hpp>
+
+namespace mjx {
+    struct _Umc_header_info {
+        uint32_t _Lcid          = 0;
+        uint32_t _Message_count = 0;
+    };
+
+    // reads and validates the UMC header with a single read
+    bool _Read_umc_header(const path& _Target, _Umc_header_info& _Info);
+
+    struct _Directory_scan_result {
+        vector<path> _Catalogs;
+        vector<path> _Subdirectories;
+    };
+
+    // lists the catalogs and subdirectories of a single directory
+    void _Scan_directory(const path& _Dir, _Directory_scan_result& _Result);
+
+    struct _Catalog_scan_totals {
+        size_t _Directories = 0;
+        size_t _Found       = 0; // catalogs found in the directories
+        size_t _Duplicates  = 0;
+        size_t _Invalid     = 0;
+    };
+
+    // walks the directories specified with '--catalog-dir' or '--catalog-tree', a level at a time
+    void _Scan_catalog_directories(_Catalog_scan_totals& _Totals);
+
+    // validates every included catalog and removes the invalid ones
+    void _Validate_catalogs(_Catalog_scan_totals& _Totals);
+
+    void scan_catalogs();
+} // namespace mjx
+
+#endif // _MKUTS_CATALOG_SCAN_HPP_
\ No newline at end of file
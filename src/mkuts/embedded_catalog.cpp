@@ -0,0 +1,281 @@
+// embedded_catalog.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjstr/char_traits.hpp>
+#include <mjstr/conversion.hpp>
+#include <mkuts/build_cache.hpp>
+#include <mkuts/embedded_catalog.hpp>
+#include <mkuts/logger.hpp>
+#include <mkuts/options.hpp>
+#include <umls/impl/catalog.hpp>
+#include <umls/impl/transcode.hpp>
+
+namespace mjx {
+    // Note: mkuts keeps its own copies of the UMC structures, they must stay in sync with the ones used by umls
+    //       to read the catalogs, and with the ones the generated sources are compiled against.
+    using _Umls_table_entry   = umls_impl::_Umc_lookup_table::_Table_entry;
+    using _Umls_text_encoding = umls_impl::_Umc_text_encoding;
+    static_assert(sizeof(_Umc_table_entry) == sizeof(_Umls_table_entry)
+                      && offsetof(_Umc_table_entry, _Offset) == offsetof(_Umls_table_entry, _Offset)
+                      && offsetof(_Umc_table_entry, _Length) == offsetof(_Umls_table_entry, _Length),
+        "_Umc_table_entry must match the UMC table entry read by umls");
+    static_assert(sizeof(_Umc_table_entry) == sizeof(static_catalog_entry)
+                      && offsetof(_Umc_table_entry, _Offset) == offsetof(static_catalog_entry, offset)
+                      && offsetof(_Umc_table_entry, _Length) == offsetof(static_catalog_entry, length),
+        "_Umc_table_entry must match static_catalog_entry");
+    static_assert(static_cast<uint8_t>(_Umc_text_encoding::_Utf8) == static_cast<uint8_t>(_Umls_text_encoding::_Utf8)
+                      && static_cast<uint8_t>(_Umc_text_encoding::_Utf16)
+                             == static_cast<uint8_t>(_Umls_text_encoding::_Utf16)
+                      && static_cast<uint8_t>(_Umc_text_encoding::_Utf32)
+                             == static_cast<uint8_t>(_Umls_text_encoding::_Utf32),
+        "_Umc_text_encoding must match the text encoding read by umls");
+
+    bool _Read_binary_file(const path& _Target, byte_string& _Data) {
+        file _File(_Target, file_access::read, file_share::read);
+        file_stream _Stream(_File);
+        if (!_Stream.is_open()) { // invalid stream, break
+            return false;
+        }
+
+        const size_t _File_size = static_cast<size_t>(_File.size());
+        _Data.assign(_File_size, byte_t{0});
+        return _Stream.read_exactly(_Data.data(), _File_size);
+    }
+
+    bool _Load_umc_image(const path& _Target, _Umc_catalog_image& _Image) {
+        byte_string _Data;
+        return _Read_binary_file(_Target, _Data) && _Load_umc_image(_Data, _Image);
+    }
+
+    bool _Load_umc_image(const byte_string_view _Data, _Umc_catalog_image& _Image) {
+        const size_t _File_size = _Data.size();
+        // Note: The UMC layout is the 4-byte signature, 1-byte language name length, the language name,
+        //       4-byte LCID, 4-byte message count, the lookup table, the blob and the optional ID section.
+        //       The last byte of the signature is the format version, version 1 stores the 1-byte text
+        //       encoding right after the signature.
+        using _Traits                  = char_traits<byte_t>;
+        constexpr byte_t _Magic[3]     = {'U', 'M', 'C'};
+        constexpr uint8_t _Max_version = 1;
+        const byte_t* _First           = _Data.data();
+        const byte_t* const _Last      = _First + _File_size;
+        if (_File_size < 5 || !_Traits::eq(_First, _Magic, sizeof(_Magic)) || _First[3] > _Max_version) {
+            return false; // signature or version not recognized
+        }
+
+        const size_t _Header_size = _First[3] == 0 ? 5 : 6; // signature, encoding and language name length
+        if (_File_size < _Header_size) { // truncated header
+            return false;
+        }
+
+        if (_First[3] > 0) { // version 1 or later, load the text encoding
+            if (_First[4] > static_cast<uint8_t>(_Umc_text_encoding::_Utf32)) { // unknown encoding, break
+                return false;
+            }
+
+            _Image._Encoding = static_cast<_Umc_text_encoding>(_First[4]);
+        }
+
+        const size_t _Lang_length = static_cast<size_t>(_First[_Header_size - 1]);
+        _First += _Header_size;
+        if (static_cast<size_t>(_Last - _First) < _Lang_length + 2 * sizeof(uint32_t)) { // truncated header
+            return false;
+        }
+
+        uint32_t _Count;
+        _Image._Language = ::mjx::to_unicode_string(byte_string_view{_First, _Lang_length});
+        ::memcpy(&_Image._Lcid, _First + _Lang_length, sizeof(uint32_t));
+        ::memcpy(&_Count, _First + _Lang_length + sizeof(uint32_t), sizeof(uint32_t));
+        _First += _Lang_length + 2 * sizeof(uint32_t);
+
+        if (_Count > static_cast<size_t>(_Last - _First) / sizeof(_Umc_table_entry)) { // truncated table
+            return false;
+        }
+
+        const size_t _Table_size = static_cast<size_t>(_Count) * sizeof(_Umc_table_entry);
+
+        _Image._Table.resize(_Count);
+        ::memcpy(_Image._Table.data(), _First, _Table_size);
+        _First += _Table_size;
+
+        const size_t _Remaining = static_cast<size_t>(_Last - _First);
+        size_t _Blob_size       = 0;
+        for (const _Umc_table_entry& _Entry : _Image._Table) { // calculate blob size
+            if (_Entry._Length > _Remaining - _Blob_size) { // truncated blob
+                return false;
+            }
+
+            _Blob_size += _Entry._Length;
+        }
+
+        _Image._Blob.assign(_First, _Blob_size);
+        for (const _Umc_table_entry& _Entry : _Image._Table) { // validate message bounds
+            if (_Entry._Offset > _Blob_size || _Entry._Length > _Blob_size - _Entry._Offset) {
+                return false;
+            }
+        }
+
+        _First += _Blob_size;
+        _Image._Id_section.assign(_First, static_cast<size_t>(_Last - _First)); // the rest is the ID section
+        return true;
+    }
+
+    utf8_string _Make_embedded_catalog_identifier(const path& _Target) {
+        // replace every character that is not allowed in a C++ identifier with an underscore
+        utf8_string _Identifier = "umls_catalog_";
+        for (const wchar_t _Ch : _Target.stem().native()) {
+            const bool _Is_alnum = (_Ch >= L'0' && _Ch <= L'9') || (_Ch >= L'A' && _Ch <= L'Z')
+                || (_Ch >= L'a' && _Ch <= L'z');
+            _Identifier.push_back(_Is_alnum ? static_cast<char>(_Ch) : '_');
+        }
+
+        return _Identifier;
+    }
+
+    void _Append_hex(utf8_string& _Str, uint64_t _Value, const size_t _Digits) {
+        // append _Value as a hexadecimal literal with exactly _Digits digits
+        constexpr char _Hex_digits[] = "0123456789ABCDEF";
+        char _Buf[16];
+        for (size_t _Idx = _Digits; _Idx > 0; --_Idx, _Value >>= 4) {
+            _Buf[_Idx - 1] = _Hex_digits[_Value & 0xF];
+        }
+
+        _Str.append("0x", 2);
+        _Str.append(_Buf, _Digits);
+    }
+
+    void _Append_decimal(utf8_string& _Str, uint64_t _Value) {
+        char _Buf[20];
+        size_t _Off = sizeof(_Buf);
+        do {
+            _Buf[--_Off] = static_cast<char>('0' + _Value % 10);
+            _Value /= 10;
+        } while (_Value > 0);
+
+        _Str.append(_Buf + _Off, sizeof(_Buf) - _Off);
+    }
+
+    utf8_string _Generate_embedded_catalog_source(
+        const path& _Target, const utf8_string_view _Identifier, _Umc_catalog_image& _Image) {
+        // sort the table by hash so that the catalog can use binary search, the blob stays intact
+        ::std::stable_sort(_Image._Table.begin(), _Image._Table.end(),
+            [](const _Umc_table_entry& _Left, const _Umc_table_entry& _Right) noexcept {
+                return _Left._Hash < _Right._Hash;
+            });
+
+        const utf8_string& _Filename = ::mjx::to_utf8_string(_Target.filename().native());
+        utf8_string _Src;
+        _Src.reserve(512 + _Image._Table.size() * 64 + _Image._Blob.size() * 6);
+        _Src.append("// ");
+        _Src.append(::mjx::to_utf8_string(_Target.stem().native()));
+        _Src.append(".cpp\n\n// Generated by mkuts from '");
+        _Src.append(_Filename);
+        _Src.append("', do not edit.\n// Declare it as 'extern const ::mjx::static_catalog ");
+        _Src.append(_Identifier);
+        _Src.append(";' and pass it to message_catalog.\n\n#include <umls/catalog.hpp>\n\nnamespace {\n");
+
+        _Src.append("    constexpr wchar_t _Language[] = {");
+        for (const wchar_t _Ch : _Image._Language) {
+            _Append_hex(_Src, static_cast<uint64_t>(_Ch), 4);
+            _Src.append(", ");
+        }
+
+        _Src.append("0x0000};\n");
+        if (!_Image._Table.empty()) { // zero-size arrays are not allowed, emit the table only if needed
+            _Src.append("\n    constexpr ::mjx::static_catalog_entry _Entries[] = {\n");
+            for (const _Umc_table_entry& _Entry : _Image._Table) {
+                _Src.append("        {");
+                _Append_hex(_Src, _Entry._Hash, 16);
+                _Src.append("ULL, ");
+                _Append_decimal(_Src, _Entry._Offset);
+                _Src.append("ULL, ");
+                _Append_decimal(_Src, _Entry._Length);
+                _Src.append("U},\n");
+            }
+
+            _Src.append("    };\n");
+        }
+
+        if (!_Image._Blob.empty()) { // zero-size arrays are not allowed, emit the blob only if needed
+            constexpr size_t _Bytes_per_line = 16;
+            _Src.append("\n    constexpr ::mjx::byte_t _Blob[] = {");
+            for (size_t _Idx = 0; _Idx < _Image._Blob.size(); ++_Idx) {
+                _Src.append(_Idx % _Bytes_per_line == 0 ? "\n        " : " ");
+                _Append_hex(_Src, _Image._Blob[_Idx], 2);
+                _Src.push_back(',');
+            }
+
+            _Src.append("\n    };\n");
+        }
+
+        _Src.append("} // namespace\n\nextern const ::mjx::static_catalog ");
+        _Src.append(_Identifier);
+        _Src.append(" = {_Language, ");
+        _Append_decimal(_Src, _Image._Lcid);
+        _Src.append(_Image._Table.empty() ? "U, nullptr, 0, " : "U, _Entries, ");
+        if (!_Image._Table.empty()) {
+            _Append_decimal(_Src, _Image._Table.size());
+            _Src.append(", ");
+        }
+
+        if (_Image._Blob.empty()) {
+            _Src.append("nullptr, 0};");
+        } else {
+            _Src.append("_Blob, ");
+            _Append_decimal(_Src, _Image._Blob.size());
+            _Src.append("};");
+        }
+
+        return _Src;
+    }
+
+    void create_embedded_catalog_sources() {
+        const program_options& _Options = program_options::global();
+        _Build_cache& _Cache            = _Build_cache::_Global();
+        for (const path& _Catalog : _Options.embedded_catalogs) {
+            path _Target = _Options.output_dir / _Catalog.stem();
+            _Target += L".cpp";
+            byte_string _Source;
+            if (!_Read_binary_file(_Catalog, _Source)) { // failed to read the catalog, skip it
+                rtlog(L"Error: Failed to load the catalog '%s'.", _Catalog.c_str());
+                continue;
+            }
+
+            const uint64_t _Key   = _Build_output_key(_Target);
+            const uint64_t _Input = _Build_input_hash(_Build_output_kind::_Embedded, _Catalog, _Source);
+            if (_Cache._Is_up_to_date(_Target, _Key, _Input)) { // generated from the same catalog, skip it
+                _Cache._Keep(*_Cache._Find(_Key));
+                continue;
+            }
+
+            _Umc_catalog_image _Image;
+            if (!_Load_umc_image(_Source, _Image)) { // invalid or corrupted catalog, skip it
+                rtlog(L"Error: Failed to load the catalog '%s'.", _Catalog.c_str());
+                continue;
+            }
+
+            if (_Image._Encoding != _Umc_text_encoding::_Utf8) { // static catalogs always store UTF-8 text
+                rtlog(L"Error: The embedded catalog '%s' does not store UTF-8 text.", _Catalog.c_str());
+                continue;
+            }
+
+            // Note: The runtime trusts the text of static catalogs and never validates it, so a catalog
+            //       with malformed UTF-8 must be rejected here.
+            if (!umls_impl::_Validate_utf8(_Image._Blob.data(), _Image._Blob.size())) {
+                rtlog(L"Error: The embedded catalog '%s' stores malformed UTF-8 text.", _Catalog.c_str());
+                continue;
+            }
+
+            const utf8_string& _Identifier = _Make_embedded_catalog_identifier(_Catalog);
+            const utf8_string& _Text       = _Generate_embedded_catalog_source(_Catalog, _Identifier, _Image);
+            if (!_Write_cached_output(_Target,
+                byte_string_view{reinterpret_cast<const byte_t*>(_Text.data()), _Text.size()}, _Key, _Input)) {
+                rtlog(L"Error: Failed to write the embedded catalog '%s'.", _Target.c_str());
+            }
+        }
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,57 @@
+// embedded_catalog.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MKUTS_EMBEDDED_CATALOG_HPP_
+#define _MKUTS_EMBEDDED_CATALOG_HPP_
+#include <cstdint>
+#include <mjfs/path.hpp>
+#include <mjstr/string.hpp>
+#include <mjstr/string_view.hpp>
+#include <mkuts/utils.hpp>
+
+namespace mjx {
+#pragma pack(push)
+#pragma pack(4) // must match the layout of the UMC table entry
+    struct _Umc_table_entry {
+        uint64_t _Hash   = 0;
+        uint64_t _Offset = 0;
+        uint32_t _Length = 0;
+    };
+#pragma pack(pop)
+
+    enum class _Umc_text_encoding : uint8_t { // must match the encoding stored in version 1 catalogs
+        _Utf8  = 0,
+        _Utf16 = 1, // little-endian
+        _Utf32 = 2 // little-endian
+    };
+
+    struct _Umc_catalog_image { // parsed contents of a UMC file
+        unicode_string _Language;
+        uint32_t _Lcid               = 0;
+        _Umc_text_encoding _Encoding = _Umc_text_encoding::_Utf8;
+        vector<_Umc_table_entry> _Table;
+        byte_string _Blob;
+        byte_string _Id_section; // optional, kept as is since it does not depend on the table order
+    };
+
+    // reads the whole file into _Data
+    bool _Read_binary_file(const path& _Target, byte_string& _Data);
+
+    // loads and validates the whole UMC file, or a UMC image that has already been read
+    bool _Load_umc_image(const path& _Target, _Umc_catalog_image& _Image);
+    bool _Load_umc_image(const byte_string_view _Data, _Umc_catalog_image& _Image);
+
+    // creates a C++ identifier from the catalog name
+    utf8_string _Make_embedded_catalog_identifier(const path& _Target);
+
+    // generates a C++ translation unit with the catalog embedded as static data
+    utf8_string _Generate_embedded_catalog_source(
+        const path& _Target, const utf8_string_view _Identifier, _Umc_catalog_image& _Image);
+
+    void create_embedded_catalog_sources();
+} // namespace mjx
+
+#endif // _MKUTS_EMBEDDED_CATALOG_HPP_
\ No newline at end of file
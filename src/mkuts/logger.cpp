@@ -3,21 +3,327 @@
 // Copyright (c) Mateusz Jandura. All rights reserved.
 // SPDX-License-Identifier: Apache-2.0
 
+#include <atomic>
+#include <cstdint>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjfs/status.hpp>
+#include <mjmem/object_allocator.hpp>
+#include <mjmem/smart_pointer.hpp>
+#include <mjsync/srwlock.hpp>
+#include <mjsync/task.hpp>
+#include <mjsync/thread.hpp>
+#include <mjsync/waitable_event.hpp>
 #include <mkuts/logger.hpp>
 #include <mkuts/tinywin.hpp>
 
 namespace mjx {
+    void _Append_utf8(const unicode_string_view _Str, byte_string& _Out) {
+        // encode the string as UTF-8, wchar_t holds UTF-16
+        for (size_t _Idx = 0; _Idx < _Str.size(); ++_Idx) {
+            uint32_t _Code = static_cast<uint32_t>(_Str[_Idx]);
+            if (_Code >= 0xD800 && _Code <= 0xDBFF && _Idx + 1 < _Str.size()) { // possible surrogate pair
+                const uint32_t _Low = static_cast<uint32_t>(_Str[_Idx + 1]);
+                if (_Low >= 0xDC00 && _Low <= 0xDFFF) {
+                    _Code = 0x10000 + ((_Code - 0xD800) << 10) + (_Low - 0xDC00);
+                    ++_Idx;
+                }
+            }
+
+            if ((_Code >= 0xD800 && _Code <= 0xDFFF) || _Code > 0x10FFFF) { // invalid code point, replace it
+                _Code = 0xFFFD;
+            }
+
+            if (_Code < 0x80) {
+                _Out.push_back(static_cast<byte_t>(_Code));
+            } else if (_Code < 0x800) {
+                _Out.push_back(static_cast<byte_t>(0xC0 | (_Code >> 6)));
+                _Out.push_back(static_cast<byte_t>(0x80 | (_Code & 0x3F)));
+            } else if (_Code < 0x10000) {
+                _Out.push_back(static_cast<byte_t>(0xE0 | (_Code >> 12)));
+                _Out.push_back(static_cast<byte_t>(0x80 | ((_Code >> 6) & 0x3F)));
+                _Out.push_back(static_cast<byte_t>(0x80 | (_Code & 0x3F)));
+            } else {
+                _Out.push_back(static_cast<byte_t>(0xF0 | (_Code >> 18)));
+                _Out.push_back(static_cast<byte_t>(0x80 | ((_Code >> 12) & 0x3F)));
+                _Out.push_back(static_cast<byte_t>(0x80 | ((_Code >> 6) & 0x3F)));
+                _Out.push_back(static_cast<byte_t>(0x80 | (_Code & 0x3F)));
+            }
+        }
+    }
+
     void _Write_unicode_console(const unicode_string_view _Str) noexcept {
         void* const _Handle = ::GetStdHandle(STD_OUTPUT_HANDLE);
-        ::WriteConsoleW(_Handle, _Str.data(),
-#ifdef _M_X64
-            static_cast<unsigned long>(_Str.size()),
-#else // ^^^ _M_X64 ^^^ / vvv _M_IX86 vvv
-            _Str.size(),
-#endif // _M_X64
-                nullptr, nullptr);
-        if (!_Str.ends_with(L'\n')) { // break the line
-            ::WriteConsoleW(_Handle, "\n", 1, nullptr, nullptr);
+        DWORD _Written;
+        if (::WriteConsoleW(_Handle, _Str.data(), static_cast<DWORD>(_Str.size()), &_Written, nullptr)) {
+            return;
         }
+
+        try { // the output is redirected to a file or a pipe, write UTF-8 instead
+            byte_string _Utf8;
+            _Append_utf8(_Str, _Utf8);
+            ::WriteFile(_Handle, _Utf8.data(), static_cast<DWORD>(_Utf8.size()), &_Written, nullptr);
+        } catch (...) {
+            // ignore the thrown exception, the message is lost
+        }
+    }
+
+    struct _Log_record {
+        _Log_record* _Next;
+        unicode_string _Text;
+
+        explicit _Log_record(const unicode_string_view _Str) : _Next(nullptr), _Text(_Str) {}
+    };
+
+    class _Log_writer { // writes the log messages on a background thread
+    public:
+        _Log_writer() noexcept
+            : _Myhead(nullptr), _Mylevel(log_severity::info), _Mystop(false), _Mystopped(false), _Myevent(),
+            _Mythread(nullptr), _Mytask(), _Mylock(), _Myfile(), _Mystream() {
+            try {
+                _Mythread = ::mjx::make_unique_smart_ptr<thread>();
+                _Mytask   = _Mythread->schedule_task(&_Log_writer::_Run, this, task_priority::below_normal);
+            } catch (...) {
+                // ignore the thrown exception, the messages are written at once
+            }
+
+            if (!_Mytask.is_registered()) { // no background writer
+                _Mystop.store(true, ::std::memory_order_relaxed);
+                _Mystopped.store(true, ::std::memory_order_relaxed);
+            }
+        }
+
+        ~_Log_writer() noexcept {
+            _Stop();
+        }
+
+        _Log_writer(const _Log_writer&)            = delete;
+        _Log_writer& operator=(const _Log_writer&) = delete;
+
+        static _Log_writer& _Global() noexcept {
+            static _Log_writer _Writer;
+            return _Writer;
+        }
+
+        log_severity _Level() const noexcept {
+            return _Mylevel.load(::std::memory_order_relaxed);
+        }
+
+        void _Level(const log_severity _New_level) noexcept {
+            _Mylevel.store(_New_level, ::std::memory_order_relaxed);
+        }
+
+        void _Push(const unicode_string_view _Str) {
+            _Log_record* const _Record = ::mjx::create_object<_Log_record>(_Str);
+            if (_Mystopped.load(::std::memory_order_acquire)) { // no background writer, write the message now
+                _Record->_Next = nullptr;
+                _Write_records(_Record);
+                return;
+            }
+
+            // Note: The records form a lock-free stack, the writer takes all of them at once and restores
+            //       their order. The writer is woken only when the stack was empty, as otherwise it has
+            //       already been woken and has not taken the records yet.
+            _Log_record* _Head = _Myhead.load(::std::memory_order_relaxed);
+            do {
+                _Record->_Next = _Head;
+            } while (!_Myhead.compare_exchange_weak(_Head, _Record, ::std::memory_order_seq_cst,
+                ::std::memory_order_relaxed));
+
+            // Note: _Stop() may have taken the last records between the check above and the push, in which
+            //       case nobody else would write this one. Either this check sees the writer gone or _Stop()
+            //       sees the record, as both sides use sequentially consistent operations.
+            if (_Mystopped.load(::std::memory_order_seq_cst)) {
+                _Write_records(_Take_records());
+            } else if (!_Head) {
+                _Myevent.notify();
+            }
+        }
+
+        bool _Open_file(const path& _Target) {
+            lock_guard _Guard(_Mylock);
+            _Mystream.close();
+            _Myfile.close();
+            if (::mjx::exists(_Target)) { // file already exists, overwrite it
+                if (!_Myfile.open(_Target, file_access::write) || !_Myfile.resize(0)) {
+                    _Myfile.close();
+                    return false;
+                }
+            } else { // file does not exist, create a new one
+                if (!::mjx::create_file(_Target, ::std::addressof(_Myfile))) {
+                    return false;
+                }
+            }
+
+            _Mystream.bind_file(_Myfile);
+            return _Mystream.is_open();
+        }
+
+        void _Stop() noexcept {
+            if (_Mystop.exchange(true, ::std::memory_order_acq_rel)) { // already stopped or no background writer
+                lock_guard _Guard(_Mylock);
+                _Mystream.flush(); // the messages have been written at once, but may still be buffered
+                return;
+            }
+
+            _Myevent.notify();
+            _Mytask.wait_until_done();
+            _Mythread->terminate(true);
+            _Mystopped.store(true, ::std::memory_order_seq_cst);
+            _Write_records(_Take_records()); // pushed while the writer was finishing
+            lock_guard _Guard(_Mylock);
+            _Mystream.flush();
+        }
+
+    private:
+        void _Write_record(const unicode_string_view _Text) noexcept {
+            // writes a single record to every sink, used when there is not enough memory for the whole batch
+            _Write_unicode_console(_Text);
+            if (!_Text.ends_with(L'\n')) {
+                _Write_unicode_console(L"\n");
+            }
+
+            _Write_file_record(_Text);
+        }
+
+        void _Write_file_record(const unicode_string_view _Text) noexcept {
+            // writes a single record to the log file, if there is one
+            if (_Mystream.is_open()) {
+                try {
+                    byte_string _Utf8;
+                    _Append_utf8(_Text, _Utf8);
+                    if (!_Text.ends_with(L'\n')) {
+                        _Utf8.push_back(byte_t{'\n'});
+                    }
+
+                    _Mystream.write(_Utf8);
+                } catch (...) {
+                    // ignore the thrown exception, the record is missing from the log file
+                }
+            }
+        }
+
+        static void _Run(void* const _Arg) noexcept {
+            static_cast<_Log_writer*>(_Arg)->_Write_pending_records();
+        }
+
+        void _Write_pending_records() noexcept {
+            for (;;) {
+                _Myevent.wait_and_reset();
+                _Write_records(_Take_records());
+                if (_Mystop.load(::std::memory_order_acquire)) { // stop requested, write the rest and break
+                    _Write_records(_Take_records());
+                    break;
+                }
+            }
+        }
+
+        _Log_record* _Take_records() noexcept {
+            // takes all records and restores the order in which they were pushed
+            _Log_record* _Record = _Myhead.exchange(nullptr, ::std::memory_order_seq_cst);
+            _Log_record* _First  = nullptr;
+            while (_Record) {
+                _Log_record* const _Next = _Record->_Next;
+                _Record->_Next           = _First;
+                _First                   = _Record;
+                _Record                  = _Next;
+            }
+
+            return _First;
+        }
+
+        void _Write_records(_Log_record* _First) noexcept {
+            if (!_First) { // nothing to write, break
+                return;
+            }
+
+            // Note: The whole batch is written with a single call per sink, which matters when thousands
+            //       of catalogs produce warnings.
+            lock_guard _Guard(_Mylock);
+            unicode_string _Batch;
+            bool _Batched = true;
+            try {
+                for (const _Log_record* _Record = _First; _Record; _Record = _Record->_Next) {
+                    _Batch.append(_Record->_Text);
+                    if (!_Record->_Text.ends_with(L'\n')) { // break the line
+                        _Batch.push_back(L'\n');
+                    }
+                }
+            } catch (...) { // not enough memory for the batch, write the records one by one
+                _Batched = false;
+            }
+
+            if (!_Batched) {
+                for (const _Log_record* _Record = _First; _Record; _Record = _Record->_Next) {
+                    _Write_record(_Record->_Text);
+                }
+            } else {
+                _Write_unicode_console(_Batch);
+                if (_Mystream.is_open()) { // write to the log file as well
+                    // Note: The console already has the batch, so only the log file falls back
+                    //       to single records if the batch cannot be converted.
+                    try {
+                        byte_string _Utf8;
+                        _Append_utf8(_Batch, _Utf8);
+                        _Mystream.write(_Utf8);
+                    } catch (...) { // not enough memory for the UTF-8 batch, write the records one by one
+                        for (const _Log_record* _Record = _First; _Record; _Record = _Record->_Next) {
+                            _Write_file_record(_Record->_Text);
+                        }
+                    }
+                }
+            }
+
+            while (_First) {
+                _Log_record* const _Next = _First->_Next;
+                ::mjx::delete_object(_First);
+                _First = _Next;
+            }
+        }
+
+        ::std::atomic<_Log_record*> _Myhead;
+        ::std::atomic<log_severity> _Mylevel;
+        ::std::atomic<bool> _Mystop; // set once stop_logger() is called
+        ::std::atomic<bool> _Mystopped; // set once the background writer is gone
+        waitable_event _Myevent;
+        unique_smart_ptr<thread> _Mythread;
+        task _Mytask;
+        shared_lock _Mylock; // guards the sinks
+        file _Myfile;
+        file_stream _Mystream;
+    };
+
+    log_severity _Log_severity_of(const unicode_string_view _Fmt) noexcept {
+        if (_Fmt.starts_with(L"Error:")) {
+            return log_severity::error;
+        } else if (_Fmt.starts_with(L"Warning:")) {
+            return log_severity::warning;
+        } else {
+            return log_severity::info;
+        }
+    }
+
+    bool _Is_log_severity_enabled(const log_severity _Severity) noexcept {
+        return _Severity >= _Log_writer::_Global()._Level();
+    }
+
+    void _Enqueue_log_message(const log_severity, const unicode_string_view _Str) {
+        _Log_writer::_Global()._Push(_Str);
+    }
+
+    log_severity log_level() noexcept {
+        return _Log_writer::_Global()._Level();
+    }
+
+    void log_level(const log_severity _New_level) noexcept {
+        _Log_writer::_Global()._Level(_New_level);
+    }
+
+    bool set_log_file(const path& _Target) {
+        return _Log_writer::_Global()._Open_file(_Target);
+    }
+
+    void stop_logger() noexcept {
+        _Log_writer::_Global()._Stop();
     }
 } // namespace mjx
\ No newline at end of file
@@ -6,12 +6,20 @@
 #pragma once
 #ifndef _MKUTS_LOGGER_HPP_
 #define _MKUTS_LOGGER_HPP_
+#include <cstddef>
 #include <cstdio>
+#include <mjfs/path.hpp>
 #include <mjstr/string.hpp>
 #include <mjstr/string_view.hpp>
 #include <type_traits>
 
 namespace mjx {
+    enum class log_severity : unsigned char {
+        info,
+        warning,
+        error
+    };
+
     void _Write_unicode_console(const unicode_string_view _Str) noexcept;
 
     template <class... _Types>
@@ -26,10 +34,67 @@ namespace mjx {
         }
     }
 
+    // Note: Messages follow the 'Error: ' and 'Warning: ' prefix convention, the severity is taken
+    //       from the prefix, other messages are informational.
+    log_severity _Log_severity_of(const unicode_string_view _Fmt) noexcept;
+
+    // checks whether messages of the given severity are logged
+    bool _Is_log_severity_enabled(const log_severity _Severity) noexcept;
+
+    // passes the message to the log writer, which writes it in the background
+    void _Enqueue_log_message(const log_severity _Severity, const unicode_string_view _Str);
+
+    inline constexpr size_t _Log_buffer_size = 1024;
+
+    // per-thread buffer that most messages are formatted into, so that they are formatted only once
+    inline thread_local wchar_t _Log_buffer[_Log_buffer_size];
+
+    template <class... _Types>
+    inline unicode_string _Format_long_log_message(const unicode_string_view _Fmt, const _Types&... _Args) {
+        // Note: swprintf() does not report the required length once the buffer is too small, so the message
+        //       is formatted into a buffer 16 times larger. Only a message that does not fit even there
+        //       is measured first, which formats it twice more.
+        constexpr size_t _Buf_size = 16 * _Log_buffer_size;
+        unicode_string _Buf(_Buf_size, L'\0');
+        const int _Length = ::swprintf(_Buf.data(), _Buf_size, _Fmt.data(), _Args...);
+        if (_Length >= 0 && static_cast<size_t>(_Length) < _Buf_size) {
+            _Buf.resize(static_cast<size_t>(_Length));
+            return _Buf;
+        }
+
+        return _Format_string(_Fmt, _Args...);
+    }
+
+    // returns or changes the lowest severity that is logged
+    log_severity log_level() noexcept;
+    void log_level(const log_severity _New_level) noexcept;
+
+    // writes the log to the given file as well, in addition to the console
+    bool set_log_file(const path& _Target);
+
+    // writes all pending messages and stops the background writer, later messages are written at once
+    void stop_logger() noexcept;
+
+    // Note: mkuts is Windows-only, it enters through wmain(). The messages are formatted with the MSVC
+    //       wide-character functions, where '%s' in a wide format string refers to a wchar_t string.
     template <class... _Types>
     inline void rtlog(const unicode_string_view _Fmt, const _Types&... _Args) {
         // write formatted message to the runtime log
-        _Write_unicode_console(_Format_string(_Fmt, _Args...));
+        const log_severity _Severity = _Log_severity_of(_Fmt);
+        if (!_Is_log_severity_enabled(_Severity)) { // filtered out, don't format the message
+            return;
+        }
+
+        if constexpr (sizeof...(_Types) > 0) { // format the message into the buffer, if it fits
+            const int _Length = ::swprintf(_Log_buffer, _Log_buffer_size, _Fmt.data(), _Args...);
+            if (_Length >= 0 && static_cast<size_t>(_Length) < _Log_buffer_size) {
+                _Enqueue_log_message(_Severity, unicode_string_view{_Log_buffer, static_cast<size_t>(_Length)});
+            } else { // the message is too long, format it again into a larger string
+                _Enqueue_log_message(_Severity, _Format_long_log_message(_Fmt, _Args...));
+            }
+        } else {
+            _Enqueue_log_message(_Severity, _Fmt);
+        }
     }
 } // namespace mjx
 
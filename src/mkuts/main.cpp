@@ -5,9 +5,16 @@
 
 #include <mjmem/exception.hpp>
 #include <mjstr/char_traits.hpp>
+#include <mkuts/build_cache.hpp>
+#include <mkuts/bundle_file.hpp>
+#include <mkuts/catalog_scan.hpp>
+#include <mkuts/catalog_profile.hpp>
+#include <mkuts/embedded_catalog.hpp>
 #include <mkuts/logger.hpp>
+#include <mkuts/native_catalog.hpp>
 #include <mkuts/options.hpp>
 #include <mkuts/settings_file.hpp>
+#include <umls/impl/trace.hpp>
 
 namespace mjx {
     inline bool _Should_print_help(int _Count, wchar_t** _Args) noexcept {
@@ -37,15 +44,37 @@ namespace mjx {
             L"\n"
             L"    --catalog=\"[...]\"          include the specified catalog\n"
             L"    --catalog-dir=\"[...]\"      include all catalogs from the specified directory\n"
+            L"    --catalog-tree=\"[...]\"     include all catalogs from the specified directory tree\n"
+            L"    --validate=<value>         validate the catalog headers (header, default) or whole catalogs (full)\n"
+            L"    --bundle=\"[...]\"           pack the settings and all included catalogs into the specified file\n"
+            L"    --embed-catalog=\"[...]\"    generate a C++ source file with the specified catalog embedded\n"
+            L"    --native-catalog=\"[...]\"   write a copy of the specified catalog with the text stored as wchar_t\n"
+            L"    --reorder-catalog=\"[...]\"  write a copy of the specified catalog with the hot messages first\n"
+            L"    --message-profile=\"[...]\"  set the message profile used to reorder catalogs\n"
             L"    --output-dir=\"[...]\"       set the output directory for the created settings file\n"
+            L"    --settings-version=<value> set the settings file format, 0 (legacy) or 2 (default)\n"
+            L"    --log-file=\"[...]\"         write the log to the specified file as well\n"
+            L"    --log-level=<value>        set the lowest logged severity, info (default), warning or error\n"
             L"\n"
             L"    --default-lcid=<value>     set the default LCID\n"
             L"    --preferred-lcid=<value>   set the preferred LCID"
         );
     }
+
+    struct _Logger_guard { // writes the pending messages before mkuts exits
+        _Logger_guard() noexcept {}
+
+        ~_Logger_guard() noexcept {
+            ::mjx::stop_logger();
+        }
+
+        _Logger_guard(const _Logger_guard&)            = delete;
+        _Logger_guard& operator=(const _Logger_guard&) = delete;
+    };
 } // namespace mjx
 
 int wmain(int _Count, wchar_t** _Args) {
+    const ::mjx::_Logger_guard _Guard;
     try {
         // skip the first argument, which is always the path or name of the executable file
         if (::mjx::_Should_print_help(--_Count, ++_Args)) { // print help and exit
@@ -54,7 +83,19 @@ int wmain(int _Count, wchar_t** _Args) {
         }
 
         ::mjx::parse_program_args(_Count, _Args);
+        ::mjx::scan_catalogs();
+        ::mjx::load_build_cache();
         ::mjx::create_or_overwrite_settings_file();
+        ::mjx::create_bundle_file();
+        ::mjx::create_embedded_catalog_sources();
+        ::mjx::create_native_catalogs();
+        ::mjx::create_reordered_catalogs();
+        ::mjx::save_build_cache();
+#ifdef UMLS_ENABLE_TRACING
+        if (!::mjx::umls_impl::_Write_trace_events(L"mkuts.trace.json")) {
+            ::mjx::rtlog(L"Warning: Failed to write the trace events.");
+        }
+#endif // UMLS_ENABLE_TRACING
         return 0;
     } catch (const ::mjx::allocation_failure&) {
         ::mjx::rtlog(L"Error: Insufficient memory to complete the operation.");
@@ -0,0 +1,107 @@
+// native_catalog.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjstr/conversion.hpp>
+#include <mkuts/build_cache.hpp>
+#include <mkuts/catalog_profile.hpp>
+#include <mkuts/logger.hpp>
+#include <mkuts/native_catalog.hpp>
+#include <mkuts/options.hpp>
+
+namespace mjx {
+    bool _Encode_native_umc_image(_Umc_catalog_image& _Image) {
+        if (_Image._Encoding != _Umc_text_encoding::_Utf8) { // already stored in a wide encoding, break
+            return false;
+        }
+
+        byte_string _Blob;
+        _Blob.reserve(_Image._Blob.size() * sizeof(wchar_t));
+        for (_Umc_table_entry& _Entry : _Image._Table) {
+            const unicode_string& _Msg = ::mjx::to_unicode_string(byte_string_view{
+                _Image._Blob.data() + static_cast<size_t>(_Entry._Offset), static_cast<size_t>(_Entry._Length)});
+            if (_Msg.empty() && _Entry._Length > 0) { // malformed UTF-8, break
+                return false;
+            }
+
+            // offsets and lengths are still expressed in bytes
+            _Entry._Offset = _Blob.size();
+            _Entry._Length = static_cast<uint32_t>(_Msg.size() * sizeof(wchar_t));
+            _Blob.append(reinterpret_cast<const byte_t*>(_Msg.data()), _Msg.size() * sizeof(wchar_t));
+        }
+
+        _Image._Blob     = ::std::move(_Blob);
+        _Image._Encoding = sizeof(wchar_t) == 2 ? _Umc_text_encoding::_Utf16 : _Umc_text_encoding::_Utf32;
+        return true;
+    }
+
+    byte_string _Serialize_umc_image(const _Umc_catalog_image& _Image) {
+        const utf8_string& _Language = ::mjx::to_utf8_string(_Image._Language);
+        const uint32_t _Count        = static_cast<uint32_t>(_Image._Table.size());
+        const size_t _Table_size     = _Image._Table.size() * sizeof(_Umc_table_entry);
+        byte_string _Data;
+        _Data.reserve(14 + _Language.size() + _Table_size + _Image._Blob.size() + _Image._Id_section.size());
+        _Data.append(reinterpret_cast<const byte_t*>("UMC\1"), 4); // version 1
+        _Data.push_back(static_cast<byte_t>(_Image._Encoding));
+        _Data.push_back(static_cast<byte_t>(_Language.size()));
+        _Data.append(reinterpret_cast<const byte_t*>(_Language.data()), _Language.size());
+        _Data.append(reinterpret_cast<const byte_t*>(&_Image._Lcid), sizeof(uint32_t));
+        _Data.append(reinterpret_cast<const byte_t*>(&_Count), sizeof(uint32_t));
+        _Data.append(reinterpret_cast<const byte_t*>(_Image._Table.data()), _Table_size);
+        _Data.append(_Image._Blob);
+        _Data.append(_Image._Id_section);
+        return _Data;
+    }
+
+    void create_native_catalogs() {
+        const program_options& _Options = program_options::global();
+        vector<_Ump_entry> _Profile;
+        if (!_Options.native_catalogs.empty() && !_Options.message_profile.empty()
+            && !_Load_message_profile(_Options.message_profile, _Profile)) { // keep the original order
+            rtlog(L"Warning: Failed to load the message profile '%s'.", _Options.message_profile.c_str());
+        }
+
+        _Build_cache& _Cache         = _Build_cache::_Global();
+        const uint64_t _Profile_hash = _Hash_message_profile(_Profile);
+        for (const path& _Catalog : _Options.native_catalogs) {
+            const path& _Target = _Options.output_dir / _Catalog.filename();
+            if (_Target == _Catalog) { // the catalog would be overwritten while being read, skip it
+                rtlog(L"Error: The native catalog '%s' would overwrite its source.", _Catalog.c_str());
+                continue;
+            }
+
+            byte_string _Source;
+            if (!_Read_binary_file(_Catalog, _Source)) { // failed to read the catalog, skip it
+                rtlog(L"Error: Failed to load the catalog '%s'.", _Catalog.c_str());
+                continue;
+            }
+
+            const uint64_t _Key   = _Build_output_key(_Target);
+            const uint64_t _Input = _Build_input_hash(_Build_output_kind::_Native, _Catalog, _Source, _Profile_hash);
+            if (_Cache._Is_up_to_date(_Target, _Key, _Input)) { // built from the same catalog and profile, skip it
+                _Cache._Keep(*_Cache._Find(_Key));
+                continue;
+            }
+
+            _Umc_catalog_image _Image;
+            if (!_Load_umc_image(_Source, _Image)) { // invalid or corrupted catalog, skip it
+                rtlog(L"Error: Failed to load the catalog '%s'.", _Catalog.c_str());
+                continue;
+            }
+
+            if (!_Encode_native_umc_image(_Image)) { // not a UTF-8 catalog or malformed text, skip it
+                rtlog(L"Error: Failed to re-encode the catalog '%s'.", _Catalog.c_str());
+                continue;
+            }
+
+            if (!_Profile.empty()) { // place the most accessed messages first
+                _Reorder_umc_image(_Image, _Profile);
+            }
+
+            if (!_Write_cached_output(_Target, _Serialize_umc_image(_Image), _Key, _Input)) {
+                rtlog(L"Error: Failed to write the native catalog '%s'.", _Target.c_str());
+            }
+        }
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,24 @@
+// native_catalog.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MKUTS_NATIVE_CATALOG_HPP_
+#define _MKUTS_NATIVE_CATALOG_HPP_
+#include <mjfs/path.hpp>
+#include <mjstr/string.hpp>
+#include <mjstr/string_view.hpp>
+#include <mkuts/embedded_catalog.hpp>
+
+namespace mjx {
+    // re-encodes the catalog text to the width of wchar_t, the table is rebuilt to match
+    bool _Encode_native_umc_image(_Umc_catalog_image& _Image);
+
+    // serializes the catalog image as a version 1 UMC file
+    byte_string _Serialize_umc_image(const _Umc_catalog_image& _Image);
+
+    void create_native_catalogs();
+} // namespace mjx
+
+#endif // _MKUTS_NATIVE_CATALOG_HPP_
\ No newline at end of file
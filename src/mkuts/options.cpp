@@ -7,10 +7,15 @@
 #include <mjfs/status.hpp>
 #include <mkuts/logger.hpp>
 #include <mkuts/options.hpp>
+#include <umls/impl/translator.hpp>
+#include <unordered_set>
+#include <xxhash/xxhash.h>
 
 namespace mjx {
     program_options::program_options() noexcept
-        : catalogs(), output_dir(), default_lcid(0), preferred_lcid(0) {}
+        : catalogs(), catalog_dirs(), embedded_catalogs(), native_catalogs(), reordered_catalogs(), message_profile(),
+        bundle(), output_dir(), default_lcid(0), preferred_lcid(0), settings_version(umls_impl::_Uts_indexed_version),
+        full_validation(false) {}
 
     program_options::~program_options() noexcept {}
 
@@ -19,14 +24,29 @@ namespace mjx {
         return _Options;
     }
 
-    bool _Is_catalog_included(const path& _Path) noexcept {
-        for (const path& _Catalog : program_options::global().catalogs) {
-            if (_Catalog == _Path) { // searched catalog found, break
-                return true;
-            }
+    struct _Catalog_path_hash {
+        size_t operator()(const unicode_string& _Path) const noexcept {
+            return static_cast<size_t>(::XXH3_64bits(_Path.data(), _Path.size() * sizeof(wchar_t)));
         }
+    };
+
+    using _Catalog_path_set = ::std::unordered_set<unicode_string, _Catalog_path_hash,
+        ::std::equal_to<unicode_string>, object_allocator<unicode_string>>;
+
+    _Catalog_path_set& _Included_catalogs() {
+        // Note: Directories may contain thousands of catalogs, so the included ones are tracked in a hash set
+        //       rather than searched for in program_options::catalogs.
+        static _Catalog_path_set _Set;
+        return _Set;
+    }
+
+    bool _Is_catalog_included(const path& _Path) {
+        return _Included_catalogs().contains(_Path.native());
+    }
 
-        return false; // not found
+    bool _Mark_catalog_included(const path& _Path) {
+        // returns false if the catalog was already included
+        return _Included_catalogs().insert(_Path.native()).second;
     }
 
     path _Absolute_path(const path& _Path) {
@@ -46,6 +66,14 @@ namespace mjx {
         }
     }
 
+    bool _Has_settings_inputs() noexcept {
+        // Note: Runs that only generate embedded, native or reordered catalogs specify none of these,
+        //       so they must leave an existing settings file as it is.
+        const program_options& _Options = program_options::global();
+        return !_Options.catalogs.empty() || !_Options.catalog_dirs.empty() || _Options.default_lcid != 0
+            || _Options.preferred_lcid != 0;
+    }
+
     void _Options_parser::_Parse_catalog(const unicode_string_view _Value) {
         vector<path>& _Catalogs = program_options::global().catalogs;
         path _Path              = _Absolute_path(_Value);
@@ -64,12 +92,114 @@ namespace mjx {
             return;
         }
 
+        _Mark_catalog_included(_Path);
         _Catalogs.push_back(::std::move(_Path));
     }
     
-    void _Options_parser::_Parse_catalog_directory(const unicode_string_view _Value) {
-        vector<path>& _Catalogs = program_options::global().catalogs;
-        const path& _Path       = _Absolute_path(_Value);
+    void _Options_parser::_Parse_embedded_catalog(const unicode_string_view _Value) {
+        vector<path>& _Catalogs = program_options::global().embedded_catalogs;
+        path _Path              = _Absolute_path(_Value);
+        for (const path& _Catalog : _Catalogs) {
+            if (_Catalog == _Path) { // already specified
+                rtlog(L"Warning: The embedded catalog '%s' specified more than once, ignored.", _Value.data());
+                return;
+            }
+        }
+
+        if (!::mjx::exists(_Path)) { // specified non-existent file
+            rtlog(L"Warning: The embedded catalog '%s' does not exist, ignored.", _Value.data());
+            return;
+        }
+
+        if (_Path.extension() != L".umc") { // specified not recognized file
+            rtlog(L"Warning: The embedded catalog '%s' has an invalid extension, ignored.", _Value.data());
+            return;
+        }
+
+        _Catalogs.push_back(::std::move(_Path));
+    }
+
+    void _Options_parser::_Parse_native_catalog(const unicode_string_view _Value) {
+        vector<path>& _Catalogs = program_options::global().native_catalogs;
+        path _Path              = _Absolute_path(_Value);
+        for (const path& _Catalog : _Catalogs) {
+            if (_Catalog == _Path) { // already specified
+                rtlog(L"Warning: The native catalog '%s' specified more than once, ignored.", _Value.data());
+                return;
+            }
+        }
+
+        if (!::mjx::exists(_Path)) { // specified non-existent file
+            rtlog(L"Warning: The native catalog '%s' does not exist, ignored.", _Value.data());
+            return;
+        }
+
+        if (_Path.extension() != L".umc") { // specified not recognized file
+            rtlog(L"Warning: The native catalog '%s' has an invalid extension, ignored.", _Value.data());
+            return;
+        }
+
+        _Catalogs.push_back(::std::move(_Path));
+    }
+
+    void _Options_parser::_Parse_reordered_catalog(const unicode_string_view _Value) {
+        vector<path>& _Catalogs = program_options::global().reordered_catalogs;
+        path _Path              = _Absolute_path(_Value);
+        for (const path& _Catalog : _Catalogs) {
+            if (_Catalog == _Path) { // already specified
+                rtlog(L"Warning: The reordered catalog '%s' specified more than once, ignored.", _Value.data());
+                return;
+            }
+        }
+
+        if (!::mjx::exists(_Path)) { // specified non-existent file
+            rtlog(L"Warning: The reordered catalog '%s' does not exist, ignored.", _Value.data());
+            return;
+        }
+
+        if (_Path.extension() != L".umc") { // specified not recognized file
+            rtlog(L"Warning: The reordered catalog '%s' has an invalid extension, ignored.", _Value.data());
+            return;
+        }
+
+        _Catalogs.push_back(::std::move(_Path));
+    }
+
+    void _Options_parser::_Parse_message_profile(const unicode_string_view _Value) {
+        path& _Profile = program_options::global().message_profile;
+        if (!_Profile.empty()) { // the message profile already specified
+            rtlog(L"Warning: Message profile specified more than once, ignored.");
+            return;
+        }
+
+        path _Path = _Absolute_path(_Value);
+        if (!::mjx::exists(_Path)) { // specified non-existent file
+            rtlog(L"Warning: The message profile '%s' does not exist, ignored.", _Value.data());
+            return;
+        }
+
+        _Profile = ::std::move(_Path);
+    }
+
+    void _Options_parser::_Parse_bundle(const unicode_string_view _Value) {
+        path& _Bundle = program_options::global().bundle;
+        if (!_Bundle.empty()) { // the bundle already specified
+            rtlog(L"Warning: Bundle specified more than once, ignored.");
+            return;
+        }
+
+        path _Path = _Absolute_path(_Value);
+        if (_Path.extension() != L".umb") { // specified not recognized file
+            rtlog(L"Warning: The bundle '%s' has an invalid extension, ignored.", _Value.data());
+            return;
+        }
+
+        _Bundle = ::std::move(_Path);
+    }
+
+    void _Options_parser::_Parse_catalog_directory(const unicode_string_view _Value, const bool _Recursive) {
+        program_options& _Options = program_options::global();
+        path _Path                = _Absolute_path(_Value);
         if (!::mjx::exists(_Path)) { // specified non-existent directory
             rtlog(L"Warning: The directory '%s' does not exist, ignored.", _Value.data());
             return;
@@ -80,15 +210,17 @@ namespace mjx {
             return;
         }
 
-        for (const directory_entry& _Entry : directory_iterator(_Path)) {
-            const path& _File = _Entry.absolute_path();
-            if (_File.extension() == L".umc") { // catalog found
-                if (!_Is_catalog_included(_File)) { // catalog not included, include it
-                    _Catalogs.push_back(_File);
-                } else { // catalog already specified
-                    rtlog(L"Warning: The catalog '%s' already specified, ignored.", _File.c_str());
-                }
-            }
+        // the directory is scanned by scan_catalogs(), its catalogs are placed where it was specified
+        _Options.catalog_dirs.push_back(catalog_directory{::std::move(_Path), _Options.catalogs.size(), _Recursive});
+    }
+
+    void _Options_parser::_Parse_catalog_validation(const unicode_string_view _Value) noexcept {
+        if (_Value == L"header") {
+            program_options::global().full_validation = false;
+        } else if (_Value == L"full") {
+            program_options::global().full_validation = true;
+        } else { // not supported validation
+            rtlog(L"Warning: The validation '%s' is not supported, ignored.", _Value.data());
         }
     }
 
@@ -135,6 +267,36 @@ namespace mjx {
         _Lcid = _Val;
     }
 
+    void _Options_parser::_Parse_settings_version(const unicode_string_view _Value) noexcept {
+        // the value is the version stored in the last signature byte
+        if (_Value == L"0") {
+            program_options::global().settings_version = umls_impl::_Uts_legacy_version;
+        } else if (_Value == L"2") {
+            program_options::global().settings_version = umls_impl::_Uts_indexed_version;
+        } else { // not supported version
+            rtlog(L"Warning: The settings version '%s' is not supported, ignored.", _Value.data());
+        }
+    }
+
+    void _Options_parser::_Parse_log_file(const unicode_string_view _Value) {
+        // Note: The file is opened at once, so that the messages of the remaining options are written to it.
+        if (!::mjx::set_log_file(_Absolute_path(_Value))) {
+            rtlog(L"Warning: Failed to open the log file '%s', ignored.", _Value.data());
+        }
+    }
+
+    void _Options_parser::_Parse_log_level(const unicode_string_view _Value) noexcept {
+        if (_Value == L"info") {
+            ::mjx::log_level(log_severity::info);
+        } else if (_Value == L"warning") {
+            ::mjx::log_level(log_severity::warning);
+        } else if (_Value == L"error") {
+            ::mjx::log_level(log_severity::error);
+        } else { // not supported log level
+            rtlog(L"Warning: The log level '%s' is not supported, ignored.", _Value.data());
+        }
+    }
+
     void parse_program_args(int _Count, wchar_t** _Args) {
         program_options& _Options = program_options::global();
         unicode_string_view _Arg;
@@ -156,10 +318,30 @@ namespace mjx {
             const unicode_string_view _Value  = _Arg.substr(_Eq_pos + 1);
             if (_Option == L"--catalog") { // include a catalog
                 _Options_parser::_Parse_catalog(_Value);
+            } else if (_Option == L"--embed-catalog") { // generate a C++ source with an embedded catalog
+                _Options_parser::_Parse_embedded_catalog(_Value);
+            } else if (_Option == L"--native-catalog") { // re-encode a catalog to the native wide text
+                _Options_parser::_Parse_native_catalog(_Value);
+            } else if (_Option == L"--reorder-catalog") { // place the most accessed messages first
+                _Options_parser::_Parse_reordered_catalog(_Value);
+            } else if (_Option == L"--message-profile") { // set the profile used to reorder catalogs
+                _Options_parser::_Parse_message_profile(_Value);
+            } else if (_Option == L"--bundle") { // pack the settings and catalogs into a single file
+                _Options_parser::_Parse_bundle(_Value);
             } else if (_Option == L"--catalog-dir") { // include catalogs from a directory
-                _Options_parser::_Parse_catalog_directory(_Value);
+                _Options_parser::_Parse_catalog_directory(_Value, false);
+            } else if (_Option == L"--catalog-tree") { // include catalogs from a directory tree
+                _Options_parser::_Parse_catalog_directory(_Value, true);
+            } else if (_Option == L"--validate") { // set how thoroughly catalogs are validated
+                _Options_parser::_Parse_catalog_validation(_Value);
             } else if (_Option == L"--output-dir") { // set the output directory
                 _Options_parser::_Parse_output_directory(_Value);
+            } else if (_Option == L"--settings-version") { // set the format of the settings file
+                _Options_parser::_Parse_settings_version(_Value);
+            } else if (_Option == L"--log-file") { // write the log to a file as well
+                _Options_parser::_Parse_log_file(_Value);
+            } else if (_Option == L"--log-level") { // set the lowest logged severity
+                _Options_parser::_Parse_log_level(_Value);
             } else if (_Option == L"--default-lcid") { // set the default LCID
                 _Options_parser::_Parse_lcid(_Value, _Options.default_lcid);
             } else if (_Option == L"--preferred-lcid") { // set the preferred LCID
@@ -173,6 +355,8 @@ namespace mjx {
             _Options.output_dir = ::mjx::current_path();
         }
 
-        _Check_lcids(); // check if all LCIDs are specified
+        if (_Has_settings_inputs()) { // check if all LCIDs are specified
+            _Check_lcids();
+        }
     }
 } // namespace mjx
\ No newline at end of file
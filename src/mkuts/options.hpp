@@ -12,12 +12,26 @@
 #include <mkuts/utils.hpp>
 
 namespace mjx {
+    struct catalog_directory { // directory scanned for catalogs once all options are parsed
+        path dir;
+        size_t position; // number of catalogs specified before the directory
+        bool recursive;
+    };
+
     class program_options {
     public:
         vector<path> catalogs;
+        vector<catalog_directory> catalog_dirs;
+        vector<path> embedded_catalogs;
+        vector<path> native_catalogs;
+        vector<path> reordered_catalogs;
+        path message_profile;
+        path bundle;
         path output_dir;
         uint32_t default_lcid;
         uint32_t preferred_lcid;
+        uint8_t settings_version; // on-disk version, 2 by default, 0 for runtimes without the indexed format
+        bool full_validation; // validate whole catalogs instead of just their headers
 
         ~program_options() noexcept;
 
@@ -31,20 +45,51 @@ namespace mjx {
         program_options() noexcept;
     };
     
-    bool _Is_catalog_included(const path& _Path) noexcept;
+    bool _Is_catalog_included(const path& _Path);
+    bool _Mark_catalog_included(const path& _Path);
     path _Absolute_path(const path& _Path);
     void _Check_lcids() noexcept;
 
+    // checks whether any option that affects the settings file was specified
+    bool _Has_settings_inputs() noexcept;
+
     struct _Options_parser {
         // parses '--catalog' option
         static void _Parse_catalog(const unicode_string_view _Value);
 
-        // parses '--catalog-dir' option
-        static void _Parse_catalog_directory(const unicode_string_view _Value);
+        // parses '--embed-catalog' option
+        static void _Parse_embedded_catalog(const unicode_string_view _Value);
+
+        // parses '--native-catalog' option
+        static void _Parse_native_catalog(const unicode_string_view _Value);
+
+        // parses '--reorder-catalog' option
+        static void _Parse_reordered_catalog(const unicode_string_view _Value);
+
+        // parses '--message-profile' option
+        static void _Parse_message_profile(const unicode_string_view _Value);
+
+        // parses '--bundle' option
+        static void _Parse_bundle(const unicode_string_view _Value);
+
+        // parses '--catalog-dir' or '--catalog-tree' option
+        static void _Parse_catalog_directory(const unicode_string_view _Value, const bool _Recursive);
+
+        // parses '--validate' option
+        static void _Parse_catalog_validation(const unicode_string_view _Value) noexcept;
 
         // parses '--output-dir' option
         static void _Parse_output_directory(const unicode_string_view _Value);
 
+        // parses '--settings-version' option
+        static void _Parse_settings_version(const unicode_string_view _Value) noexcept;
+
+        // parses '--log-file' option
+        static void _Parse_log_file(const unicode_string_view _Value);
+
+        // parses '--log-level' option
+        static void _Parse_log_level(const unicode_string_view _Value) noexcept;
+
         // parses '--default-lcid' or '--preferred-lcid' option
         static void _Parse_lcid(const unicode_string_view _Value, uint32_t& _Lcid) noexcept;
     };
@@ -0,0 +1,16 @@
+// parallel.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjsync/thread.hpp>
+#include <mkuts/parallel.hpp>
+
+namespace mjx {
+    thread_pool& _Worker_pool() {
+        // the calling thread takes part in every loop, so it counts as one of the workers
+        const size_t _Count = ::mjx::hardware_concurrency();
+        static thread_pool _Pool(_Count > 1 ? _Count - 1 : 1);
+        return _Pool;
+    }
+} // namespace mjx
\ No newline at end of file
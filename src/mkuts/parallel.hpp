@@ -0,0 +1,68 @@
+// parallel.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MKUTS_PARALLEL_HPP_
+#define _MKUTS_PARALLEL_HPP_
+#include <atomic>
+#include <cstddef>
+#include <mjsync/task.hpp>
+#include <mjsync/thread_pool.hpp>
+#include <mkuts/utils.hpp>
+#include <type_traits>
+
+namespace mjx {
+    // returns the worker pool, created on first use with one thread per logical processor minus one
+    thread_pool& _Worker_pool();
+
+    template <class _Fn>
+    struct _Parallel_loop {
+        _Fn& _Func;
+        const size_t _Count;
+        ::std::atomic<size_t> _Next;
+        ::std::atomic<bool> _Failed;
+
+        static void _Run(void* const _Arg) noexcept {
+            // claims indexes one by one until all of them are processed
+            _Parallel_loop& _Loop = *static_cast<_Parallel_loop*>(_Arg);
+            try {
+                for (size_t _Idx; (_Idx = _Loop._Next.fetch_add(1, ::std::memory_order_relaxed)) < _Loop._Count;) {
+                    _Loop._Func(_Idx);
+                }
+            } catch (...) { // stop claiming indexes, the caller reports the failure
+                _Loop._Failed.store(true, ::std::memory_order_relaxed);
+                _Loop._Next.store(_Loop._Count, ::std::memory_order_relaxed);
+            }
+        }
+    };
+
+    template <class _Fn>
+    inline bool _Parallel_for(const size_t _Count, _Fn&& _Func) {
+        // invokes _Func for every index in [0, _Count) on the worker pool, returns false if any call threw
+        using _Loop_t = _Parallel_loop<::std::remove_reference_t<_Fn>>;
+        _Loop_t _Loop{_Func, _Count, 0, false};
+        vector<task> _Tasks;
+        try {
+            thread_pool& _Pool    = _Worker_pool();
+            const size_t _Workers = _Pool.is_open() ? _Pool.thread_count() : 0;
+            for (size_t _Idx = 0; _Idx < _Workers && _Idx + 1 < _Count; ++_Idx) {
+                _Tasks.push_back(_Pool.schedule_task(&_Loop_t::_Run, &_Loop));
+            }
+        } catch (...) {
+            // the calling thread processes the remaining indexes on its own
+        }
+
+        // Note: The calling thread takes part in the loop as well, so the loop completes even if no task
+        //       could be scheduled. The tasks refer to _Loop, so they must be done before it goes away.
+        _Loop_t::_Run(&_Loop);
+        for (task& _Task : _Tasks) {
+            _Task.wait_until_done();
+        }
+
+        return !_Loop._Failed.load(::std::memory_order_relaxed);
+    }
+} // namespace mjx
+
+#endif // _MKUTS_PARALLEL_HPP_
\ No newline at end of file
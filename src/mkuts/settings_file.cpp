@@ -4,12 +4,17 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <mjfs/file.hpp>
-#include <mjfs/status.hpp>
-#include <mjmem/smart_pointer.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mkuts/build_cache.hpp>
+#include <mkuts/catalog_scan.hpp>
 #include <mkuts/logger.hpp>
 #include <mkuts/options.hpp>
+#include <mkuts/parallel.hpp>
 #include <mkuts/settings_file.hpp>
 #include <mkuts/tinywin.hpp>
+#include <umls/impl/trace.hpp>
+#include <umls/impl/translator.hpp>
+#include <xxhash/xxhash.h>
 
 namespace mjx {
     size_t _Unicode_to_utf8_required_buffer_size(const unicode_string_view _Str) noexcept {
@@ -29,48 +34,63 @@ namespace mjx {
     }
 
     bool _Uts_catalog_creator::_Get_associated_lcid(const path& _Target, uint32_t& _Lcid) {
-        file _File(_Target, file_access::read, file_share::read);
-        file_stream _Stream(_File);
-        if (!_Stream.is_open()) { // invalid stream, break
+        _Umc_header_info _Info;
+        if (!_Read_umc_header(_Target, _Info)) { // invalid or corrupted header, break
             return false;
         }
 
-        // Note: The LCID is the fourth component of the UMC header, immediately following
-        //       the variable-length language name. Thus, to access the LCID, we need to
-        //       determine the length of the language name first and skip over it.
-        uint64_t _Off = 4; // set offset to language name length component
-        if (!_Stream.seek(_Off)) {
+        _Lcid = _Info._Lcid;
+        return true;
+    }
+
+    bool _Uts_catalog_creator::_Create(const path& _Target, _Uts_catalog& _Catalog) {
+        const unicode_string _Name = _Target.filename().native();
+        const size_t _Cvt_size     = _Unicode_to_utf8_required_buffer_size(_Name);
+        if (_Cvt_size > _Uts_catalog_name_traits::_Max_name_length) { // catalog name is too long, break
             return false;
         }
 
-        uint8_t _Len;
-        if (!_Stream.read_exactly(&_Len, sizeof(uint8_t))) {
+        if (!_Unicode_to_utf8(_Name, _Catalog._Name, _Cvt_size)) { // conversion failed, break
             return false;
         }
+        
+        return _Get_associated_lcid(_Target, _Catalog._Lcid);
+    }
 
-        _Off += 1 + static_cast<uint64_t>(_Len); // set offset to the LCID component
-        if (!_Stream.seek(_Off)) {
+    bool _Uts_catalog_creator::_Create_indexed(const path& _Target, translator_catalog& _Catalog) {
+        file _File(_Target, file_access::read, file_share::read);
+        file_stream _Stream(_File);
+        if (!_Stream.is_open()) { // invalid stream, break
             return false;
         }
 
-        return _Stream.read_exactly(reinterpret_cast<byte_t*>(&_Lcid), sizeof(uint32_t));
-    }
+        // Note: The whole file is read, as the checksum covers all of it. The message count follows
+        //       the LCID, see _Read_umc_header() for the layout of the header.
+        const size_t _File_size = static_cast<size_t>(_File.size());
+        byte_string _Data(_File_size, byte_t{0});
+        if (!_Stream.read_exactly(_Data.data(), _File_size)) { // failed to read the file, break
+            return false;
+        }
 
-    bool _Uts_catalog_creator::_Create(const path& _Target, _Uts_catalog& _Catalog) {
-        const unicode_string _Name = _Target.filename().native();
-        const size_t _Cvt_size     = _Unicode_to_utf8_required_buffer_size(_Name);
-        if (_Cvt_size > _Uts_catalog_name_traits::_Max_name_length) { // catalog name is too long, break
+        if (_File_size < 5) { // truncated header
             return false;
         }
 
-        if (!_Unicode_to_utf8(_Name, _Catalog._Name, _Cvt_size)) { // conversion failed, break
+        const size_t _Len_off = _Data[3] == 0 ? 4 : 5; // offset of the language name length component
+        const size_t _Off     = _Len_off + 1 + static_cast<size_t>(_Data[_Len_off]); // offset of the LCID
+        if (_File_size < _Off + 2 * sizeof(uint32_t)) { // truncated header
             return false;
         }
-        
-        return _Get_associated_lcid(_Target, _Catalog._Lcid);
+
+        _Catalog.name = _Target.filename().native();
+        ::memcpy(&_Catalog.lcid, _Data.data() + _Off, sizeof(uint32_t));
+        ::memcpy(&_Catalog.message_count, _Data.data() + _Off + sizeof(uint32_t), sizeof(uint32_t));
+        _Catalog.size     = _File_size;
+        _Catalog.checksum = ::XXH3_64bits(_Data.data(), _File_size);
+        return true;
     }
 
-    _Uts_file_writer::_Uts_file_writer(file_stream& _Stream) noexcept : _Mystream(_Stream) {}
+    _Uts_file_writer::_Uts_file_writer(byte_string& _Buf) noexcept : _Mybuf(_Buf) {}
 
     _Uts_file_writer::~_Uts_file_writer() noexcept {}
 
@@ -84,75 +104,155 @@ namespace mjx {
         return _Count;
     }
 
-    bool _Uts_file_writer::_Write_signature() noexcept {
-        // write predefined 4-byte signature to the file
-        constexpr size_t _Signature_size             = 4;
-        constexpr byte_t _Signature[_Signature_size] = { 'U', 'T', 'S', '\0'};
-        return _Mystream.write(_Signature, _Signature_size);
+    bool _Uts_file_writer::_Write_signature(const uint8_t _Version) {
+        // write 4-byte signature to the file, the last byte is the format version
+        constexpr size_t _Signature_size         = 4;
+        const byte_t _Signature[_Signature_size] = {'U', 'T', 'S', _Version};
+        _Mybuf.append(_Signature, _Signature_size);
+        return true;
     }
 
-    bool _Uts_file_writer::_Write_lcids(const uint32_t _Default, const uint32_t _Preferred) noexcept {
+    bool _Uts_file_writer::_Write_lcids(const uint32_t _Default, const uint32_t _Preferred) {
         // write default and preferred LCIDs to the file
         constexpr size_t _Bytes_per_lcid = sizeof(uint32_t);
         constexpr size_t _Buf_size       = 2 * _Bytes_per_lcid; // must fit two LCIDs
         byte_t _Buf[_Buf_size];
         ::memcpy(_Buf, &_Default, _Bytes_per_lcid);
         ::memcpy(_Buf + _Bytes_per_lcid, &_Preferred, _Bytes_per_lcid);
-        return _Mystream.write(_Buf, _Buf_size);
+        _Mybuf.append(_Buf, _Buf_size);
+        return true;
     }
 
-    bool _Uts_file_writer::_Write_catalog_count(const size_t _Count) noexcept {
+    bool _Uts_file_writer::_Write_catalog_count(const size_t _Count) {
         // write a number of catalogs to the file, assumes that _Count is in range [0, 65535]
         constexpr size_t _Buf_size = 2;
         byte_t _Buf[_Buf_size];
         ::memcpy(_Buf, reinterpret_cast<const uint16_t*>(&_Count), _Buf_size); // copy as 2-byte integer
-        return _Mystream.write(_Buf, _Buf_size);
+        _Mybuf.append(_Buf, _Buf_size);
+        return true;
     }
 
     bool _Uts_file_writer::_Write_catalogs(const vector<_Uts_catalog>& _Catalogs) {
         constexpr size_t _Bytes_per_catalog = sizeof(_Uts_catalog);
-        const size_t _Buf_size              = _Catalogs.size() * _Bytes_per_catalog;
-        unique_smart_array<byte_t> _Buf     = ::mjx::make_unique_smart_array<byte_t>(_Buf_size);
-        for (size_t _Off = 0; const _Uts_catalog& _Catalog : _Catalogs) {
-            ::memcpy(_Buf.get() + _Off, reinterpret_cast<const byte_t*>(&_Catalog), _Bytes_per_catalog);
-            _Off += _Bytes_per_catalog;
+        _Mybuf.reserve(_Mybuf.size() + _Catalogs.size() * _Bytes_per_catalog);
+        for (const _Uts_catalog& _Catalog : _Catalogs) {
+            _Mybuf.append(reinterpret_cast<const byte_t*>(&_Catalog), _Bytes_per_catalog);
         }
 
-        return _Mystream.write(_Buf.get(), _Buf_size);
+        return true;
     }
 
-    bool _Make_uts_catalogs_from_umc(const vector<path>& _Umc_catalogs, vector<_Uts_catalog>& _Uts_catalogs) {
-        _Uts_catalogs.reserve(_Umc_catalogs.size());
-        _Uts_catalog _Uts_catalog;
-        for (const path& _Umc_catalog : _Umc_catalogs) {
-            if (!_Uts_catalog_creator::_Create(_Umc_catalog, _Uts_catalog)) { // creation failed, break
-                rtlog(L"Error: Failed to create a UTS catalog from '%s'.", _Umc_catalog.c_str());
+    bool _Uts_file_writer::_Write_indexed_catalogs(const translator_catalogs& _Catalogs) {
+        // write the indexed data and the lookup tables, the layout is defined in <umls/impl/uts_index.hpp>
+        byte_string _Tables;
+        uint32_t _Slot_count;
+        uint32_t _String_table_size;
+        if (!umls_impl::_Make_uts_tables(
+            _Catalogs.data(), _Catalogs.size(), _Tables, _Slot_count, _String_table_size)) {
+            return false;
+        }
+
+        constexpr size_t _Buf_size = 3 * sizeof(uint32_t) + sizeof(uint16_t);
+        const uint32_t _Count      = static_cast<uint32_t>(_Catalogs.size());
+        byte_t _Buf[_Buf_size]     = {0}; // the first 2 bytes are reserved
+        ::memcpy(_Buf + sizeof(uint16_t), &_Count, sizeof(uint32_t));
+        ::memcpy(_Buf + sizeof(uint16_t) + sizeof(uint32_t), &_Slot_count, sizeof(uint32_t));
+        ::memcpy(_Buf + sizeof(uint16_t) + 2 * sizeof(uint32_t), &_String_table_size, sizeof(uint32_t));
+        _Mybuf.append(_Buf, _Buf_size);
+        _Mybuf.append(_Tables);
+        return true;
+    }
+
+    bool _Report_failed_catalog(const vector<path>& _Umc_catalogs, const vector<uint8_t>& _Created) {
+        // reports the first catalog that could not be created, as the serial creation did
+        for (size_t _Idx = 0; _Idx < _Created.size(); ++_Idx) {
+            if (!_Created[_Idx]) { // creation failed, break
+                rtlog(L"Error: Failed to create a UTS catalog from '%s'.", _Umc_catalogs[_Idx].c_str());
                 return false;
             }
+        }
+
+        return true;
+    }
+
+    bool _Make_uts_catalogs_from_umc(const vector<path>& _Umc_catalogs, vector<_Uts_catalog>& _Uts_catalogs) {
+        _UMLS_TRACE_SPAN("_Make_uts_catalogs_from_umc");
+        const size_t _Count = _Umc_catalogs.size();
+        vector<uint8_t> _Created(_Count, 0);
+        _Uts_catalogs.resize(_Count);
+        const bool _Done = ::mjx::_Parallel_for(_Count, [&](const size_t _Idx) {
+            _Created[_Idx] = _Uts_catalog_creator::_Create(_Umc_catalogs[_Idx], _Uts_catalogs[_Idx]);
+        });
+        return _Done && _Report_failed_catalog(_Umc_catalogs, _Created);
+    }
 
-            _Uts_catalogs.push_back(::std::move(_Uts_catalog));
+    bool _Make_indexed_catalogs_from_umc(const vector<path>& _Umc_catalogs, translator_catalogs& _Catalogs) {
+        _UMLS_TRACE_SPAN("_Make_indexed_catalogs_from_umc");
+        const size_t _Count = _Umc_catalogs.size();
+        vector<uint8_t> _Created(_Count, 0);
+        _Catalogs.resize(_Count);
+        const bool _Done = ::mjx::_Parallel_for(_Count, [&](const size_t _Idx) {
+            _Created[_Idx] = _Uts_catalog_creator::_Create_indexed(_Umc_catalogs[_Idx], _Catalogs[_Idx]);
+        });
+        return _Done && _Report_failed_catalog(_Umc_catalogs, _Created);
+    }
+
+    bool _Write_indexed_settings_file(byte_string& _Data) {
+        // Note: Version 2 stores 0 in the 2-byte catalog count of version 1, the actual 4-byte count
+        //       follows it, so the number of catalogs is no longer limited to 65535.
+        const program_options& _Options = program_options::global();
+        translator_catalogs _Catalogs;
+        if (!_Make_indexed_catalogs_from_umc(_Options.catalogs, _Catalogs)) {
+            rtlog(L"Error: Failed to create UTS catalogs.");
+            return false;
+        }
+
+        _Uts_file_writer _Writer(_Data);
+        if (!_Writer._Write_signature(umls_impl::_Uts_indexed_version)) {
+            rtlog(L"Error: Failed to write the signature.");
+            return false;
+        }
+
+        if (!_Writer._Write_lcids(_Options.default_lcid, _Options.preferred_lcid)) {
+            rtlog(L"Error: Failed to write the LCIDs.");
+            return false;
+        }
+
+        if (!_Writer._Write_catalog_count(0)) {
+            rtlog(L"Error: Failed to write the number of catalogs.");
+            return false;
+        }
+
+        if (!_Writer._Write_indexed_catalogs(_Catalogs)) {
+            rtlog(L"Error: Failed to write the UTS catalogs.");
+            return false;
         }
 
         return true;
     }
 
-    void _Write_settings_file(file_stream& _Stream) {
+    bool _Write_settings_file(byte_string& _Data) {
+        _UMLS_TRACE_SPAN("_Write_settings_file");
         const program_options& _Options = program_options::global();
+        if (_Options.settings_version == umls_impl::_Uts_indexed_version) { // write the indexed format
+            return _Write_indexed_settings_file(_Data);
+        }
+
         vector<_Uts_catalog> _Catalogs;
         if (!_Make_uts_catalogs_from_umc(_Options.catalogs, _Catalogs)) {
             rtlog(L"Error: Failed to create UTS catalogs.");
-            return;
+            return false;
         }
 
-        _Uts_file_writer _Writer(_Stream);
-        if (!_Writer._Write_signature()) {
+        _Uts_file_writer _Writer(_Data);
+        if (!_Writer._Write_signature(umls_impl::_Uts_legacy_version)) {
             rtlog(L"Error: Failed to write the signature.");
-            return;
+            return false;
         }
         
         if (!_Writer._Write_lcids(_Options.default_lcid, _Options.preferred_lcid)) {
             rtlog(L"Error: Failed to write the LCIDs.");
-            return;
+            return false;
         }
 
         // Note: A number of catalogs is limited to 65535 due to the 2-byte section reserved for
@@ -167,54 +267,36 @@ namespace mjx {
 
         if (!_Writer._Write_catalog_count(_Count)) {
             rtlog(L"Error: Failed to write the number of catalogs.");
-            return;
+            return false;
         }
 
         if (_Count > 0) { // some catalogs specified, write them
             if (!_Writer._Write_catalogs(_Catalogs)) {
                 rtlog(L"Error: Failed to write the UTS catalogs.");
+                return false;
             }
         }
-    }
-
-    void _Create_settings_file(const path& _Target) {
-        file _File;
-        if (!::mjx::create_file(_Target, ::std::addressof(_File))) { // failed to create the file, break
-            rtlog(L"Error: Failed to create the settings file.");
-            return;
-        }
 
-        file_stream _Stream(_File);
-        if (!_Stream.is_open()) { // invalid stream, break
-            rtlog(L"Error: Failed to open the settings file.");
-            return;
-        }
-
-        _Write_settings_file(_Stream);
+        return true;
     }
 
-    void _Overwrite_settings_file(const path& _Target) {
-        file _File(_Target, file_access::write);
-        file_stream _Stream(_File);
-        if (!_Stream.is_open()) { // invalid stream, break
-            rtlog(L"Error: Failed to open the settings file.");
+    void create_or_overwrite_settings_file() {
+        _UMLS_TRACE_SPAN("create_or_overwrite_settings_file");
+        if (!_Has_settings_inputs()) { // no catalogs or LCIDs specified, leave the settings file as it is
             return;
         }
 
-        if (!_File.resize(0)) { // the file must be empty
-            rtlog(L"Error: Failed to clear the settings file.");
+        // Note: The settings are built in memory and the file is only written if they changed, so that
+        //       the runtimes that watch the file do not reload it needlessly. If the settings could not be
+        //       built, the previous file is left as it was.
+        byte_string _Data;
+        if (!_Write_settings_file(_Data)) { // the error has already been reported
             return;
         }
 
-        _Write_settings_file(_Stream);
-    }
-
-    void create_or_overwrite_settings_file() {
         const path& _Path = program_options::global().output_dir / L"settings.uts";
-        if (::mjx::exists(_Path)) { // file already exists, overwrite it
-            _Overwrite_settings_file(_Path);
-        } else { // file does not exist, create a new one
-            _Create_settings_file(_Path);
+        if (_Update_output_file(_Path, _Data) == _Output_update_result::_Failed) {
+            rtlog(L"Error: Failed to write the settings file.");
         }
     }
 } // namespace mjx
\ No newline at end of file
@@ -7,9 +7,9 @@
 #ifndef _MKUTS_SETTINGS_FILE_HPP_
 #define _MKUTS_SETTINGS_FILE_HPP_
 #include <cstdint>
-#include <mjfs/file_stream.hpp>
 #include <mjfs/path.hpp>
 #include <mkuts/utils.hpp>
+#include <umls/translator.hpp>
 
 namespace mjx {
     size_t _Unicode_to_utf8_required_buffer_size(const unicode_string_view _Str) noexcept;
@@ -29,6 +29,9 @@ namespace mjx {
     struct _Uts_catalog_creator {
         // creates a UTS catalog from the UMC one
         static bool _Create(const path& _Target, _Uts_catalog& _Catalog);
+
+        // creates a version 2 UTS catalog, along with its metadata, from the UMC one
+        static bool _Create_indexed(const path& _Target, translator_catalog& _Catalog);
     
     private:
         // reads the associated LCID
@@ -37,7 +40,7 @@ namespace mjx {
 
     class _Uts_file_writer {
     public:
-        explicit _Uts_file_writer(file_stream& _Stream) noexcept;
+        explicit _Uts_file_writer(byte_string& _Buf) noexcept;
         ~_Uts_file_writer() noexcept;
 
         _Uts_file_writer()                                   = delete;
@@ -47,26 +50,30 @@ namespace mjx {
         // returns the number of catalogs within valid range
         static size_t _Checked_catalog_count(size_t _Count) noexcept;
 
-        // writes the signature to the UTS file
-        bool _Write_signature() noexcept;
+        // writes the signature with the given version byte to the UTS file
+        bool _Write_signature(const uint8_t _Version);
 
         // writes LCIDs to the UTS file
-        bool _Write_lcids(const uint32_t _Default, const uint32_t _Preferred) noexcept;
+        bool _Write_lcids(const uint32_t _Default, const uint32_t _Preferred);
 
         // writes a number of catalogs to the UTS file
-        bool _Write_catalog_count(const size_t _Count) noexcept;
+        bool _Write_catalog_count(const size_t _Count);
 
         // writes catalogs to the UTS file
         bool _Write_catalogs(const vector<_Uts_catalog>& _Catalogs);
+
+        // writes catalogs and their lookup tables to the version 2 UTS file
+        bool _Write_indexed_catalogs(const translator_catalogs& _Catalogs);
         
     private:
-        file_stream& _Mystream;
+        byte_string& _Mybuf;
     };
 
+    bool _Report_failed_catalog(const vector<path>& _Umc_catalogs, const vector<uint8_t>& _Created);
     bool _Make_uts_catalogs_from_umc(const vector<path>& _Umc_catalogs, vector<_Uts_catalog>& _Uts_catalogs);
-    void _Write_settings_file(file_stream& _Stream);
-    void _Create_settings_file(const path& _Target);
-    void _Overwrite_settings_file(const path& _Target);
+    bool _Make_indexed_catalogs_from_umc(const vector<path>& _Umc_catalogs, translator_catalogs& _Catalogs);
+    bool _Write_indexed_settings_file(byte_string& _Data);
+    bool _Write_settings_file(byte_string& _Data);
 
     void create_or_overwrite_settings_file();
 } // namespace mjx
@@ -0,0 +1,105 @@
+// allocation_counter.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <umls/allocation_counter.hpp>
+
+namespace mjx {
+    allocation_counter::allocation_counter(allocator& _Al) noexcept
+        : _Myal(_Al), _Myallocs(0), _Mydeallocs(0), _Myallocated(0), _Mydeallocated(0) {}
+
+    allocation_counter::~allocation_counter() noexcept {}
+
+    allocation_counter::pointer allocation_counter::allocate(const size_type _Count) {
+        pointer _Ptr = _Myal.allocate(_Count);
+        _Myallocs.fetch_add(1, ::std::memory_order_relaxed);
+        _Myallocated.fetch_add(_Count, ::std::memory_order_relaxed);
+        return _Ptr;
+    }
+
+    allocation_counter::pointer allocation_counter::allocate_aligned(const size_type _Count, const size_type _Align) {
+        pointer _Ptr = _Myal.allocate_aligned(_Count, _Align);
+        _Myallocs.fetch_add(1, ::std::memory_order_relaxed);
+        _Myallocated.fetch_add(_Count, ::std::memory_order_relaxed);
+        return _Ptr;
+    }
+
+    void allocation_counter::deallocate(pointer _Ptr, const size_type _Count) noexcept {
+        _Myal.deallocate(_Ptr, _Count);
+        _Mydeallocs.fetch_add(1, ::std::memory_order_relaxed);
+        _Mydeallocated.fetch_add(_Count, ::std::memory_order_relaxed);
+    }
+
+    allocation_counter::size_type allocation_counter::max_size() const noexcept {
+        return _Myal.max_size();
+    }
+
+    bool allocation_counter::is_equal(const allocator& _Other) const noexcept {
+        // memory is owned by the wrapped allocator, so it can be released by either of them
+        return this == &_Other || _Myal.is_equal(_Other);
+    }
+
+    allocator& allocation_counter::upstream() const noexcept {
+        return _Myal;
+    }
+
+    allocation_statistics allocation_counter::statistics() const noexcept {
+        return allocation_statistics{_Myallocs.load(::std::memory_order_relaxed),
+            _Mydeallocs.load(::std::memory_order_relaxed), _Myallocated.load(::std::memory_order_relaxed),
+                _Mydeallocated.load(::std::memory_order_relaxed)};
+    }
+
+    void allocation_counter::reset() noexcept {
+        _Myallocs.store(0, ::std::memory_order_relaxed);
+        _Mydeallocs.store(0, ::std::memory_order_relaxed);
+        _Myallocated.store(0, ::std::memory_order_relaxed);
+        _Mydeallocated.store(0, ::std::memory_order_relaxed);
+    }
+
+    namespace umls_impl {
+        class _Global_allocator_proxy : public allocator { // forwards every request to the current global allocator
+        public:
+            pointer allocate(const size_type _Count) override {
+                return ::mjx::get_allocator().allocate(_Count);
+            }
+
+            pointer allocate_aligned(const size_type _Count, const size_type _Align) override {
+                return ::mjx::get_allocator().allocate_aligned(_Count, _Align);
+            }
+
+            void deallocate(pointer _Ptr, const size_type _Count) noexcept override {
+                ::mjx::get_allocator().deallocate(_Ptr, _Count);
+            }
+
+            size_type max_size() const noexcept override {
+                return ::mjx::get_allocator().max_size();
+            }
+
+            bool is_equal(const allocator& _Other) const noexcept override {
+                return this == &_Other || ::mjx::get_allocator().is_equal(_Other);
+            }
+        };
+    } // namespace umls_impl
+
+    allocation_scope::allocation_scope() noexcept : _Mycounter(::mjx::get_allocator()) {
+        ::mjx::set_allocator(_Mycounter);
+    }
+
+    allocation_scope::~allocation_scope() noexcept {
+        ::mjx::set_allocator(_Mycounter.upstream());
+    }
+
+    allocation_statistics allocation_scope::statistics() const noexcept {
+        return _Mycounter.statistics();
+    }
+
+    void allocation_scope::reset() noexcept {
+        _Mycounter.reset();
+    }
+
+    allocator& persistent_allocator() noexcept {
+        static umls_impl::_Global_allocator_proxy _Proxy;
+        return _Proxy;
+    }
+} // namespace mjx
\ No newline at end of file
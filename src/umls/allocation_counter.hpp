@@ -0,0 +1,102 @@
+// allocation_counter.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_ALLOCATION_COUNTER_HPP_
+#define _UMLS_ALLOCATION_COUNTER_HPP_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mjmem/allocator.hpp>
+#include <umls/api.hpp>
+
+namespace mjx {
+    struct allocation_statistics {
+        uint64_t allocations       = 0;
+        uint64_t deallocations     = 0;
+        uint64_t allocated_bytes   = 0;
+        uint64_t deallocated_bytes = 0;
+    };
+
+    class _UMLS_API allocation_counter : public allocator { // counts requests forwarded to another allocator
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+
+        explicit allocation_counter(allocator& _Al) noexcept;
+        ~allocation_counter() noexcept override;
+
+        allocation_counter()                                     = delete;
+        allocation_counter(const allocation_counter&)            = delete;
+        allocation_counter& operator=(const allocation_counter&) = delete;
+
+        // allocates uninitialized storage
+        pointer allocate(const size_type _Count) override;
+
+        // allocates uninitialized storage with the specifed alignment
+        pointer allocate_aligned(const size_type _Count, const size_type _Align) override;
+
+        // deallocates storage
+        void deallocate(pointer _Ptr, const size_type _Count) noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+        // returns the wrapped allocator
+        allocator& upstream() const noexcept;
+
+        // returns the counted requests
+        allocation_statistics statistics() const noexcept;
+
+        // resets the counters
+        void reset() noexcept;
+
+    private:
+        allocator& _Myal;
+#pragma warning(suppress : 4251) // C4251: std::atomic needs to have dll-interface
+        ::std::atomic<uint64_t> _Myallocs;
+#pragma warning(suppress : 4251) // C4251: std::atomic needs to have dll-interface
+        ::std::atomic<uint64_t> _Mydeallocs;
+#pragma warning(suppress : 4251) // C4251: std::atomic needs to have dll-interface
+        ::std::atomic<uint64_t> _Myallocated;
+#pragma warning(suppress : 4251) // C4251: std::atomic needs to have dll-interface
+        ::std::atomic<uint64_t> _Mydeallocated;
+    };
+
+    class _UMLS_API allocation_scope { // counts all allocations made through the global allocator in a scope
+    public:
+        allocation_scope() noexcept;
+        ~allocation_scope() noexcept;
+
+        allocation_scope(const allocation_scope&)            = delete;
+        allocation_scope& operator=(const allocation_scope&) = delete;
+
+        // returns the requests counted since the scope was entered or reset
+        allocation_statistics statistics() const noexcept;
+
+        // resets the counters
+        void reset() noexcept;
+
+    private:
+        // Note: The counter forwards every request to the previously installed allocator,
+        //       so memory allocated inside the scope can be safely released outside of it.
+        //       Requests from all threads are counted while the scope is active.
+        allocation_counter _Mycounter;
+    };
+
+    // Note: The persistent allocator forwards every request to the global allocator that is installed
+    //       at the time of the request, as object_allocator does. Objects that keep a reference to their
+    //       allocator and may outlive an allocation_scope should use it, as the scope's counter is destroyed
+    //       with the scope. Requests made while a scope is active are still counted by that scope.
+    //       The persistent allocator itself must never be installed as the global allocator.
+    _UMLS_API allocator& persistent_allocator() noexcept;
+} // namespace mjx
+
+#endif // _UMLS_ALLOCATION_COUNTER_HPP_
\ No newline at end of file
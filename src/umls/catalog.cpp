@@ -6,16 +6,68 @@
 #include <type_traits>
 #include <umls/catalog.hpp>
 #include <umls/impl/catalog.hpp>
+#include <umls/impl/prefetch.hpp>
+#include <umls/impl/profile.hpp>
+#include <umls/impl/statistics.hpp>
 #include <umls/impl/utils.hpp>
 
 namespace mjx {
+    namespace umls_impl {
+        struct _Found_message { // blob that holds a message and the location of the message within it
+            const _Umc_blob* _Blob = nullptr;
+            _Message_range _Range;
+
+            bool _Valid() const noexcept {
+                return _Blob != nullptr;
+            }
+        };
+
+        _Found_message _Lookup_message(
+            const _Message_catalog& _Catalog, const utf8_string_view _Id, _Lookup_recorder& _Recorder) noexcept {
+            // looks up the message through the whole chain, records its hash and profiles the access
+            const uint64_t _Hash = _Hash_message_id(_Id);
+            _Recorder._Set_hash(_Hash);
+            const _Message_location _Location = _Catalog._Find_message(_Hash, _Id);
+            if (!_Location._Found()) { // message not found, break
+                return _Found_message{};
+            }
+
+            _Profile_message_access(_Hash);
+            return _Found_message{_Location._Blob, _Entry_range(_Location._Entry)};
+        }
+
+        bool _Fetch_utf8_message(const _Found_message& _Found, _Scratch_buffer<wchar_t>& _Wide,
+            utf8_string& _Converted, utf8_string_view& _Msg) {
+            // refers to the stored message, or converts it to UTF-8 if the catalog stores wide text
+            const _Message_range& _Range = _Found._Range;
+            if (_Found._Blob->_Is_utf8()) {
+                return _Found._Blob->_Fetch_utf8_message(_Msg, _Range._Offset, _Range._Length);
+            }
+
+            if (!_Found._Blob->_Fetch_message(_Wide, _Range._Offset, _Range._Length)) { // failed to fetch, break
+                return false;
+            }
+
+            _Converted = ::mjx::to_utf8_string(_Wide._View());
+            _Msg       = _Converted;
+            return true;
+        }
+    } // namespace umls_impl
+
     message_catalog::message_catalog() noexcept : _Myimpl(nullptr) {}
 
     message_catalog::message_catalog(message_catalog&& _Other) noexcept
         : _Myimpl(_Other._Myimpl.release()) {}
 
-    message_catalog::message_catalog(const path& _Target)
-        : _Myimpl(::mjx::create_object<umls_impl::_Message_catalog>(_Target)) {}
+    message_catalog::message_catalog(const path& _Target, const catalog_load_mode _Mode, allocator& _Al)
+        : _Myimpl(::mjx::create_object<umls_impl::_Message_catalog>(_Target, _Mode, _Al)) {}
+
+    message_catalog::message_catalog(
+        const byte_string_view _Buffer, const catalog_buffer_mode _Mode, allocator& _Al)
+        : _Myimpl(::mjx::create_object<umls_impl::_Message_catalog>(_Buffer, _Mode, _Al)) {}
+
+    message_catalog::message_catalog(const static_catalog& _Catalog, allocator& _Al)
+        : _Myimpl(::mjx::create_object<umls_impl::_Message_catalog>(_Catalog, _Al)) {}
 
     message_catalog::~message_catalog() noexcept {
         close();
@@ -39,12 +91,30 @@ namespace mjx {
         }
     }
 
-    bool message_catalog::open(const path& _Target) {
+    bool message_catalog::open(const path& _Target, const catalog_load_mode _Mode, allocator& _Al) {
         if (is_open()) { // some catalog is already open, break
             return false;
         }
 
-        _Myimpl.reset(::mjx::create_object<umls_impl::_Message_catalog>(_Target));
+        _Myimpl.reset(::mjx::create_object<umls_impl::_Message_catalog>(_Target, _Mode, _Al));
+        return _Myimpl->_Valid();
+    }
+
+    bool message_catalog::open(const byte_string_view _Buffer, const catalog_buffer_mode _Mode, allocator& _Al) {
+        if (is_open()) { // some catalog is already open, break
+            return false;
+        }
+
+        _Myimpl.reset(::mjx::create_object<umls_impl::_Message_catalog>(_Buffer, _Mode, _Al));
+        return _Myimpl->_Valid();
+    }
+
+    bool message_catalog::open(const static_catalog& _Catalog, allocator& _Al) {
+        if (is_open()) { // some catalog is already open, break
+            return false;
+        }
+
+        _Myimpl.reset(::mjx::create_object<umls_impl::_Message_catalog>(_Catalog, _Al));
         return _Myimpl->_Valid();
     }
 
@@ -61,12 +131,133 @@ namespace mjx {
         return is_open() ? _Myimpl->_Lcid : 0;
     }
 
+    bool message_catalog::has_overlay() const noexcept {
+        return is_open() && _Myimpl->_Overlay != nullptr;
+    }
+
+    bool message_catalog::attach_overlay(message_catalog&& _Overlay) {
+        if (!is_open() || !_Overlay.is_open()) { // both catalogs must be open, break
+            return false;
+        }
+
+        if (_Overlay.lcid() != _Myimpl->_Lcid) { // overlay targets a different language, break
+            return false;
+        }
+
+        // Note: The overlay replaces any previously attached one. The base catalog's data is neither
+        //       copied nor merged, lookups simply check the overlay's table before the base one.
+        _Myimpl->_Overlay.reset(_Overlay._Myimpl.release());
+        return true;
+    }
+
+    void message_catalog::detach_overlay() noexcept {
+        if (is_open()) {
+            _Myimpl->_Overlay.reset();
+        }
+    }
+
+    size_t message_catalog::fallback_count() const noexcept {
+        return is_open() ? _Myimpl->_Fallbacks.size() : 0;
+    }
+
+    bool message_catalog::attach_fallback(message_catalog&& _Fallback) {
+        if (!is_open() || !_Fallback.is_open()) { // both catalogs must be open, break
+            return false;
+        }
+
+        // Note: Fallbacks are consulted in the order they were attached. Instead of searching each
+        //       of them on a miss, a merged index is built here, which maps every message hash
+        //       to the first catalog in the chain that contains it.
+        _Myimpl->_Attach_fallback(::std::move(_Fallback._Myimpl));
+        return true;
+    }
+
+    void message_catalog::detach_fallbacks() noexcept {
+        if (is_open()) {
+            _Myimpl->_Detach_fallbacks();
+        }
+    }
+
+    catalog_memory_usage message_catalog::memory_usage() const noexcept {
+        catalog_memory_usage _Usage;
+        if (is_open()) {
+            _Myimpl->_Accumulate_memory_usage(_Usage);
+        }
+
+        return _Usage;
+    }
+
+    bool message_catalog::has_message_ids() const noexcept {
+        return is_open() && _Myimpl->_Ids._Valid();
+    }
+
+    bool message_catalog::strict_lookup() const noexcept {
+        return is_open() && _Myimpl->_Strict.load(::std::memory_order_relaxed);
+    }
+
+    void message_catalog::strict_lookup(const bool _Enable) noexcept {
+        if (is_open()) {
+            _Myimpl->_Strict.store(_Enable, ::std::memory_order_relaxed);
+        }
+    }
+
+    message_id_list message_catalog::message_ids(const utf8_string_view _Prefix) const {
+        message_id_list _Ids;
+        if (!has_message_ids()) { // no IDs to enumerate, break
+            return _Ids;
+        }
+
+        // the section is sorted by the ID bytes, so the IDs that share the prefix are adjacent
+        const umls_impl::_Umc_id_section& _Section = _Myimpl->_Ids;
+        for (size_t _Idx = _Section._Lower_bound(_Prefix); _Idx < _Section._Size(); ++_Idx) {
+            const utf8_string_view _Id = _Section._At(_Idx)._Id;
+            if (!umls_impl::_Has_id_prefix(_Id, _Prefix)) { // past the last matching ID, break
+                break;
+            }
+
+            _Ids.push_back(_Id);
+        }
+
+        return _Ids;
+    }
+
     bool message_catalog::has_message(const utf8_string_view _Id) const noexcept {
         if (!is_open()) { // invalid catalog, break
             return false;
         }
 
-        return _Myimpl->_Table._Find_message(umls_impl::_Hash_message_id(_Id)) != nullptr;
+        return _Myimpl->_Find_message(umls_impl::_Hash_message_id(_Id), _Id)._Found();
+    }
+
+    size_t message_catalog::warm_up(const utf8_string_view* const _Ids, const size_t _Count) const noexcept {
+        if (!is_open()) { // invalid catalog, break
+            return 0;
+        }
+
+        // Note: Looking up the message touches its table entry (or the merged index entry), then
+        //       the prefetcher pages in the message text and pulls it into the cache.
+        umls_impl::_Memory_prefetcher _Prefetcher;
+        size_t _Found = 0;
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            const umls_impl::_Message_location _Location =
+                _Myimpl->_Find_message(umls_impl::_Hash_message_id(_Ids[_Idx]));
+            if (!_Location._Found()) { // message not found, skip it
+                continue;
+            }
+
+            const umls_impl::_Message_range _Range = umls_impl::_Entry_range(_Location._Entry);
+            const byte_t* const _Data = _Location._Blob->_Message_data(_Range._Offset, _Range._Length);
+            if (_Data) {
+                _Prefetcher._Add(_Data, _Range._Length);
+                ++_Found;
+            }
+        }
+
+        return _Found;
+    }
+
+    size_t message_catalog::warm_up(const ::std::initializer_list<utf8_string_view> _Ids) const noexcept {
+        return warm_up(_Ids.begin(), _Ids.size());
     }
 
     message_catalog::message_retrieval_result message_catalog::get_message(
@@ -74,25 +265,17 @@ namespace mjx {
         if (!is_open()) { // invalid catalog, break
             return message_retrieval_result{unicode_string{}, false};
         }
-        
-        const auto* const _Entry = _Myimpl->_Table._Find_message(umls_impl::_Hash_message_id(_Id));
-        if (!_Entry) { // message not found, break
-            return message_retrieval_result{unicode_string{}, false};
-        }
 
-#ifdef _M_X64
-        const size_t _Len = static_cast<size_t>(_Entry->_Length);
-        const size_t _Off = _Entry->_Offset;
-#else // ^^^ _M_X64 ^^^ / vvv _M_IX86 vvv
-        const size_t _Len = _Entry->_Length;
-        const size_t _Off = static_cast<size_t>(_Entry->_Offset);
-#endif // _M_X64
+        umls_impl::_Lookup_recorder _Recorder(_Id);
+        const umls_impl::_Found_message _Found = umls_impl::_Lookup_message(*_Myimpl, _Id, _Recorder);
         unicode_string _Msg;
-        if (!_Myimpl->_Blob._Fetch_message(_Msg, _Off, _Len)) { // failed to fetch the message, break
-            return message_retrieval_result{unicode_string{}, false};
+        if (!_Found._Valid() || !_Found._Blob->_Fetch_message(_Msg, _Found._Range._Offset, _Found._Range._Length)) {
+            return message_retrieval_result{unicode_string{}, false}; // message not found or not fetched
         }
 
-        if (::mjx::is_formattable(_Msg)) { // formattable message, try to format it
+        const bool _Formattable = ::mjx::is_formattable(_Msg);
+        _Recorder._Hit(_Found._Range._Length, _Formattable);
+        if (_Formattable) { // formattable message, try to format it
             // Note: For a message to be formattable, it must contain at least one format specifier
             //       and be non-empty. An empty formatted message typically indicates that something
             //       went wrong during formatting. By checking for an empty message, we can detect
@@ -104,4 +287,121 @@ namespace mjx {
             return message_retrieval_result{::std::move(_Msg), true};
         }
     }
+
+    message_catalog::utf8_message_retrieval_result message_catalog::get_utf8_message(
+        const utf8_string_view _Id, const utf8_format_args& _Args) const {
+        if (!is_open()) { // invalid catalog, break
+            return utf8_message_retrieval_result{utf8_string{}, false};
+        }
+
+        umls_impl::_Lookup_recorder _Recorder(_Id);
+        const umls_impl::_Found_message _Found = umls_impl::_Lookup_message(*_Myimpl, _Id, _Recorder);
+        umls_impl::_Scratch_buffer<wchar_t> _Wide(::mjx::get_allocator());
+        utf8_string _Wide_msg; // holds the converted message if the catalog stores wide text
+        utf8_string_view _Msg;
+        if (!_Found._Valid() || !umls_impl::_Fetch_utf8_message(_Found, _Wide, _Wide_msg, _Msg)) {
+            return utf8_message_retrieval_result{utf8_string{}, false}; // message not found or not fetched
+        }
+
+        const bool _Formattable = ::mjx::is_formattable(_Msg);
+        _Recorder._Hit(_Found._Blob->_Is_utf8() ? 0 : _Found._Range._Length, _Formattable); // UTF-8 is not transcoded
+        if (_Formattable) { // formattable message, format it straight from the blob
+            utf8_string _Str      = ::mjx::format_string(_Msg, _Args);
+            const bool _Not_empty = !_Str.empty();
+            return utf8_message_retrieval_result{::std::move(_Str), _Not_empty};
+        } else { // not formattable message, copy it as is
+            return utf8_message_retrieval_result{
+                _Found._Blob->_Is_utf8() ? utf8_string{_Msg} : ::std::move(_Wide_msg), true};
+        }
+    }
+
+    message_catalog::message_view_retrieval_result message_catalog::get_message(
+        const utf8_string_view _Id, const format_args& _Args, format_arena& _Arena) const {
+        if (!is_open()) { // invalid catalog, break
+            return message_view_retrieval_result{unicode_string_view{}, false};
+        }
+
+        umls_impl::_Lookup_recorder _Recorder(_Id);
+        const umls_impl::_Found_message _Found = umls_impl::_Lookup_message(*_Myimpl, _Id, _Recorder);
+        umls_impl::_Scratch_buffer<wchar_t> _Buf(_Arena);
+        if (!_Found._Valid() || !_Found._Blob->_Fetch_message(_Buf, _Found._Range._Offset, _Found._Range._Length)) {
+            return message_view_retrieval_result{unicode_string_view{}, false}; // message not found or not fetched
+        }
+
+        const unicode_string_view _Msg = _Buf._View();
+        const bool _Formattable        = ::mjx::is_formattable(_Msg);
+        _Recorder._Hit(_Found._Range._Length, _Formattable);
+        if (_Formattable) { // formattable message, format it in the arena
+            const unicode_string_view _Str = umls_impl::_Format_in_arena(_Arena, _Msg, _Args);
+            return message_view_retrieval_result{_Str, !_Str.empty()};
+        } else { // not formattable message, the decoded message already lives in the arena
+            return message_view_retrieval_result{_Buf._Detach(), true};
+        }
+    }
+
+    message_catalog::utf8_message_view_retrieval_result message_catalog::get_utf8_message(
+        const utf8_string_view _Id, const utf8_format_args& _Args, format_arena& _Arena) const {
+        if (!is_open()) { // invalid catalog, break
+            return utf8_message_view_retrieval_result{utf8_string_view{}, false};
+        }
+
+        umls_impl::_Lookup_recorder _Recorder(_Id);
+        const umls_impl::_Found_message _Found = umls_impl::_Lookup_message(*_Myimpl, _Id, _Recorder);
+        umls_impl::_Scratch_buffer<wchar_t> _Wide(_Arena);
+        utf8_string _Wide_msg; // holds the converted message if the catalog stores wide text
+        utf8_string_view _Msg;
+        if (!_Found._Valid() || !umls_impl::_Fetch_utf8_message(_Found, _Wide, _Wide_msg, _Msg)) {
+            return utf8_message_view_retrieval_result{utf8_string_view{}, false}; // message not found or not fetched
+        }
+
+        const bool _Formattable = ::mjx::is_formattable(_Msg);
+        _Recorder._Hit(_Found._Blob->_Is_utf8() ? 0 : _Found._Range._Length, _Formattable); // UTF-8 is not transcoded
+        if (_Formattable) { // formattable message, format it in the arena
+            const utf8_string_view _Str = umls_impl::_Format_in_arena(_Arena, _Msg, _Args);
+            return utf8_message_view_retrieval_result{_Str, !_Str.empty()};
+        } else { // not formattable message, copy it into the arena, so that it does not refer to the catalog
+            return utf8_message_view_retrieval_result{umls_impl::_Copy_to_arena(_Arena, _Msg), true};
+        }
+    }
+
+    message_catalog::namespace_retrieval_result message_catalog::get_namespace(
+        const utf8_string_view _Prefix) const {
+        namespace_retrieval_result _Result;
+        const message_id_list& _Ids = message_ids(_Prefix);
+        if (_Ids.empty()) { // nothing to retrieve, break
+            return _Result;
+        }
+
+        // Note: The messages are looked up through the whole chain, so the overlay still takes
+        //       precedence. The stored size of a message is never less than its decoded length,
+        //       therefore reserving it up front leaves the buffer allocated only once.
+        ::std::vector<umls_impl::_Message_location, object_allocator<umls_impl::_Message_location>> _Locations;
+        _Locations.reserve(_Ids.size());
+        size_t _Capacity = 0;
+        for (const utf8_string_view _Id : _Ids) {
+            const umls_impl::_Message_location _Location = _Myimpl->_Find_message(umls_impl::_Hash_message_id(_Id));
+            _Locations.push_back(_Location);
+            if (_Location._Found()) {
+                _Capacity += umls_impl::_Entry_range(_Location._Entry)._Length;
+            }
+        }
+
+        _Result.text.reserve(_Capacity);
+        _Result.messages.reserve(_Ids.size());
+        unicode_string _Msg;
+        for (size_t _Idx = 0; _Idx < _Ids.size(); ++_Idx) {
+            const umls_impl::_Message_location& _Location = _Locations[_Idx];
+            if (!_Location._Found()) { // the message ID was found, but the message was not, skip it
+                continue;
+            }
+
+            const umls_impl::_Message_range _Range = umls_impl::_Entry_range(_Location._Entry);
+            if (_Location._Blob->_Fetch_message(_Msg, _Range._Offset, _Range._Length)) {
+                _Result.messages.push_back(namespace_message{_Ids[_Idx], _Result.text.size(), _Msg.size()});
+                _Result.text.append(_Msg.data(), _Msg.size());
+            }
+        }
+
+        return _Result;
+    }
 } // namespace mjx
\ No newline at end of file
@@ -6,25 +6,86 @@
 #pragma once
 #ifndef _UMLS_CATALOG_HPP_
 #define _UMLS_CATALOG_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <mjfs/path.hpp>
+#include <mjmem/allocator.hpp>
+#include <mjmem/object_allocator.hpp>
 #include <mjmem/smart_pointer.hpp>
 #include <mjstr/string.hpp>
 #include <mjstr/string_view.hpp>
+#include <umls/allocation_counter.hpp>
 #include <umls/api.hpp>
 #include <umls/format.hpp>
+#include <umls/format_arena.hpp>
+#include <vector>
 
 namespace mjx {
     namespace umls_impl {
         class _Message_catalog;
     } // namespace umls_impl
 
+    enum class catalog_load_mode : unsigned char {
+        read, // read the catalog into memory
+        map // map the catalog file and refer to the mapped data
+    };
+
+    enum class catalog_buffer_mode : unsigned char {
+        copy, // copy the buffer data into the catalog
+        borrow // refer to the buffer data, the buffer must outlive the catalog
+    };
+
+#pragma pack(push)
+#pragma pack(4) // must match the layout of the UMC table entry
+    struct static_catalog_entry {
+        uint64_t hash;
+        uint64_t offset;
+        uint32_t length;
+    };
+#pragma pack(pop)
+
+    // Note: The blob is not validated at runtime, it must hold valid UTF-8 text, as mkuts ensures.
+    struct static_catalog { // catalog data embedded into the executable, must have static storage duration
+        const wchar_t* language;
+        uint32_t lcid;
+        const static_catalog_entry* entries; // sorted by hash
+        size_t entry_count;
+        const byte_t* blob;
+        size_t blob_size;
+    };
+
+    struct catalog_memory_usage { // memory used by a catalog, including its overlay and fallbacks
+        // bytes used by each part of the catalog, regardless of where it is stored
+        size_t table_bytes    = 0;
+        size_t blob_bytes     = 0;
+        size_t id_bytes       = 0; // optional section with the original message IDs
+        size_t language_bytes = 0;
+        size_t index_bytes    = 0; // merged index and bookkeeping of the attached catalogs
+
+        // bytes by storage
+        size_t heap_bytes     = 0; // allocated and owned by the catalog
+        size_t mapped_bytes   = 0; // mapped file views, shared with other processes that map the same file
+        size_t borrowed_bytes = 0; // caller-owned buffers and static catalogs
+    };
+
+    using message_id_list = ::std::vector<utf8_string_view, object_allocator<utf8_string_view>>;
+
     class _UMLS_API message_catalog { // stores translated messages
     public:
         message_catalog() noexcept;
         message_catalog(message_catalog&& _Other) noexcept;
         ~message_catalog() noexcept;
 
-        explicit message_catalog(const path& _Target);
+        // Note: The loaded data and the indexes are allocated from _Al, which must outlive the catalog.
+        //       The persistent allocator is the default, so the catalog may outlive an allocation_scope.
+        //       The language name and retrieved messages are strings, which use the global allocator.
+        explicit message_catalog(const path& _Target, const catalog_load_mode _Mode = catalog_load_mode::read,
+            allocator& _Al = ::mjx::persistent_allocator());
+        explicit message_catalog(const byte_string_view _Buffer,
+            const catalog_buffer_mode _Mode = catalog_buffer_mode::copy,
+            allocator& _Al = ::mjx::persistent_allocator());
+        explicit message_catalog(const static_catalog& _Catalog, allocator& _Al = ::mjx::persistent_allocator());
 
         message_catalog& operator=(message_catalog&& _Other) noexcept;
 
@@ -38,7 +99,11 @@ namespace mjx {
         void close() noexcept;
 
         // opens a catalog
-        bool open(const path& _Target);
+        bool open(const path& _Target, const catalog_load_mode _Mode = catalog_load_mode::read,
+            allocator& _Al = ::mjx::persistent_allocator());
+        bool open(const byte_string_view _Buffer, const catalog_buffer_mode _Mode = catalog_buffer_mode::copy,
+            allocator& _Al = ::mjx::persistent_allocator());
+        bool open(const static_catalog& _Catalog, allocator& _Al = ::mjx::persistent_allocator());
 
         // returns the language name associated with the catalog
         const unicode_string& language() const noexcept;
@@ -46,6 +111,40 @@ namespace mjx {
         // returns the LCID associated with the catalog
         uint32_t lcid() const noexcept;
 
+        // checks whether the catalog has an overlay
+        bool has_overlay() const noexcept;
+
+        // attaches an overlay, its messages take precedence over the catalog's own messages
+        bool attach_overlay(message_catalog&& _Overlay);
+
+        // detaches the overlay
+        void detach_overlay() noexcept;
+
+        // returns the number of fallbacks
+        size_t fallback_count() const noexcept;
+
+        // attaches a fallback, it is consulted for messages that are missing in the catalog
+        bool attach_fallback(message_catalog&& _Fallback);
+
+        // detaches all fallbacks
+        void detach_fallbacks() noexcept;
+
+        // returns the memory used by the catalog
+        catalog_memory_usage memory_usage() const noexcept;
+
+        // checks whether the catalog stores the original message IDs
+        bool has_message_ids() const noexcept;
+
+        // returns or changes whether lookups verify the original IDs to reject hash collisions,
+        // applies to the currently open catalog and only to the catalogs that store the IDs,
+        // may be changed while other threads look messages up
+        bool strict_lookup() const noexcept;
+        void strict_lookup(const bool _Enable) noexcept;
+
+        // returns the IDs of the catalog's own messages that start with the given prefix, in byte order,
+        // the IDs refer to the catalog's data
+        message_id_list message_ids(const utf8_string_view _Prefix = utf8_string_view{}) const;
+
         // checks whether the catalog has a message
         bool has_message(const utf8_string_view _Id) const noexcept;
 
@@ -54,10 +153,60 @@ namespace mjx {
             bool retrieved;
         };
 
+        // pre-touches the table entries and text of the given messages, returns the number of messages found
+        size_t warm_up(const utf8_string_view* const _Ids, const size_t _Count) const noexcept;
+        size_t warm_up(const ::std::initializer_list<utf8_string_view> _Ids) const noexcept;
+
         // retrieves a message from the catalog
         message_retrieval_result get_message(
             const utf8_string_view _Id, const format_args& _Args = format_args{}) const;
 
+        struct utf8_message_retrieval_result {
+            utf8_string message;
+            bool retrieved;
+        };
+
+        // retrieves a message from the catalog in its stored UTF-8 form, without decoding it
+        utf8_message_retrieval_result get_utf8_message(
+            const utf8_string_view _Id, const utf8_format_args& _Args = utf8_format_args{}) const;
+
+        struct message_view_retrieval_result {
+            unicode_string_view message; // refers to the arena
+            bool retrieved;
+        };
+
+        struct utf8_message_view_retrieval_result {
+            utf8_string_view message; // refers to the arena
+            bool retrieved;
+        };
+
+        // same as above, but the message and all temporary buffers are allocated by _Arena,
+        // the returned message is valid until the arena is released
+        message_view_retrieval_result get_message(
+            const utf8_string_view _Id, const format_args& _Args, format_arena& _Arena) const;
+        utf8_message_view_retrieval_result get_utf8_message(
+            const utf8_string_view _Id, const utf8_format_args& _Args, format_arena& _Arena) const;
+
+        struct namespace_message {
+            utf8_string_view id; // refers to the catalog's data
+            size_t offset; // offset of the message in namespace_retrieval_result::text
+            size_t length;
+        };
+
+        struct namespace_retrieval_result {
+            unicode_string text; // all messages, stored one after another
+            ::std::vector<namespace_message, object_allocator<namespace_message>> messages;
+
+            // returns the message at the given index
+            unicode_string_view message(const size_t _Idx) const noexcept {
+                return unicode_string_view{text.data() + messages[_Idx].offset, messages[_Idx].length};
+            }
+        };
+
+        // retrieves every message whose ID starts with the given prefix into a single buffer,
+        // the messages are not formatted
+        namespace_retrieval_result get_namespace(const utf8_string_view _Prefix) const;
+
     private:
 #pragma warning(suppress : 4251) // C4251: unique_smart_ptr needs to have dll-interface
         unique_smart_ptr<umls_impl::_Message_catalog> _Myimpl;
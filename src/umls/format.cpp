@@ -6,8 +6,11 @@
 #include <mjmem/exception.hpp>
 #include <umls/format.hpp>
 #include <umls/impl/format.hpp>
+#include <umls/impl/trace.hpp>
 
 namespace mjx {
+    format_args::format_args(allocator& _Al) noexcept : _Myargs(_Alloc{_Al}) {}
+
     size_t format_args::count() const noexcept {
         return _Myargs.size();
     }
@@ -28,29 +31,34 @@ namespace mjx {
         _Myargs.push_back(_Arg);
     }
 
-    bool is_formattable(const unicode_string_view _Fmt) noexcept {
-        // search for at least one valid format specifier
-        if (_Fmt.empty()) { // definitely not formattable
-            return false;
-        }
+    utf8_format_args::utf8_format_args(allocator& _Al) noexcept : _Myargs(_Alloc{_Al}) {}
 
-        using _Traits              = char_traits<wchar_t>;
-        const wchar_t* _First      = _Fmt.data();
-        const wchar_t* const _Last = _First + _Fmt.size();
-        size_t _Off;
-        while (_First < _Last) {
-            _Off = _Traits::find(_First, _Last - _First, L"{%", 2);
-            if (_Off == umls_impl::_Spec_not_found) { // definitely no format specifiers
-                break;
-            }
-
-            _First += _Off + 2; // skip '{%'
-            if (umls_impl::_Is_valid_format_spec(_First, _Last)) { // valid format specifier found
-                return true;
-            }
+    size_t utf8_format_args::count() const noexcept {
+        return _Myargs.size();
+    }
+
+    utf8_string_view utf8_format_args::get(const size_t _Idx) const {
+        if (_Idx >= _Myargs.size()) {
+            resource_overrun::raise();
         }
 
-        return false; // not formattable
+        return _Myargs[_Idx];
+    }
+
+    void utf8_format_args::reserve(const size_t _New_capacity) {
+        _Myargs.reserve(_New_capacity);
+    }
+
+    void utf8_format_args::append(const utf8_string_view _Arg) {
+        _Myargs.push_back(_Arg);
+    }
+
+    bool is_formattable(const unicode_string_view _Fmt) noexcept {
+        return umls_impl::_Is_formattable(_Fmt);
+    }
+
+    bool is_formattable(const utf8_string_view _Fmt) noexcept {
+        return umls_impl::_Is_formattable(_Fmt);
     }
 
     unicode_string format_string(const unicode_string_view _Fmt, const format_args& _Args) {
@@ -58,28 +66,37 @@ namespace mjx {
             return unicode_string{};
         }
 
-        unicode_string _Str;
-        _Str.reserve(umls_impl::_Estimate_formatted_string_length(_Fmt.size(), _Args));
-        const wchar_t* _First      = _Fmt.data();
-        const wchar_t* const _Last = _First + _Fmt.size();
-        umls_impl::_Fmt_spec _Spec;
-        for (;;) {
-            _Spec = umls_impl::_Find_format_spec(_First, _Last);
-            if (!_Spec._Found()) { // no more format specifiers, append the rest of the string and break
-                _Str.append(_First, _Last - _First);
-                break;
-            }
-
-            if (_Spec._Idx >= _Args.count()) { // requested argument not provided, break
-                return unicode_string{};
-            }
-
-            _Str.append(_First, _Spec._Off); // append the substring that is before the format specifier
-            _Str.append(_Args.get(_Spec._Idx)); // append the requested argument
-            _First += _Spec._Off + _Spec._Len; // skip the format specifier
+        _UMLS_TRACE_SPAN("format_string");
+        return umls_impl::_Format_string(_Fmt, _Args);
+    }
+
+    utf8_string format_string(const utf8_string_view _Fmt, const utf8_format_args& _Args) {
+        // Note: UTF-8 arguments are copied byte for byte, format specifiers are plain ASCII,
+        //       so the message is formatted without being decoded.
+        if (_Fmt.empty()) { // no formatting
+            return utf8_string{};
+        }
+
+        _UMLS_TRACE_SPAN("format_string");
+        return umls_impl::_Format_string(_Fmt, _Args);
+    }
+
+    unicode_string_view format_string(
+        const unicode_string_view _Fmt, const format_args& _Args, format_arena& _Arena) {
+        if (_Fmt.empty()) { // no formatting
+            return unicode_string_view{};
+        }
+
+        _UMLS_TRACE_SPAN("format_string");
+        return umls_impl::_Format_in_arena(_Arena, _Fmt, _Args);
+    }
+
+    utf8_string_view format_string(const utf8_string_view _Fmt, const utf8_format_args& _Args, format_arena& _Arena) {
+        if (_Fmt.empty()) { // no formatting
+            return utf8_string_view{};
         }
 
-        _Str.shrink_to_fit(); // free unused memory
-        return ::std::move(_Str);
+        _UMLS_TRACE_SPAN("format_string");
+        return umls_impl::_Format_in_arena(_Arena, _Fmt, _Args);
     }
 } // namespace mjx
\ No newline at end of file
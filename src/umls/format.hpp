@@ -6,11 +6,13 @@
 #pragma once
 #ifndef _UMLS_FORMAT_HPP_
 #define _UMLS_FORMAT_HPP_
-#include <mjmem/object_allocator.hpp>
+#include <mjmem/allocator.hpp>
 #include <mjstr/string.hpp>
 #include <mjstr/string_view.hpp>
 #include <type_traits>
 #include <umls/api.hpp>
+#include <umls/format_arena.hpp>
+#include <umls/instance_allocator.hpp>
 #include <vector>
 
 namespace mjx {
@@ -21,6 +23,8 @@ namespace mjx {
         format_args(format_args&&) noexcept = default;
         ~format_args() noexcept             = default;
 
+        explicit format_args(allocator& _Al) noexcept;
+
         format_args& operator=(const format_args&)     = default;
         format_args& operator=(format_args&&) noexcept = default;
 
@@ -37,9 +41,41 @@ namespace mjx {
         void append(const unicode_string_view _Arg);
 
     private:
-        using _Alloc  = object_allocator<unicode_string_view>;
+        using _Alloc  = instance_allocator<unicode_string_view>;
         using _Vector = ::std::vector<unicode_string_view, _Alloc>;
     
+#pragma warning(suppress : 4251) // C4251: std::vector needs to have dll-interface
+        _Vector _Myargs;
+    };
+
+    class _UMLS_API utf8_format_args { // provides access to all UTF-8 formatting arguments
+    public:
+        utf8_format_args() noexcept                   = default;
+        utf8_format_args(const utf8_format_args&)     = default;
+        utf8_format_args(utf8_format_args&&) noexcept = default;
+        ~utf8_format_args() noexcept                  = default;
+
+        explicit utf8_format_args(allocator& _Al) noexcept;
+
+        utf8_format_args& operator=(const utf8_format_args&)     = default;
+        utf8_format_args& operator=(utf8_format_args&&) noexcept = default;
+
+        // returns the number of arguments
+        size_t count() const noexcept;
+
+        // returns the specified argument
+        utf8_string_view get(const size_t _Idx) const;
+
+        // reserves storage for future arguments
+        void reserve(const size_t _New_capacity);
+
+        // appends a new argument
+        void append(const utf8_string_view _Arg);
+
+    private:
+        using _Alloc  = instance_allocator<utf8_string_view>;
+        using _Vector = ::std::vector<utf8_string_view, _Alloc>;
+
 #pragma warning(suppress : 4251) // C4251: std::vector needs to have dll-interface
         _Vector _Myargs;
     };
@@ -54,8 +90,46 @@ namespace mjx {
         return _Args;
     }
 
+    template <class... _Types>
+    format_args make_format_args_using_allocator(allocator& _Al, _Types&&... _Vals) {
+        static_assert(::std::conjunction_v<::std::is_constructible<unicode_string_view, _Types>...>,
+            "All types must be convertible to unicode_string_view");
+        format_args _Args(_Al);
+        _Args.reserve(sizeof...(_Types)); // reserve space for arguments
+        (_Args.append(::std::forward<_Types>(_Vals)), ...);
+        return _Args;
+    }
+
+    template <class... _Types>
+    utf8_format_args make_utf8_format_args(_Types&&... _Vals) {
+        static_assert(::std::conjunction_v<::std::is_constructible<utf8_string_view, _Types>...>,
+            "All types must be convertible to utf8_string_view");
+        utf8_format_args _Args;
+        _Args.reserve(sizeof...(_Types)); // reserve space for arguments
+        (_Args.append(::std::forward<_Types>(_Vals)), ...);
+        return _Args;
+    }
+
+    template <class... _Types>
+    utf8_format_args make_utf8_format_args_using_allocator(allocator& _Al, _Types&&... _Vals) {
+        static_assert(::std::conjunction_v<::std::is_constructible<utf8_string_view, _Types>...>,
+            "All types must be convertible to utf8_string_view");
+        utf8_format_args _Args(_Al);
+        _Args.reserve(sizeof...(_Types)); // reserve space for arguments
+        (_Args.append(::std::forward<_Types>(_Vals)), ...);
+        return _Args;
+    }
+
     _UMLS_API bool is_formattable(const unicode_string_view _Fmt) noexcept;
+    _UMLS_API bool is_formattable(const utf8_string_view _Fmt) noexcept;
     _UMLS_API unicode_string format_string(const unicode_string_view _Fmt, const format_args& _Args);
+    _UMLS_API utf8_string format_string(const utf8_string_view _Fmt, const utf8_format_args& _Args);
+
+    // formats the message in _Arena, the result refers to the arena and is valid until the arena is released
+    _UMLS_API unicode_string_view format_string(
+        const unicode_string_view _Fmt, const format_args& _Args, format_arena& _Arena);
+    _UMLS_API utf8_string_view format_string(
+        const utf8_string_view _Fmt, const utf8_format_args& _Args, format_arena& _Arena);
 } // namespace mjx
 
 #endif // _UMLS_FORMAT_HPP_
\ No newline at end of file
@@ -0,0 +1,47 @@
+// format_arena.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstddef>
+#include <umls/format_arena.hpp>
+#include <umls/impl/format_arena.hpp>
+
+namespace mjx {
+    format_arena::format_arena(const size_t _Block_size, allocator& _Upstream)
+        : _Myimpl(::mjx::make_unique_smart_ptr<umls_impl::_Format_arena_impl>(_Upstream, _Block_size)) {}
+
+    format_arena::~format_arena() noexcept {}
+
+    format_arena::pointer format_arena::allocate(const size_type _Count) {
+        return _Myimpl->_Allocate(_Count, alignof(::std::max_align_t));
+    }
+
+    format_arena::pointer format_arena::allocate_aligned(const size_type _Count, const size_type _Align) {
+        return _Myimpl->_Allocate(_Count, _Align);
+    }
+
+    void format_arena::deallocate(pointer, const size_type) noexcept {
+        // storage is reclaimed by release() or when the arena is destroyed
+    }
+
+    format_arena::size_type format_arena::max_size() const noexcept {
+        return static_cast<size_type>(-1);
+    }
+
+    bool format_arena::is_equal(const allocator& _Other) const noexcept {
+        return this == &_Other;
+    }
+
+    size_t format_arena::used() const noexcept {
+        return _Myimpl->_Used();
+    }
+
+    size_t format_arena::reserved() const noexcept {
+        return _Myimpl->_Reserved();
+    }
+
+    void format_arena::release() noexcept {
+        _Myimpl->_Release();
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,72 @@
+// format_arena.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_FORMAT_ARENA_HPP_
+#define _UMLS_FORMAT_ARENA_HPP_
+#include <cstddef>
+#include <mjmem/allocator.hpp>
+#include <mjmem/smart_pointer.hpp>
+#include <umls/allocation_counter.hpp>
+#include <umls/api.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        class _Format_arena_impl;
+    } // namespace umls_impl
+
+    class _UMLS_API format_arena : public allocator { // bump-allocates temporary buffers used while formatting
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+
+        static constexpr size_t default_block_size = 64 * 1024;
+
+        // Note: The arena is passed explicitly to format_string(), message_catalog::get_message()
+        //       and translator::get_message(). The returned messages and the buffers used while decoding
+        //       and formatting them are bump-allocated from the arena, the messages are views that stay valid
+        //       until release() reclaims them all at once. The arena is never installed as the global
+        //       allocator and is not thread-safe, each thread should use its own. Its blocks come from
+        //       _Upstream, the persistent allocator by default, so the arena may outlive an allocation_scope.
+        explicit format_arena(
+            const size_t _Block_size = default_block_size, allocator& _Upstream = ::mjx::persistent_allocator());
+        ~format_arena() noexcept override;
+
+        format_arena(const format_arena&)            = delete;
+        format_arena& operator=(const format_arena&) = delete;
+
+        // allocates uninitialized storage from the current block
+        pointer allocate(const size_type _Count) override;
+
+        // allocates uninitialized storage with the specifed alignment from the current block
+        pointer allocate_aligned(const size_type _Count, const size_type _Align) override;
+
+        // does nothing, the storage is reclaimed by release()
+        void deallocate(pointer _Ptr, const size_type _Count) noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+        // returns the number of bytes handed out since the last release
+        size_t used() const noexcept;
+
+        // returns the number of bytes reserved from the upstream allocator
+        size_t reserved() const noexcept;
+
+        // reclaims all storage handed out by the arena
+        void release() noexcept;
+
+    private:
+#pragma warning(suppress : 4251) // C4251: unique_smart_ptr needs to have dll-interface
+        unique_smart_ptr<umls_impl::_Format_arena_impl> _Myimpl;
+    };
+} // namespace mjx
+
+#endif // _UMLS_FORMAT_ARENA_HPP_
\ No newline at end of file
@@ -0,0 +1,120 @@
+// bundle.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_BUNDLE_HPP_
+#define _UMLS_IMPL_BUNDLE_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjfs/file.hpp>
+#include <mjfs/path.hpp>
+#include <mjstr/char_traits.hpp>
+#include <mjstr/conversion.hpp>
+#include <mjstr/string_view.hpp>
+#include <umls/impl/catalog.hpp>
+#include <umls/impl/mapped_file.hpp>
+#include <umls/impl/translator.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        inline constexpr byte_t _Umb_signature[_Uts_signature_size] = {'U', 'M', 'B', '\0'};
+        inline constexpr byte_t _Upf_signature[_Uts_signature_size] = {'U', 'P', 'F', '\0'};
+        inline constexpr size_t _Upf_file_size                      = _Uts_signature_size + sizeof(uint32_t);
+
+        inline const path& _Get_bundle_file_path() {
+            // concatenate the current path with the bundle file name to obtain its absolute path
+            static const path& _Path = ::mjx::current_path() / L"locale.umb";
+            return _Path;
+        }
+
+        inline const path& _Get_preferences_file_path() {
+            // Note: The bundle is deployed read-only and may be mapped by other processes, so the preferred
+            //       LCID chosen by the user is stored next to it, in a file that holds the signature and the LCID.
+            static const path& _Path = ::mjx::current_path() / L"preferences.upf";
+            return _Path;
+        }
+
+        class _Catalog_bundle { // read-only view of a bundle that packs the settings and every catalog
+        public:
+            // Note: The bundle starts with the same 14-byte header as 'settings.uts', with its own signature.
+            //       The header is followed by the index, which holds the 64-byte UTF-8 name, 4-byte LCID,
+            //       8-byte offset and 8-byte size of each catalog. The catalogs follow the index, each one
+            //       placed so that its lookup table starts at a 16-byte boundary and can be borrowed.
+            //       Catalogs are looked up by name through the settings index, which is built once.
+            static constexpr size_t _Name_size  = 64;
+            static constexpr size_t _Entry_size = _Name_size + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+            _Catalog_bundle() noexcept : _Mymapping(), _Mydata{}, _Myindex(nullptr) {}
+
+            ~_Catalog_bundle() noexcept {}
+
+            _Catalog_bundle(const _Catalog_bundle&)            = delete;
+            _Catalog_bundle& operator=(const _Catalog_bundle&) = delete;
+
+            bool _Open(const path& _Target) noexcept {
+                file _File(_Target, file_access::read, file_share::read);
+                if (!_File.is_open() || !_Mymapping._Map(_File)) { // failed to map the bundle, break
+                    return false;
+                }
+
+                using _Traits             = char_traits<byte_t>;
+                const byte_t* const _Data = _Mymapping._Data();
+                const size_t _Size        = _Mymapping._Size();
+                if (_Size < sizeof(_Uts_static_data) || !_Traits::eq(_Data, _Umb_signature, _Uts_signature_size)) {
+                    _Mymapping._Unmap();
+                    return false;
+                }
+
+                ::memcpy(&_Mydata, _Data, sizeof(_Uts_static_data));
+                _Myindex = _Data + sizeof(_Uts_static_data);
+                if (static_cast<size_t>(_Mydata._Catalog_count) * _Entry_size > _Size - sizeof(_Uts_static_data)) {
+                    _Mymapping._Unmap(); // truncated index
+                    return false;
+                }
+
+                return true;
+            }
+
+            const _Uts_static_data& _Static_data() const noexcept {
+                return _Mydata;
+            }
+
+            size_t _Catalog_count() const noexcept {
+                return _Mydata._Catalog_count;
+            }
+
+            translator_catalog _Catalog_at(const size_t _Idx) const {
+                // the name is null-terminated unless it fills the whole space
+                const byte_t* const _Entry = _Myindex + _Idx * _Entry_size;
+                const void* const _Null    = ::memchr(_Entry, '\0', _Name_size);
+                const size_t _Name_length  =
+                    _Null ? static_cast<size_t>(static_cast<const byte_t*>(_Null) - _Entry) : _Name_size;
+                return translator_catalog{
+                    ::mjx::to_unicode_string(byte_string_view{_Entry, _Name_length}),
+                    _Load_integer<uint32_t>(_Entry + _Name_size)
+                };
+            }
+
+            byte_string_view _Catalog_data(const size_t _Idx) const noexcept {
+                // returns the UMC image of the catalog, or an empty view if it exceeds the bundle
+                const byte_t* const _Entry = _Myindex + _Idx * _Entry_size;
+                const uint64_t _Off        = _Load_integer<uint64_t>(_Entry + _Name_size + sizeof(uint32_t));
+                const uint64_t _Size       = _Load_integer<uint64_t>(_Entry + _Name_size + sizeof(uint32_t) + 8);
+                if (_Off > _Mymapping._Size() || _Size > _Mymapping._Size() - _Off) {
+                    return byte_string_view{};
+                }
+
+                return byte_string_view{_Mymapping._Data() + _Off, static_cast<size_t>(_Size)};
+            }
+
+        private:
+            _Mapped_file _Mymapping;
+            _Uts_static_data _Mydata;
+            const byte_t* _Myindex;
+        };
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_BUNDLE_HPP_
\ No newline at end of file
@@ -6,13 +6,22 @@
 #pragma once
 #ifndef _UMLS_IMPL_CATALOG_HPP_
 #define _UMLS_IMPL_CATALOG_HPP_
+#include <algorithm>
+#include <atomic>
 #include <mjfs/file.hpp>
 #include <mjfs/file_stream.hpp>
 #include <mjmem/object_allocator.hpp>
 #include <mjmem/smart_pointer.hpp>
 #include <mjstr/conversion.hpp>
 #include <mjstr/string.hpp>
+#include <umls/catalog.hpp>
+#include <umls/impl/format.hpp>
+#include <umls/impl/mapped_file.hpp>
+#include <umls/impl/trace.hpp>
+#include <umls/impl/transcode.hpp>
 #include <umls/impl/utils.hpp>
+#include <umls/instance_allocator.hpp>
+#include <vector>
 #include <xxhash/xxhash.h>
 
 namespace mjx {
@@ -21,6 +30,28 @@ namespace mjx {
             return ::XXH3_64bits(_Id.data(), _Id.size());
         }
 
+        enum class _Umc_text_encoding : uint8_t { // encoding of the messages blob
+            _Utf8  = 0,
+            _Utf16 = 1, // little-endian, matches wchar_t on Windows
+            _Utf32 = 2 // little-endian
+        };
+
+        // Note: The last byte of the UMC signature is the format version. Version 0 stores UTF-8 text,
+        //       version 1 adds a 1-byte text encoding immediately following the signature.
+        inline constexpr uint8_t _Umc_latest_version = 1;
+
+        constexpr bool _Is_native_text_encoding(const _Umc_text_encoding _Encoding) noexcept {
+            // checks whether the text can be copied straight into wchar_t strings
+            switch (_Encoding) {
+            case _Umc_text_encoding::_Utf16:
+                return sizeof(wchar_t) == 2;
+            case _Umc_text_encoding::_Utf32:
+                return sizeof(wchar_t) == 4;
+            default:
+                return false;
+            }
+        }
+
         template <class _Integer>
         inline _Integer _Load_integer(const byte_t* const _Bytes) noexcept {
             // assumes that _Bytes is at least sizeof(_Integer) bytes long
@@ -29,9 +60,95 @@ namespace mjx {
             return _Value;
         }
 
-        class _Umc_blob { // stores UMC messages blob
+        class _Catalog_arena { // owns a single block that holds the copied sections of a catalog
         public:
-            _Umc_blob() noexcept : _Mydata(nullptr), _Mysize(0) {}
+            // Note: The block holds the lookup table, the blob and the ID section, in the order in which they
+            //       are stored. It is allocated once the table size is known, as _Table_size bytes for the table
+            //       and _Data_size bytes for everything that follows it in the source. The blob size is known
+            //       only once the table has been read, so _Split_data() divides the data into the blob and
+            //       the ID section, which takes the rest. A borrowed catalog copies only a misaligned table.
+            explicit _Catalog_arena(allocator& _Al) noexcept
+                : _Myal(_Al), _Mydata(nullptr), _Mysize(0), _Mytable_size(0), _Myblob_size(0) {}
+
+            ~_Catalog_arena() noexcept {
+                _Release();
+            }
+
+            _Catalog_arena()                                 = delete;
+            _Catalog_arena(const _Catalog_arena&)            = delete;
+            _Catalog_arena& operator=(const _Catalog_arena&) = delete;
+
+            bool _Valid() const noexcept {
+                return _Mydata != nullptr;
+            }
+
+            size_t _Size() const noexcept {
+                return _Mysize;
+            }
+
+            byte_t* _Data() const noexcept {
+                return _Mydata;
+            }
+
+            bool _Contains(const void* const _Ptr) const noexcept {
+                const byte_t* const _Bytes = static_cast<const byte_t*>(_Ptr);
+                return _Bytes >= _Mydata && _Bytes < _Mydata + _Mysize;
+            }
+
+            byte_t* _Allocate(const size_t _Table_size, const size_t _Data_size) {
+                // Note: mjmem allocators return blocks aligned for any fundamental type, so the lookup
+                //       table can be placed at the beginning of the block.
+                _Release(); // release the existing block
+                _Mydata       = ::mjx::allocate_object_array_using_allocator<byte_t>(_Table_size + _Data_size, _Myal);
+                _Mysize       = _Table_size + _Data_size;
+                _Mytable_size = _Table_size;
+                return _Mydata;
+            }
+
+            bool _Split_data(const size_t _Blob_size) noexcept {
+                // places the blob right after the table, fails if it does not fit in the allocated data
+                if (_Blob_size > _Mysize - _Mytable_size) {
+                    return false;
+                }
+
+                _Myblob_size = _Blob_size;
+                return true;
+            }
+
+            byte_t* _Blob_data() const noexcept {
+                return _Mydata + _Mytable_size;
+            }
+
+            byte_t* _Id_section_data() const noexcept {
+                return _Mydata + _Mytable_size + _Myblob_size;
+            }
+
+            size_t _Id_section_size() const noexcept {
+                return _Mysize - _Mytable_size - _Myblob_size;
+            }
+
+            void _Release() noexcept {
+                if (_Mydata) {
+                    ::mjx::delete_object_array_using_allocator(_Mydata, _Mysize, _Myal);
+                    _Mydata       = nullptr;
+                    _Mysize       = 0;
+                    _Mytable_size = 0;
+                    _Myblob_size  = 0;
+                }
+            }
+
+        private:
+            allocator& _Myal;
+            byte_t* _Mydata;
+            size_t _Mysize;
+            size_t _Mytable_size;
+            size_t _Myblob_size;
+        };
+
+        class _Umc_blob { // stores a view of UMC messages blob
+        public:
+            _Umc_blob() noexcept
+                : _Mydata(nullptr), _Mysize(0), _Myvalidated(false), _Myencoding(_Umc_text_encoding::_Utf8) {}
 
             ~_Umc_blob() noexcept {
                 _Destroy();
@@ -48,12 +165,17 @@ namespace mjx {
                 return _Mysize;
             }
 
-            byte_t* _Data() noexcept {
+            const byte_t* _Data() const noexcept {
                 return _Mydata;
             }
 
-            const byte_t* _Data() const noexcept {
-                return _Mydata;
+            bool _Is_utf8() const noexcept {
+                return _Myencoding == _Umc_text_encoding::_Utf8;
+            }
+
+            const byte_t* _Message_data(const size_t _Off, const size_t _Size) const noexcept {
+                // returns the stored message without decoding it, or null if it exceeds the blob
+                return _Off + _Size <= _Mysize ? _Mydata + _Off : nullptr;
             }
 
             bool _Fetch_message(unicode_string& _Str, const size_t _Off, const size_t _Size) const noexcept {
@@ -61,28 +183,81 @@ namespace mjx {
                     return false;
                 }
 
+                if (_Myencoding != _Umc_text_encoding::_Utf8) { // native-width text, copy it as is
+                    if (_Size % sizeof(wchar_t) != 0) { // partial character, break
+                        return false;
+                    }
+
+                    // the blob does not have to be aligned for wchar_t, so copy it byte by byte
+                    _Str.resize(_Size / sizeof(wchar_t));
+                    ::memcpy(_Str.data(), _Mydata + _Off, _Size);
+                    return true;
+                }
+
                 // messages are stored in UTF-8 encoding, therefore we must decode them to Unicode before use
-                _Str = ::mjx::to_unicode_string(byte_string_view{_Mydata + _Off, _Size});
+                return _Transcode_utf8_to_unicode(_Str, _Mydata + _Off, _Size, _Myvalidated);
+            }
+
+            bool _Fetch_message(_Scratch_buffer<wchar_t>& _Buf, const size_t _Off, const size_t _Size) const {
+                // same as above, but decodes the message into the caller's scratch buffer
+                if (_Off + _Size > _Mysize) { // message exceeds the blob, break
+                    return false;
+                }
+
+                if (_Myencoding != _Umc_text_encoding::_Utf8) { // native-width text, copy it as is
+                    if (_Size % sizeof(wchar_t) != 0) { // partial character, break
+                        return false;
+                    }
+
+                    _Buf._Reserve(_Size / sizeof(wchar_t));
+                    ::memcpy(_Buf._Data(), _Mydata + _Off, _Size);
+                    _Buf._Resize(_Size / sizeof(wchar_t));
+                    return true;
+                }
+
+                // each code unit is produced by at least one byte, so _Size is enough to hold the message
+                _Buf._Reserve(_Size);
+                const size_t _Count = _Myvalidated ? _Transcode_utf8<true>(_Mydata + _Off, _Size, _Buf._Data())
+                                                   : _Transcode_utf8<false>(_Mydata + _Off, _Size, _Buf._Data());
+                if (_Count == _Invalid_utf8) { // malformed text, break
+                    return false;
+                }
+
+                _Buf._Resize(_Count);
                 return true;
             }
 
-            void _Destroy() noexcept {
-                if (_Valid()) {
-                    ::mjx::delete_object_array(_Mydata, _Mysize);
-                    _Mydata = nullptr;
-                    _Mysize = 0;
+            bool _Fetch_utf8_message(utf8_string_view& _Str, const size_t _Off, const size_t _Size) const noexcept {
+                if (_Myencoding != _Umc_text_encoding::_Utf8 || _Off + _Size > _Mysize) { // not a UTF-8 message
+                    return false;
                 }
+
+                // refer to the stored message, no decoding is needed
+                _Str = utf8_string_view{reinterpret_cast<const char*>(_Mydata + _Off), _Size};
+                return true;
             }
 
-            void _Resize(const size_t _New_size) {
-                _Destroy(); // destroy the existing blob
-                _Mydata = ::mjx::allocate_object_array<byte_t>(_New_size);
-                _Mysize = _New_size;
+            void _Destroy() noexcept {
+                _Mydata      = nullptr;
+                _Mysize      = 0;
+                _Myvalidated = false;
+                _Myencoding  = _Umc_text_encoding::_Utf8;
+            }
+
+            void _Assign_view(const byte_t* const _Data, const size_t _Size, const bool _Validated = false,
+                const _Umc_text_encoding _Encoding = _Umc_text_encoding::_Utf8) noexcept {
+                // refer to the external data, which must outlive the blob
+                _Mydata      = _Data;
+                _Mysize      = _Size;
+                _Myvalidated = _Validated;
+                _Myencoding  = _Encoding;
             }
 
         private:
-            byte_t* _Mydata;
+            const byte_t* _Mydata;
             size_t _Mysize;
+            bool _Myvalidated; // true if the whole blob is known to be valid UTF-8
+            _Umc_text_encoding _Myencoding;
         };
 
         class _Umc_lookup_table { // stores UMC lookup table
@@ -97,11 +272,12 @@ namespace mjx {
             };
 #pragma pack(pop)
 
-            _Umc_lookup_table() noexcept : _Myentries(nullptr), _Mysize(0), _Myoff(0) {}
+            static_assert(sizeof(_Table_entry) == sizeof(static_catalog_entry),
+                "_Table_entry must have the same layout as static_catalog_entry");
 
-            ~_Umc_lookup_table() noexcept {
-                _Destroy();
-            }
+            _Umc_lookup_table() noexcept : _Myentries(nullptr), _Mysize(0), _Mysorted(false) {}
+
+            ~_Umc_lookup_table() noexcept {}
 
             _Umc_lookup_table(const _Umc_lookup_table&)            = delete;
             _Umc_lookup_table& operator=(const _Umc_lookup_table&) = delete;
@@ -110,6 +286,10 @@ namespace mjx {
                 return _Mysize;
             }
 
+            const _Table_entry* _Data() const noexcept {
+                return _Myentries;
+            }
+
             const _Table_entry* _At(const size_t _Idx) const noexcept {
 #ifdef _DEBUG
                 _INTERNAL_ASSERT(_Idx < _Mysize, "attempt to access non-existent table entry");
@@ -118,6 +298,13 @@ namespace mjx {
             }
 
             const _Table_entry* _Find_message(const uint64_t _Hash) const noexcept {
+                if (_Mysorted) { // entries sorted by hash, use binary search
+                    const _Table_entry* const _Last = _Myentries + _Mysize;
+                    const _Table_entry* const _Iter = ::std::lower_bound(_Myentries, _Last, _Hash,
+                        [](const _Table_entry& _Entry, const uint64_t _Val) noexcept { return _Entry._Hash < _Val; });
+                    return _Iter != _Last && _Iter->_Hash == _Hash ? _Iter : nullptr;
+                }
+
                 for (size_t _Idx = 0; _Idx < _Mysize; ++_Idx) {
                     if (_Myentries[_Idx]._Hash == _Hash) {
                         return &_Myentries[_Idx];
@@ -128,36 +315,344 @@ namespace mjx {
             }
 
             void _Destroy() noexcept {
-                if (_Myentries && _Mysize > 0) {
-                    ::mjx::delete_object_array(_Myentries, _Mysize);
-                    _Myentries = nullptr;
-                    _Mysize    = 0;
-                    _Myoff     = 0;
-                }
+                _Myentries = nullptr;
+                _Mysize    = 0;
+                _Mysorted  = false;
             }
 
-            void _Resize(const size_t _New_size) {
-                _Destroy(); // destroy the existing table
-                _Myentries = ::mjx::allocate_object_array<_Table_entry>(_New_size);
-                _Mysize    = _New_size;
+            void _Assign_view(
+                const _Table_entry* const _Entries, const size_t _Size, const bool _Sorted = false) noexcept {
+                // refer to the external entries, which must outlive the table
+                _Myentries = _Entries;
+                _Mysize    = _Size;
+                _Mysorted  = _Sorted;
             }
 
-            void _Append_entry(const _Table_entry& _Entry) noexcept {
+        private:
+            const _Table_entry* _Myentries;
+            size_t _Mysize;
+            bool _Mysorted; // true if the entries are sorted by hash
+        };
+
+        inline int _Compare_message_ids(const utf8_string_view _Left, const utf8_string_view _Right) noexcept {
+            // compares the raw bytes of two IDs, which is the order in which the ID section is sorted
+            const size_t _Size = (::std::min)(_Left.size(), _Right.size());
+            const int _Result  = _Size > 0 ? ::memcmp(_Left.data(), _Right.data(), _Size) : 0;
+            if (_Result != 0) {
+                return _Result;
+            }
+
+            return _Left.size() < _Right.size() ? -1 : (_Left.size() > _Right.size() ? 1 : 0);
+        }
+
+        inline bool _Has_id_prefix(const utf8_string_view _Id, const utf8_string_view _Prefix) noexcept {
+            return _Id.size() >= _Prefix.size()
+                && (_Prefix.empty() || ::memcmp(_Id.data(), _Prefix.data(), _Prefix.size()) == 0);
+        }
+
+        class _Umc_id_section { // stores a view of the optional section that holds the original message IDs
+        public:
+            struct _Record {
+                uint64_t _Hash = 0;
+                utf8_string_view _Id;
+            };
+
+            _Umc_id_section() noexcept
+                : _Mydata(nullptr), _Myrecords(nullptr), _Mypool(nullptr), _Mycount(0), _Mypool_size(0) {}
+
+            ~_Umc_id_section() noexcept {}
+
+            _Umc_id_section(const _Umc_id_section&)            = delete;
+            _Umc_id_section& operator=(const _Umc_id_section&) = delete;
+
+            bool _Valid() const noexcept {
+                return _Mydata != nullptr;
+            }
+
+            size_t _Size() const noexcept {
+                return _Mycount;
+            }
+
+            const byte_t* _Data() const noexcept {
+                return _Mydata;
+            }
+
+            size_t _Size_in_bytes() const noexcept {
+                return _Valid() ? _Header_size + _Mycount * _Record_size + _Mypool_size : 0;
+            }
+
+            _Record _At(const size_t _Idx) const noexcept {
 #ifdef _DEBUG
-                _INTERNAL_ASSERT(_Myoff < _Mysize, "the table is too small");
+                _INTERNAL_ASSERT(_Idx < _Mycount, "attempt to access non-existent ID record");
 #endif // _DEBUG
-                _Myentries[_Myoff++] = _Entry;
+                // Note: The section is not aligned, so every field is loaded separately. The ID bounds
+                //       are verified here rather than during loading, so that mapped catalogs are not
+                //       paged in as a whole.
+                const byte_t* const _Bytes = _Myrecords + _Idx * _Record_size;
+                const size_t _Off          = _Load_integer<uint32_t>(_Bytes + 8);
+                const size_t _Len          = _Load_integer<uint32_t>(_Bytes + 12);
+                if (_Off > _Mypool_size || _Len > _Mypool_size - _Off) { // ID exceeds the pool, break
+                    return _Record{};
+                }
+
+                return _Record{_Load_integer<uint64_t>(_Bytes), utf8_string_view{_Mypool + _Off, _Len}};
+            }
+
+            size_t _Lower_bound(const utf8_string_view _Id) const noexcept {
+                // returns the index of the first record whose ID is not less than _Id
+                size_t _First = 0;
+                size_t _Count = _Mycount;
+                while (_Count > 0) {
+                    const size_t _Half = _Count / 2;
+                    if (_Compare_message_ids(_At(_First + _Half)._Id, _Id) < 0) {
+                        _First += _Half + 1;
+                        _Count -= _Half + 1;
+                    } else {
+                        _Count = _Half;
+                    }
+                }
+
+                return _First;
+            }
+
+            bool _Contains(const uint64_t _Hash, const utf8_string_view _Id) const noexcept {
+                const size_t _Idx = _Lower_bound(_Id);
+                if (_Idx == _Mycount) { // ID not found, break
+                    return false;
+                }
+
+                const _Record& _Found = _At(_Idx);
+                return _Found._Hash == _Hash && _Compare_message_ids(_Found._Id, _Id) == 0;
+            }
+
+            void _Destroy() noexcept {
+                _Mydata      = nullptr;
+                _Myrecords   = nullptr;
+                _Mypool      = nullptr;
+                _Mycount     = 0;
+                _Mypool_size = 0;
+            }
+
+            bool _Assign_view(const byte_t* const _Data, const size_t _Size) noexcept {
+                // Note: The section starts with the 4-byte signature, 4-byte ID count and 4-byte pool size.
+                //       It is followed by the records, each made of the 8-byte hash, 4-byte offset and
+                //       4-byte length of the ID, sorted by the ID bytes, and the pool of UTF-8 IDs.
+                using _Traits = char_traits<byte_t>;
+                if (_Size < _Header_size || !_Traits::eq(_Data, _Signature, sizeof(_Signature))) {
+                    return false;
+                }
+
+                const size_t _Count     = _Load_integer<uint32_t>(_Data + 4);
+                const size_t _Pool_size = _Load_integer<uint32_t>(_Data + 8);
+                if (_Count > (_Size - _Header_size) / _Record_size
+                    || _Pool_size > _Size - _Header_size - _Count * _Record_size) { // truncated section, break
+                    return false;
+                }
+
+                _Mydata      = _Data;
+                _Myrecords   = _Data + _Header_size;
+                _Mypool      = reinterpret_cast<const char*>(_Myrecords + _Count * _Record_size);
+                _Mycount     = _Count;
+                _Mypool_size = _Pool_size;
+                return true;
+            }
+
+        private:
+            static constexpr size_t _Header_size = 12;
+            static constexpr size_t _Record_size = 16;
+            static constexpr byte_t _Signature[] = {'U', 'M', 'I', '\0'};
+
+            const byte_t* _Mydata;
+            const byte_t* _Myrecords;
+            const char* _Mypool;
+            size_t _Mycount;
+            size_t _Mypool_size;
+        };
+
+        struct _Message_location { // stores a table entry and the blob that holds its message
+            const _Umc_lookup_table::_Table_entry* _Entry = nullptr;
+            const _Umc_blob* _Blob                        = nullptr;
+
+            bool _Found() const noexcept {
+                return _Entry != nullptr;
+            }
+        };
+
+        struct _Message_range { // location of a message within its blob
+            size_t _Offset = 0;
+            size_t _Length = 0;
+        };
+
+        inline _Message_range _Entry_range(const _Umc_lookup_table::_Table_entry* const _Entry) noexcept {
+#ifdef _M_X64
+            return _Message_range{_Entry->_Offset, static_cast<size_t>(_Entry->_Length)};
+#else // ^^^ _M_X64 ^^^ / vvv _M_IX86 vvv
+            return _Message_range{static_cast<size_t>(_Entry->_Offset), _Entry->_Length};
+#endif // _M_X64
+        }
+
+        class _Umc_merged_index { // maps message hashes to the first catalog in a chain that contains them
+        public:
+            struct _Index_entry {
+                uint64_t _Hash;
+                _Message_location _Location;
+            };
+
+            explicit _Umc_merged_index(allocator& _Al) noexcept : _Myentries(_Alloc{_Al}) {}
+
+            ~_Umc_merged_index() noexcept {}
+
+            _Umc_merged_index()                                    = delete;
+            _Umc_merged_index(const _Umc_merged_index&)            = delete;
+            _Umc_merged_index& operator=(const _Umc_merged_index&) = delete;
+
+            bool _Empty() const noexcept {
+                return _Myentries.empty();
+            }
+
+            size_t _Memory_usage() const noexcept {
+                return _Myentries.capacity() * sizeof(_Index_entry);
+            }
+
+            _Message_location _Find_message(const uint64_t _Hash) const noexcept {
+                const auto _Iter = ::std::lower_bound(_Myentries.begin(), _Myentries.end(), _Hash,
+                    [](const _Index_entry& _Entry, const uint64_t _Val) noexcept { return _Entry._Hash < _Val; });
+                if (_Iter == _Myentries.end() || _Iter->_Hash != _Hash) { // not found
+                    return _Message_location{};
+                }
+
+                return _Iter->_Location;
+            }
+
+            void _Append_catalog(const _Umc_lookup_table& _Table, const _Umc_blob& _Blob) {
+                // Note: Catalogs are appended in order of preference. Messages that are already indexed
+                //       belong to a more preferred catalog, so only the missing ones are taken from _Table.
+                _Vector _New_entries(_Myentries.get_allocator());
+                _New_entries.reserve(_Table._Size());
+                for (size_t _Idx = 0; _Idx < _Table._Size(); ++_Idx) {
+                    const auto* const _Entry = _Table._At(_Idx);
+                    _New_entries.push_back(_Index_entry{_Entry->_Hash, _Message_location{_Entry, &_Blob}});
+                }
+
+                constexpr auto _Less = [](const _Index_entry& _Left, const _Index_entry& _Right) noexcept {
+                    return _Left._Hash < _Right._Hash;
+                };
+                ::std::stable_sort(_New_entries.begin(), _New_entries.end(), _Less);
+
+                // std::merge() prefers the first range on ties and std::unique() keeps the first element
+                // of each group, therefore the more preferred location always survives
+                _Vector _Merged(_Myentries.get_allocator());
+                _Merged.reserve(_Myentries.size() + _New_entries.size());
+                ::std::merge(_Myentries.begin(), _Myentries.end(),
+                    _New_entries.begin(), _New_entries.end(), ::std::back_inserter(_Merged), _Less);
+                _Merged.erase(::std::unique(_Merged.begin(), _Merged.end(),
+                    [](const _Index_entry& _Left, const _Index_entry& _Right) noexcept {
+                        return _Left._Hash == _Right._Hash;
+                    }), _Merged.end());
+                _Merged.shrink_to_fit();
+                _Myentries.swap(_Merged);
+            }
+
+            void _Clear() noexcept {
+                _Myentries.clear();
+                _Myentries.shrink_to_fit();
+            }
+
+        private:
+            using _Alloc  = instance_allocator<_Index_entry>;
+            using _Vector = ::std::vector<_Index_entry, _Alloc>;
+
+            _Vector _Myentries;
+        };
+
+        class __declspec(novtable) _Catalog_reader { // base class for all catalog data sources
+        public:
+            virtual ~_Catalog_reader() noexcept {}
+
+            // reads exactly _Count bytes, fails if there is not enough data to read
+            virtual bool _Read_exactly(byte_t* const _Buf, const size_t _Count) noexcept = 0;
+
+            // returns a view of the next _Count bytes without copying them, or null if not supported
+            virtual const byte_t* _Read_view(const size_t _Count) noexcept = 0;
+
+            // returns the number of bytes that have not been read yet
+            virtual size_t _Remaining() const noexcept = 0;
+        };
+
+        class _File_catalog_reader : public _Catalog_reader { // reads a catalog from a file stream
+        public:
+            _File_catalog_reader(file_stream& _Stream, const uint64_t _File_size) noexcept
+                : _Mystream(_Stream), _Myfile_size(_File_size) {}
+
+            ~_File_catalog_reader() noexcept override {}
+
+            _File_catalog_reader()                                       = delete;
+            _File_catalog_reader(const _File_catalog_reader&)            = delete;
+            _File_catalog_reader& operator=(const _File_catalog_reader&) = delete;
+
+            bool _Read_exactly(byte_t* const _Buf, const size_t _Count) noexcept override {
+                return _Mystream.read_exactly(_Buf, _Count);
+            }
+
+            const byte_t* _Read_view(const size_t) noexcept override {
+                return nullptr; // streams cannot provide views
+            }
+
+            size_t _Remaining() const noexcept override {
+                const uint64_t _Pos = static_cast<uint64_t>(_Mystream.tell());
+                return _Pos < _Myfile_size ? static_cast<size_t>(_Myfile_size - _Pos) : 0;
             }
 
         private:
-            _Table_entry* _Myentries;
+            file_stream& _Mystream;
+            uint64_t _Myfile_size;
+        };
+
+        class _Memory_catalog_reader : public _Catalog_reader { // reads a catalog from a memory buffer
+        public:
+            _Memory_catalog_reader(const byte_t* const _Data, const size_t _Size) noexcept
+                : _Mydata(_Data), _Mysize(_Size), _Myoff(0) {}
+
+            ~_Memory_catalog_reader() noexcept override {}
+
+            _Memory_catalog_reader()                                         = delete;
+            _Memory_catalog_reader(const _Memory_catalog_reader&)            = delete;
+            _Memory_catalog_reader& operator=(const _Memory_catalog_reader&) = delete;
+
+            bool _Read_exactly(byte_t* const _Buf, const size_t _Count) noexcept override {
+                const byte_t* const _View = _Read_view(_Count);
+                if (!_View) { // not enough data, break
+                    return false;
+                }
+
+                ::memcpy(_Buf, _View, _Count);
+                return true;
+            }
+
+            const byte_t* _Read_view(const size_t _Count) noexcept override {
+                if (_Count > _Mysize - _Myoff) { // not enough data, break
+                    return nullptr;
+                }
+
+                const byte_t* const _View = _Mydata + _Myoff;
+                _Myoff += _Count;
+                return _View;
+            }
+
+            size_t _Remaining() const noexcept override {
+                return _Mysize - _Myoff;
+            }
+
+        private:
+            const byte_t* _Mydata;
             size_t _Mysize;
             size_t _Myoff;
         };
 
         class _Catalog_loader { // manages a catalog loading process
         public:
-            explicit _Catalog_loader(file_stream& _Stream) noexcept : _Mystream(_Stream) {}
+            _Catalog_loader(_Catalog_reader& _Reader, const bool _Borrow) noexcept
+                : _Myreader(_Reader), _Myborrow(_Borrow), _Myversion(0), _Myencoding(_Umc_text_encoding::_Utf8) {}
 
             ~_Catalog_loader() noexcept {}
 
@@ -166,27 +661,49 @@ namespace mjx {
             _Catalog_loader& operator=(const _Catalog_loader&) = delete;
 
             bool _Verify_signature() noexcept {
-                // compare the stored signature with the original
+                // compare the stored signature with the original, the last byte holds the format version
                 using _Traits = char_traits<byte_t>;
                 byte_t _Buf[_Signature_size];
-                return _Mystream.read_exactly(_Buf, _Signature_size)
-                    && _Traits::eq(_Buf, _Signature, _Signature_size);
+                if (!_Myreader._Read_exactly(_Buf, _Signature_size)
+                    || !_Traits::eq(_Buf, _Signature, _Signature_size - 1)) {
+                    return false;
+                }
+
+                _Myversion = _Buf[_Signature_size - 1];
+                return _Myversion <= _Umc_latest_version;
+            }
+
+            bool _Get_text_encoding() noexcept {
+                if (_Myversion == 0) { // the original format always stores UTF-8 text
+                    _Myencoding = _Umc_text_encoding::_Utf8;
+                    return true;
+                }
+
+                uint8_t _Encoding;
+                if (!_Myreader._Read_exactly(&_Encoding, 1)) {
+                    return false;
+                }
+
+                // Note: Wide text is stored in the width of the wchar_t it was written for. Text in
+                //       a different width would have to be transcoded, which the format is meant to avoid.
+                _Myencoding = static_cast<_Umc_text_encoding>(_Encoding);
+                return _Myencoding == _Umc_text_encoding::_Utf8 || _Is_native_text_encoding(_Myencoding);
             }
 
             bool _Get_language_and_lcid(unicode_string& _Language, uint32_t& _Lcid) {
                 size_t _Lang_length;
                 { // load language name length first
                     uint8_t _Len;
-                    if (!_Mystream.read_exactly(&_Len, 1)) {
+                    if (!_Myreader._Read_exactly(&_Len, 1)) {
                         return false;
                     }
 
                     _Lang_length = static_cast<size_t>(_Len);
                 }
 
-                constexpr size_t _Buf_size = 132; // at most 128-byte language + 4-byte LCID
+                constexpr size_t _Buf_size = 259; // at most 255-byte language + 4-byte LCID
                 byte_t _Buf[_Buf_size];
-                if (!_Mystream.read_exactly(_Buf, _Lang_length + 4)) {
+                if (!_Myreader._Read_exactly(_Buf, _Lang_length + 4)) {
                     return false;
                 }
 
@@ -198,7 +715,7 @@ namespace mjx {
             bool _Get_message_count(size_t& _Count) noexcept {
                 constexpr size_t _Buf_size = sizeof(uint32_t);
                 byte_t _Buf[_Buf_size];
-                if (!_Mystream.read_exactly(_Buf, _Buf_size)) {
+                if (!_Myreader._Read_exactly(_Buf, _Buf_size)) {
                     return false;
                 }
 
@@ -206,52 +723,165 @@ namespace mjx {
                 return true;
             }
 
-            bool _Load_lookup_table(const size_t _Count, _Umc_lookup_table& _Table) {
-                constexpr size_t _Bytes_per_entry = sizeof(_Umc_lookup_table::_Table_entry);
-                const size_t _Buf_size            = _Count * _Bytes_per_entry;
-                unique_smart_array<byte_t> _Buf   = ::mjx::make_unique_smart_array<byte_t>(_Buf_size);
-                if (!_Mystream.read_exactly(_Buf.get(), _Buf_size)) {
-                    return false;
+            bool _Load_lookup_table(const size_t _Count, _Umc_lookup_table& _Table, _Catalog_arena& _Arena) {
+                using _Table_entry      = _Umc_lookup_table::_Table_entry;
+                const size_t _Remaining = _Myreader._Remaining();
+                if (_Count > _Remaining / sizeof(_Table_entry)) { // not enough data, break
+                    return false; // checked before multiplying, so the table size cannot overflow
                 }
 
-                _Table._Resize(_Count); // reserve space for all entries
-                for (size_t _Off = 0; _Off < _Buf_size; _Off += _Bytes_per_entry) {
-                    _Table._Append_entry(*reinterpret_cast<_Umc_lookup_table::_Table_entry*>(_Buf.get() + _Off));
+                const size_t _Buf_size = _Count * sizeof(_Table_entry);
+                if (_Myborrow) { // refer to the source data if it is suitably aligned
+                    const byte_t* const _View = _Myreader._Read_view(_Buf_size);
+                    if (!_View) { // not enough data, break
+                        return false;
+                    }
+
+                    if (reinterpret_cast<uintptr_t>(_View) % alignof(_Table_entry) == 0) {
+                        _Table._Assign_view(reinterpret_cast<const _Table_entry*>(_View), _Count);
+                    } else { // misaligned entries, copy them to the arena
+                        byte_t* const _Block = _Arena._Allocate(_Buf_size, 0);
+                        ::memcpy(_Block, _View, _Buf_size);
+                        _Table._Assign_view(reinterpret_cast<const _Table_entry*>(_Block), _Count);
+                    }
+
+                    return true;
                 }
 
+                // Note: The table, the blob and the ID section are copied into a single block, so that
+                //       the catalog is opened and closed with a single allocation, see _Catalog_arena.
+                // _Table_entry matches the stored layout, so the entries can be read in place
+                byte_t* const _Block = _Arena._Allocate(_Buf_size, _Remaining - _Buf_size);
+                if (!_Myreader._Read_exactly(_Block, _Buf_size)) {
+                    return false;
+                }
+
+                _Table._Assign_view(reinterpret_cast<const _Table_entry*>(_Block), _Count);
                 return true;
             }
 
-            bool _Load_blob(_Umc_lookup_table& _Table, _Umc_blob& _Blob) {
-                size_t _Blob_size = 0;
+            bool _Load_blob(_Umc_lookup_table& _Table, _Umc_blob& _Blob, _Catalog_arena& _Arena) {
+                const size_t _Remaining = _Myreader._Remaining();
+                size_t _Blob_size       = 0;
                 for (size_t _Idx = 0; _Idx < _Table._Size(); ++_Idx) { // calculate blob size
-                    _Blob_size += _Table._At(_Idx)->_Length;
+                    const size_t _Length = _Table._At(_Idx)->_Length;
+                    if (_Length > _Remaining - _Blob_size) { // blob exceeds the catalog, break
+                        return false; // checked before adding, so the blob size cannot overflow
+                    }
+
+                    _Blob_size += _Length;
+                }
+
+                if (_Myborrow) { // refer to the source data
+                    const byte_t* const _View = _Myreader._Read_view(_Blob_size);
+                    if (!_View) { // not enough data, break
+                        return false;
+                    }
+
+                    _Blob._Assign_view(_View, _Blob_size, false, _Myencoding);
+                    return true;
                 }
 
-                _Blob._Resize(_Blob_size);
-                return _Mystream.read_exactly(_Blob._Data(), _Blob_size);
+                if (!_Arena._Split_data(_Blob_size)) { // blob exceeds the catalog, break
+                    return false;
+                }
+
+                byte_t* const _Data = _Arena._Blob_data();
+                if (!_Myreader._Read_exactly(_Data, _Blob_size)) {
+                    return false;
+                }
+
+                // Note: The copied blob is still in cache, so it is validated once here and every fetch
+                //       can skip validation. Borrowed blobs are validated by each fetch instead,
+                //       which keeps mapped files from being paged in as a whole.
+                const bool _Validated = _Myencoding != _Umc_text_encoding::_Utf8 || _Validate_utf8(_Data, _Blob_size);
+                _Blob._Assign_view(_Data, _Blob_size, _Validated, _Myencoding);
+                return true;
+            }
+
+            bool _Load_id_section(_Umc_id_section& _Ids, _Catalog_arena& _Arena) {
+                // Note: The ID section is optional and follows the blob. Readers that do not know it
+                //       ignore the trailing data, therefore a malformed section only disables the features
+                //       that depend on it instead of failing the whole catalog.
+                if (_Myborrow) { // refer to the source data
+                    const size_t _Size = _Myreader._Remaining();
+                    if (_Size > 0) {
+                        _Ids._Assign_view(_Myreader._Read_view(_Size), _Size);
+                    }
+
+                    return true;
+                }
+
+                const size_t _Size = _Arena._Id_section_size();
+                if (_Size == 0) { // no ID section
+                    return true;
+                }
+
+                byte_t* const _Data = _Arena._Id_section_data();
+                if (!_Myreader._Read_exactly(_Data, _Size)) {
+                    return false;
+                }
+
+                _Ids._Assign_view(_Data, _Size);
+                return true;
             }
 
         private:
             static constexpr size_t _Signature_size             = 4;
             static constexpr byte_t _Signature[_Signature_size] = {'U', 'M', 'C', '\0'};
 
-            file_stream& _Mystream;
+            _Catalog_reader& _Myreader;
+            bool _Myborrow; // true if the loaded data should refer to the source instead of copying it
+            uint8_t _Myversion;
+            _Umc_text_encoding _Myencoding;
         };
 
         class _Message_catalog {
         public:
             unicode_string _Language;
             uint32_t _Lcid;
+            _Catalog_arena _Arena;
             _Umc_lookup_table _Table;
             _Umc_blob _Blob;
+            _Umc_id_section _Ids;
+            _Mapped_file _Mapping;
+            unique_smart_ptr<_Message_catalog> _Overlay;
+            ::std::vector<unique_smart_ptr<_Message_catalog>,
+                instance_allocator<unique_smart_ptr<_Message_catalog>>> _Fallbacks;
+            _Umc_merged_index _Index;
+            // Note: The flag may be changed while other threads look messages up, each lookup sees either
+            //       the old or the new value. It only selects whether hits are verified, so no ordering is needed.
+            ::std::atomic<bool> _Strict; // true if hash hits are verified against the stored IDs
 
-            explicit _Message_catalog(const path& _Target) : _Language(), _Lcid(0), _Table(), _Blob() {
-                if (!_Load_from_file(_Target)) { // failed to load the catalog, erase any loaded data
+            _Message_catalog(const path& _Target, const catalog_load_mode _Mode, allocator& _Al)
+                : _Language(), _Lcid(0), _Arena(_Al), _Table(), _Blob(), _Ids(), _Mapping(),
+                _Overlay(nullptr), _Fallbacks(_Al), _Index(_Al), _Strict(false) {
+                if (!_Load_from_file(_Target, _Mode)) { // failed to load the catalog, erase any loaded data
                     _Erase_data();
                 }
             }
 
+            _Message_catalog(const byte_string_view _Buffer, const catalog_buffer_mode _Mode, allocator& _Al)
+                : _Language(), _Lcid(0), _Arena(_Al), _Table(), _Blob(), _Ids(), _Mapping(),
+                _Overlay(nullptr), _Fallbacks(_Al), _Index(_Al), _Strict(false) {
+                _Memory_catalog_reader _Reader(_Buffer.data(), _Buffer.size());
+                if (!_Load(_Reader, _Mode == catalog_buffer_mode::borrow)) { // failed to load the catalog
+                    _Erase_data();
+                }
+            }
+
+            _Message_catalog(const static_catalog& _Catalog, allocator& _Al)
+                : _Language(_Catalog.language), _Lcid(_Catalog.lcid), _Arena(_Al), _Table(), _Blob(),
+                _Ids(), _Mapping(), _Overlay(nullptr), _Fallbacks(_Al), _Index(_Al), _Strict(false) {
+                // Note: Static catalogs are generated at build time, so there is nothing to parse.
+                //       Both the table and the blob refer to the embedded data.
+                if (_Catalog.entry_count > 0) {
+                    _Table._Assign_view(reinterpret_cast<const _Umc_lookup_table::_Table_entry*>(_Catalog.entries),
+                        _Catalog.entry_count, true);
+                    _Blob._Assign_view(_Catalog.blob, _Catalog.blob_size, true); // validated by mkuts
+                }
+            }
+
             ~_Message_catalog() noexcept {}
 
             _Message_catalog()                                   = delete;
@@ -264,34 +894,176 @@ namespace mjx {
                 return !_Language.empty() && (_Lcid > 0 && _Lcid <= 0x7FFF'FFFF);
             }
 
+            _Message_location _Find_message(const uint64_t _Hash) const noexcept {
+                if (_Overlay) { // check the overlay first, its messages take precedence
+                    const _Message_location _Location = _Overlay->_Find_message(_Hash);
+                    if (_Location._Found()) {
+                        return _Location;
+                    }
+                }
+
+                if (!_Index._Empty()) { // fallbacks attached, the merged index covers the whole chain
+                    return _Index._Find_message(_Hash);
+                }
+
+                return _Message_location{_Table._Find_message(_Hash), &_Blob};
+            }
+
+            _Message_location _Find_message(const uint64_t _Hash, const utf8_string_view _Id) const noexcept {
+                const _Message_location _Location = _Find_message(_Hash);
+                if (!_Strict.load(::std::memory_order_relaxed) || !_Location._Found()) { // nothing to verify
+                    return _Location;
+                }
+
+                // Note: Catalogs without the ID section cannot be verified, so their hits are trusted.
+                const _Umc_id_section* const _Section = _Find_id_section(_Location._Blob);
+                return !_Section || _Section->_Contains(_Hash, _Id) ? _Location : _Message_location{};
+            }
+
+            const _Umc_id_section* _Find_id_section(const _Umc_blob* const _Owner) const noexcept {
+                // returns the ID section of the catalog in the chain that owns _Owner, if it has one
+                if (_Owner == &_Blob) {
+                    return _Ids._Valid() ? &_Ids : nullptr;
+                }
+
+                if (_Overlay) {
+                    const _Umc_id_section* const _Section = _Overlay->_Find_id_section(_Owner);
+                    if (_Section) {
+                        return _Section;
+                    }
+                }
+
+                for (const unique_smart_ptr<_Message_catalog>& _Fallback : _Fallbacks) {
+                    if (_Owner == &_Fallback->_Blob) {
+                        return _Fallback->_Ids._Valid() ? &_Fallback->_Ids : nullptr;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            void _Attach_fallback(unique_smart_ptr<_Message_catalog>&& _Fallback) {
+                if (_Index._Empty()) { // first fallback, index this catalog's own messages first
+                    _Index._Append_catalog(_Table, _Blob);
+                }
+
+                _Index._Append_catalog(_Fallback->_Table, _Fallback->_Blob);
+                _Fallbacks.push_back(::std::move(_Fallback));
+            }
+
+            void _Detach_fallbacks() noexcept {
+                _Index._Clear();
+                _Fallbacks.clear();
+            }
+
+            void _Accumulate_memory_usage(catalog_memory_usage& _Usage) const noexcept {
+                const size_t _Table_bytes    = _Table._Size() * sizeof(_Umc_lookup_table::_Table_entry);
+                const size_t _Language_bytes = _Language.capacity() * sizeof(wchar_t);
+                const size_t _Index_bytes    =
+                    _Index._Memory_usage() + _Fallbacks.capacity() * sizeof(unique_smart_ptr<_Message_catalog>);
+                _Usage.table_bytes    += _Table_bytes;
+                _Usage.blob_bytes     += _Blob._Size();
+                _Usage.id_bytes       += _Ids._Size_in_bytes();
+                _Usage.language_bytes += _Language_bytes;
+                _Usage.index_bytes    += _Index_bytes;
+                _Usage.heap_bytes     += sizeof(_Message_catalog) + _Language_bytes + _Index_bytes + _Arena._Size();
+
+                // Note: Data that is not owned lives either in the arena, in the mapped view or in memory
+                //       owned by the caller. The mapped view is reported as a whole, including the header.
+                const bool _Mapped = _Mapping._Is_mapped();
+                if (!_Mapped && !_Arena._Contains(_Table._Data())) {
+                    _Usage.borrowed_bytes += _Table_bytes;
+                }
+
+                if (!_Mapped && !_Arena._Contains(_Blob._Data())) {
+                    _Usage.borrowed_bytes += _Blob._Size();
+                }
+
+                if (!_Mapped && _Ids._Valid() && !_Arena._Contains(_Ids._Data())) {
+                    _Usage.borrowed_bytes += _Ids._Size_in_bytes();
+                }
+
+                if (_Mapped) {
+                    _Usage.mapped_bytes += _Mapping._Size();
+                }
+
+                if (_Overlay) {
+                    _Overlay->_Accumulate_memory_usage(_Usage);
+                }
+
+                for (const unique_smart_ptr<_Message_catalog>& _Fallback : _Fallbacks) {
+                    _Fallback->_Accumulate_memory_usage(_Usage);
+                }
+            }
+
         private:
-            bool _Load_from_file(const path& _Target) {
+            bool _Load_from_file(const path& _Target, const catalog_load_mode _Mode) {
+                _UMLS_TRACE_SPAN("umc load");
                 if (_Target.extension() != L".umc") { // invalid extension, break
                     return false;
                 }
 
                 file _File(_Target, file_access::read, file_share::read);
+                if (_Mode == catalog_load_mode::map) { // map the file and refer to the mapped data
+                    if (!_File.is_open() || !_Mapping._Map(_File)) { // failed to map the file, break
+                        return false;
+                    }
+
+                    _Memory_catalog_reader _Reader(_Mapping._Data(), _Mapping._Size());
+                    return _Load(_Reader, true);
+                }
+
                 file_stream _Stream(_File);
                 if (!_Stream.is_open()) { // invalid stream, break
                     return false;
                 }
 
-                _Catalog_loader _Loader(_Stream);
-                if (!_Loader._Verify_signature()) { // signature not recognized, break
-                    return false;
-                }
+                _File_catalog_reader _Reader(_Stream, _File.size());
+                return _Load(_Reader, false);
+            }
 
-                if (!_Loader._Get_language_and_lcid(_Language, _Lcid)) { // failed to load language and LCID, break
-                    return false;
+            bool _Load(_Catalog_reader& _Reader, const bool _Borrow) {
+                _Catalog_loader _Loader(_Reader, _Borrow);
+                {
+                    _UMLS_TRACE_SPAN("umc signature");
+                    if (!_Loader._Verify_signature()) { // signature or version not recognized, break
+                        return false;
+                    }
                 }
 
                 size_t _Count;
-                if (!_Loader._Get_message_count(_Count)) { // failed to get the number of messages, break
-                    return false;
+                {
+                    _UMLS_TRACE_SPAN("umc header");
+                    if (!_Loader._Get_text_encoding()) { // missing or unsupported text encoding, break
+                        return false;
+                    }
+
+                    if (!_Loader._Get_language_and_lcid(_Language, _Lcid)) { // failed to load language and LCID, break
+                        return false;
+                    }
+
+                    if (!_Loader._Get_message_count(_Count)) { // failed to get the number of messages, break
+                        return false;
+                    }
                 }
 
                 if (_Count > 0) { // some messages declared, try to load them
-                    if (!_Loader._Load_lookup_table(_Count, _Table) || !_Loader._Load_blob(_Table, _Blob)) {
+                    {
+                        _UMLS_TRACE_SPAN("umc table");
+                        if (!_Loader._Load_lookup_table(_Count, _Table, _Arena)) { // failed to load the table, break
+                            return false;
+                        }
+                    }
+
+                    {
+                        _UMLS_TRACE_SPAN("umc blob");
+                        if (!_Loader._Load_blob(_Table, _Blob, _Arena)) { // failed to load the blob, break
+                            return false;
+                        }
+                    }
+
+                    _UMLS_TRACE_SPAN("umc ids");
+                    if (!_Loader._Load_id_section(_Ids, _Arena)) { // failed to read the IDs, break
                         return false;
                     }
                 }
@@ -305,6 +1077,9 @@ namespace mjx {
                 _Lcid = 0;
                 _Table._Destroy();
                 _Blob._Destroy();
+                _Ids._Destroy();
+                _Arena._Release();
+                _Mapping._Unmap();
             }
         };
     } // namespace umls_impl
@@ -0,0 +1,47 @@
+// file_writer.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_FILE_WRITER_HPP_
+#define _UMLS_IMPL_FILE_WRITER_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjfs/path.hpp>
+#include <mjfs/status.hpp>
+#include <mjstr/string.hpp>
+#include <mjstr/string_view.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        inline void _Append_le_integer(byte_string& _Data, uint64_t _Value, const size_t _Size) {
+            // appends the lowest _Size bytes of _Value in little-endian order
+            for (size_t _Idx = 0; _Idx < _Size; ++_Idx) {
+                _Data.push_back(static_cast<byte_t>(_Value & 0xFF));
+                _Value >>= 8;
+            }
+        }
+
+        inline bool _Write_whole_file(const path& _Target, const byte_string_view _Data) {
+            // creates the file or replaces its contents
+            file _File;
+            if (::mjx::exists(_Target)) { // file already exists, clear it
+                if (!_File.open(_Target, file_access::write) || !_File.resize(0)) {
+                    return false;
+                }
+            } else { // file does not exist, create a new one
+                if (!::mjx::create_file(_Target, ::std::addressof(_File))) {
+                    return false;
+                }
+            }
+
+            file_stream _Stream(_File);
+            return _Stream.is_open() && (_Data.empty() || _Stream.write(_Data.data(), _Data.size()));
+        }
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_FILE_WRITER_HPP_
\ No newline at end of file
@@ -8,37 +8,47 @@
 #define _UMLS_IMPL_FORMAT_HPP_
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
+#include <mjmem/allocator.hpp>
+#include <mjstr/string.hpp>
 #include <mjstr/string_view.hpp>
 #include <umls/format.hpp>
+#include <umls/format_arena.hpp>
 
 namespace mjx {
     namespace umls_impl {
         inline constexpr size_t _Spec_not_found = static_cast<size_t>(-1);
         inline constexpr size_t _Invalid_index  = static_cast<size_t>(-1);
     
-        constexpr bool _Is_digit(const wchar_t _Ch) noexcept {
-            return _Ch >= L'0' && _Ch <= L'9';
+        template <class _Elem>
+        inline constexpr _Elem _Spec_prefix[2] = {static_cast<_Elem>('{'), static_cast<_Elem>('%')};
+
+        template <class _Elem>
+        constexpr bool _Is_digit(const _Elem _Ch) noexcept {
+            return _Ch >= static_cast<_Elem>('0') && _Ch <= static_cast<_Elem>('9');
         }
 
-        constexpr size_t _Chars_to_index(const wchar_t* _Chars, const size_t _Count) noexcept {
+        template <class _Elem>
+        constexpr size_t _Chars_to_index(const _Elem* _Chars, const size_t _Count) noexcept {
             // assumes that _Count is greater than zero and not more than three
-            const wchar_t* const _Sentinel = _Chars + _Count;
+            const _Elem* const _Sentinel = _Chars + _Count;
             size_t _Value                  = 0;
             for (; _Chars != _Sentinel; ++_Chars) {
                 if (!_Is_digit(*_Chars)) { // index must consist only of digits
                     return _Invalid_index;
                 }
 
-                _Value = _Value * 10 + static_cast<size_t>(*_Chars - L'0');
+                _Value = _Value * 10 + static_cast<size_t>(*_Chars - static_cast<_Elem>('0'));
             }
 
             return _Value;
         }
 
-        constexpr bool _Is_valid_format_spec(const wchar_t* _First, const wchar_t* const _Last) noexcept {
+        template <class _Elem>
+        constexpr bool _Is_valid_format_spec(const _Elem* _First, const _Elem* const _Last) noexcept {
             uint8_t _Digits = 0; // number of digits processed
             for (; _First != _Last; ++_First) {
-                if (*_First == L'}') { // end of the format specifier found
+                if (*_First == static_cast<_Elem>('}')) { // end of the format specifier found
                     if (_Digits > 0) { // index must consist of at least one digit
                         return true;
                     }
@@ -54,9 +64,10 @@ namespace mjx {
             return false; // invalid format specifier
         }
 
+        template <class _Elem>
         struct _Fmt_index {
-            size_t _Digits    = 0; // number of digits
-            wchar_t _Chars[3] = {L'\0'}; // array of digits, with a maximum of three digits
+            size_t _Digits  = 0; // number of digits
+            _Elem _Chars[3] = {}; // array of digits, with a maximum of three digits
         };
 
         struct _Fmt_spec {
@@ -69,17 +80,18 @@ namespace mjx {
             }
         };
 
-        inline _Fmt_spec _Find_format_spec(const wchar_t* const _First, const wchar_t* const _Last) noexcept {
-            using _Traits     = char_traits<wchar_t>;
-            const size_t _Off = _Traits::find(_First, _Last - _First, L"{%", 2);
+        template <class _Elem>
+        inline _Fmt_spec _Find_format_spec(const _Elem* const _First, const _Elem* const _Last) noexcept {
+            using _Traits     = char_traits<_Elem>;
+            const size_t _Off = _Traits::find(_First, _Last - _First, _Spec_prefix<_Elem>, 2);
             if (_Off == _Spec_not_found) { // definitely no format specifiers
                 return _Fmt_spec{};
             }
 
-            const wchar_t* _Spec_first = _First + _Off + 2; // skip '{%'
-            _Fmt_index _Idx;
+            const _Elem* _Spec_first = _First + _Off + 2; // skip '{%'
+            _Fmt_index<_Elem> _Idx;
             for (; _Spec_first != _Last; ++_Spec_first) {
-                if (*_Spec_first == L'}') { // end of the format specifier found
+                if (*_Spec_first == static_cast<_Elem>('}')) { // end of the format specifier found
                     if (_Idx._Digits > 0) {
                         break;
                     } else { // index must consist of at least one digit
@@ -100,7 +112,8 @@ namespace mjx {
             return _Fmt_spec{_Off, 3 + _Idx._Digits, _Chars_to_index(_Idx._Chars, _Idx._Digits)};
         }
 
-        inline size_t _Calculate_args_length(const format_args& _Args) noexcept {
+        template <class _Args_t>
+        inline size_t _Calculate_args_length(const _Args_t& _Args) noexcept {
             size_t _Length = 0;
             for (size_t _Idx = 0; _Idx < _Args.count(); ++_Idx) {
                 _Length += _Args.get(_Idx).size();
@@ -109,9 +122,185 @@ namespace mjx {
             return _Length;
         }
 
-        inline size_t _Estimate_formatted_string_length(const size_t _Fmt_size, const format_args& _Args) noexcept {
+        template <class _Args_t>
+        inline size_t _Estimate_formatted_string_length(const size_t _Fmt_size, const _Args_t& _Args) noexcept {
             return _Fmt_size + _Calculate_args_length(_Args);
         }
+
+        template <class _Elem>
+        inline bool _Is_formattable(const string_view<_Elem> _Fmt) noexcept {
+            // search for at least one valid format specifier
+            if (_Fmt.empty()) { // definitely not formattable
+                return false;
+            }
+
+            using _Traits            = char_traits<_Elem>;
+            const _Elem* _First      = _Fmt.data();
+            const _Elem* const _Last = _First + _Fmt.size();
+            size_t _Off;
+            while (_First < _Last) {
+                _Off = _Traits::find(_First, _Last - _First, _Spec_prefix<_Elem>, 2);
+                if (_Off == _Spec_not_found) { // definitely no format specifiers
+                    break;
+                }
+
+                _First += _Off + 2; // skip '{%'
+                if (_Is_valid_format_spec(_First, _Last)) { // valid format specifier found
+                    return true;
+                }
+            }
+
+            return false; // not formattable
+        }
+
+        template <class _Elem, class _Args_t>
+        inline string<_Elem> _Format_string(const string_view<_Elem> _Fmt, const _Args_t& _Args) {
+            string<_Elem> _Str;
+            _Str.reserve(_Estimate_formatted_string_length(_Fmt.size(), _Args));
+            const _Elem* _First      = _Fmt.data();
+            const _Elem* const _Last = _First + _Fmt.size();
+            _Fmt_spec _Spec;
+            for (;;) {
+                _Spec = _Find_format_spec(_First, _Last);
+                if (!_Spec._Found()) { // no more format specifiers, append the rest of the string and break
+                    _Str.append(_First, _Last - _First);
+                    break;
+                }
+
+                if (_Spec._Idx >= _Args.count()) { // requested argument not provided, break
+                    return string<_Elem>{};
+                }
+
+                _Str.append(_First, _Spec._Off); // append the substring that is before the format specifier
+                _Str.append(_Args.get(_Spec._Idx)); // append the requested argument
+                _First += _Spec._Off + _Spec._Len; // skip the format specifier
+            }
+
+            _Str.shrink_to_fit(); // free unused memory
+            return _Str;
+        }
+
+        template <class _Elem>
+        class _Scratch_buffer { // growable buffer, freed when destroyed unless its contents are detached
+        public:
+            explicit _Scratch_buffer(allocator& _Al) noexcept : _Myal(_Al), _Mydata(nullptr), _Mysize(0), _Mycap(0) {}
+
+            ~_Scratch_buffer() noexcept {
+                _Release();
+            }
+
+            _Scratch_buffer()                                  = delete;
+            _Scratch_buffer(const _Scratch_buffer&)            = delete;
+            _Scratch_buffer& operator=(const _Scratch_buffer&) = delete;
+
+            _Elem* _Data() const noexcept {
+                return _Mydata;
+            }
+
+            size_t _Size() const noexcept {
+                return _Mysize;
+            }
+
+            string_view<_Elem> _View() const noexcept {
+                return string_view<_Elem>{_Mydata, _Mysize};
+            }
+
+            _Elem* _Reserve(const size_t _New_capacity) {
+                // grows the buffer to hold at least _New_capacity elements, keeps the current contents
+                if (_New_capacity > _Mycap) {
+                    _Elem* const _New_data = static_cast<_Elem*>(_Myal.allocate(_New_capacity * sizeof(_Elem)));
+                    if (_Mysize > 0) {
+                        ::memcpy(_New_data, _Mydata, _Mysize * sizeof(_Elem));
+                    }
+
+                    _Release();
+                    _Mydata = _New_data;
+                    _Mycap  = _New_capacity;
+                }
+
+                return _Mydata;
+            }
+
+            void _Resize(const size_t _New_size) noexcept {
+                // assumes that _New_size is not greater than the capacity
+                _Mysize = _New_size;
+            }
+
+            string_view<_Elem> _Detach() noexcept {
+                // hands the contents over to the caller, meant for monotonic allocators that free them all at once
+                const string_view<_Elem> _Result{_Mydata, _Mysize};
+                _Mydata = nullptr;
+                _Mysize = 0;
+                _Mycap  = 0;
+                return _Result;
+            }
+
+            void _Append(const _Elem* const _Ptr, const size_t _Count) {
+                if (_Mysize + _Count > _Mycap) { // grow geometrically, arguments can be referenced repeatedly
+                    _Reserve(_Mysize + _Count > 2 * _Mycap ? _Mysize + _Count : 2 * _Mycap);
+                }
+
+                if (_Count > 0) {
+                    ::memcpy(_Mydata + _Mysize, _Ptr, _Count * sizeof(_Elem));
+                    _Mysize += _Count;
+                }
+            }
+
+        private:
+            void _Release() noexcept {
+                if (_Mydata) {
+                    _Myal.deallocate(_Mydata, _Mycap * sizeof(_Elem));
+                    _Mydata = nullptr;
+                }
+            }
+
+            allocator& _Myal;
+            _Elem* _Mydata;
+            size_t _Mysize;
+            size_t _Mycap;
+        };
+
+        template <class _Elem, class _Args_t>
+        inline bool _Format_to_buffer(
+            _Scratch_buffer<_Elem>& _Buf, const string_view<_Elem> _Fmt, const _Args_t& _Args) {
+            // same as _Format_string(), but assembles the message in _Buf, returns false if an argument is missing
+            _Buf._Reserve(_Estimate_formatted_string_length(_Fmt.size(), _Args));
+            const _Elem* _First      = _Fmt.data();
+            const _Elem* const _Last = _First + _Fmt.size();
+            _Fmt_spec _Spec;
+            for (;;) {
+                _Spec = _Find_format_spec(_First, _Last);
+                if (!_Spec._Found()) { // no more format specifiers, append the rest of the string and break
+                    _Buf._Append(_First, static_cast<size_t>(_Last - _First));
+                    return true;
+                }
+
+                if (_Spec._Idx >= _Args.count()) { // requested argument not provided, break
+                    return false;
+                }
+
+                const string_view<_Elem> _Arg = _Args.get(_Spec._Idx);
+                _Buf._Append(_First, _Spec._Off); // append the substring that is before the format specifier
+                _Buf._Append(_Arg.data(), _Arg.size()); // append the requested argument
+                _First += _Spec._Off + _Spec._Len; // skip the format specifier
+            }
+        }
+
+        template <class _Elem>
+        inline string_view<_Elem> _Copy_to_arena(format_arena& _Arena, const string_view<_Elem> _Str) {
+            // copies _Str into the arena, the copy is valid until the arena is released
+            _Scratch_buffer<_Elem> _Buf(_Arena);
+            _Buf._Append(_Str.data(), _Str.size());
+            return _Buf._Detach();
+        }
+
+        template <class _Elem, class _Args_t>
+        inline string_view<_Elem> _Format_in_arena(
+            format_arena& _Arena, const string_view<_Elem> _Fmt, const _Args_t& _Args) {
+            // formats the message in the arena, returns an empty view if an argument is missing
+            _Scratch_buffer<_Elem> _Buf(_Arena);
+            return _Format_to_buffer(_Buf, _Fmt, _Args) ? _Buf._Detach() : string_view<_Elem>{};
+        }
     } // namespace umls_impl
 } // namespace mjx
 
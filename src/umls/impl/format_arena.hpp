@@ -0,0 +1,106 @@
+// format_arena.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_FORMAT_ARENA_HPP_
+#define _UMLS_IMPL_FORMAT_ARENA_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjmem/allocator.hpp>
+#include <mjstr/char_traits.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        class _Format_arena_impl { // monotonic allocator that serves a single thread
+        public:
+            _Format_arena_impl(allocator& _Upstream, const size_t _Block_size)
+                : _Myupstream(_Upstream), _Myblock_size(_Block_size), _Myhead(nullptr), _Myused(0), _Myreserved(0) {
+                _Myhead = _Allocate_block(_Block_size, nullptr);
+            }
+
+            ~_Format_arena_impl() noexcept {
+                while (_Myhead) {
+                    _Myhead = _Free_block(_Myhead);
+                }
+            }
+
+            _Format_arena_impl()                                     = delete;
+            _Format_arena_impl(const _Format_arena_impl&)            = delete;
+            _Format_arena_impl& operator=(const _Format_arena_impl&) = delete;
+
+            size_t _Used() const noexcept {
+                return _Myused;
+            }
+
+            size_t _Reserved() const noexcept {
+                return _Myreserved;
+            }
+
+            void* _Allocate(const size_t _Size, const size_t _Align) {
+                size_t _Off = _Aligned_offset(_Myhead, _Align);
+                if (_Off + _Size > _Myhead->_Size) { // the current block is full, start a new one
+                    const size_t _New_size = _Size + _Align > _Myblock_size ? _Size + _Align : _Myblock_size;
+                    _Myhead                = _Allocate_block(_New_size, _Myhead);
+                    _Off                   = _Aligned_offset(_Myhead, _Align);
+                }
+
+                _Myhead->_Used = _Off + _Size;
+                _Myused       += _Size;
+                return _Myhead->_Data() + _Off;
+            }
+
+            void _Release() noexcept {
+                // keep only the oldest block, so that the next burst does not allocate again
+                while (_Myhead->_Next) {
+                    _Myhead = _Free_block(_Myhead);
+                }
+
+                _Myhead->_Used = 0;
+                _Myused        = 0;
+            }
+
+        private:
+            struct _Block { // a block header, followed by the block data
+                _Block* _Next;
+                size_t _Size;
+                size_t _Used;
+
+                byte_t* _Data() const noexcept {
+                    return reinterpret_cast<byte_t*>(const_cast<_Block*>(this) + 1);
+                }
+            };
+
+            static size_t _Aligned_offset(const _Block* const _Node, const size_t _Align) noexcept {
+                // the block header is not a multiple of every alignment, so align the address, not the offset
+                const uintptr_t _Base = reinterpret_cast<uintptr_t>(_Node->_Data());
+                return static_cast<size_t>(((_Base + _Node->_Used + _Align - 1) & ~(_Align - 1)) - _Base);
+            }
+
+            _Block* _Allocate_block(const size_t _Size, _Block* const _Next) {
+                _Block* const _New_block = static_cast<_Block*>(_Myupstream.allocate(sizeof(_Block) + _Size));
+                _New_block->_Next        = _Next;
+                _New_block->_Size        = _Size;
+                _New_block->_Used        = 0;
+                _Myreserved             += sizeof(_Block) + _Size;
+                return _New_block;
+            }
+
+            _Block* _Free_block(_Block* const _Old_block) noexcept {
+                _Block* const _Next = _Old_block->_Next;
+                _Myreserved        -= sizeof(_Block) + _Old_block->_Size;
+                _Myupstream.deallocate(_Old_block, sizeof(_Block) + _Old_block->_Size);
+                return _Next;
+            }
+
+            allocator& _Myupstream;
+            size_t _Myblock_size;
+            _Block* _Myhead; // most recently allocated block
+            size_t _Myused;
+            size_t _Myreserved;
+        };
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_FORMAT_ARENA_HPP_
\ No newline at end of file
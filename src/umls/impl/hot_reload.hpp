@@ -0,0 +1,257 @@
+// hot_reload.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_HOT_RELOAD_HPP_
+#define _UMLS_IMPL_HOT_RELOAD_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjfs/path.hpp>
+#include <mjmem/smart_pointer.hpp>
+#include <mjstr/char_traits.hpp>
+#include <mjstr/string_view.hpp>
+#include <mjsync/task.hpp>
+#include <mjsync/thread.hpp>
+#include <umls/impl/tinywin.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        enum class _Hot_reload_target : uint8_t {
+            _None     = 0,
+            _Settings = 1, // 'settings.uts' changed
+            _Catalogs = 2 // a file in the catalogs directory changed
+        };
+
+        inline _Hot_reload_target operator|(const _Hot_reload_target _Left, const _Hot_reload_target _Right) noexcept {
+            return static_cast<_Hot_reload_target>(static_cast<uint8_t>(_Left) | static_cast<uint8_t>(_Right));
+        }
+
+        inline bool _Has_hot_reload_target(
+            const _Hot_reload_target _Targets, const _Hot_reload_target _Target) noexcept {
+            return (static_cast<uint8_t>(_Targets) & static_cast<uint8_t>(_Target)) != 0;
+        }
+
+        class _Directory_watcher { // reports changes to the files in a single directory
+        public:
+            _Directory_watcher() noexcept : _Mydir(INVALID_HANDLE_VALUE), _Myoverlapped{}, _Mybuf{} {}
+
+            ~_Directory_watcher() noexcept {
+                _Close();
+            }
+
+            _Directory_watcher(const _Directory_watcher&)            = delete;
+            _Directory_watcher& operator=(const _Directory_watcher&) = delete;
+
+            bool _Is_open() const noexcept {
+                return _Mydir != INVALID_HANDLE_VALUE;
+            }
+
+            HANDLE _Event() const noexcept {
+                return _Myoverlapped.hEvent;
+            }
+
+            bool _Open(const path& _Dir) noexcept {
+                _Close(); // close the previous directory, if any
+                _Mydir = ::CreateFileW(_Dir.c_str(), FILE_LIST_DIRECTORY,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                    FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+                if (_Mydir == INVALID_HANDLE_VALUE) { // failed to open the directory, break
+                    return false;
+                }
+
+                _Myoverlapped.hEvent = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+                if (!_Myoverlapped.hEvent || !_Arm()) { // failed to start watching, break
+                    _Close();
+                    return false;
+                }
+
+                return true;
+            }
+
+            template <class _Fn>
+            bool _Drain(_Fn&& _Func) noexcept {
+                // invokes _Func with the name of every changed file and starts watching again
+                DWORD _Bytes = 0;
+                if (!::GetOverlappedResult(_Mydir, &_Myoverlapped, &_Bytes, FALSE)) {
+                    // Note: ERROR_NOTIFY_ENUM_DIR means that too many changes happened to be recorded,
+                    //       so any file might have changed, same as with an overflowed buffer.
+                    if (::GetLastError() == ERROR_NOTIFY_ENUM_DIR) {
+                        _Func(unicode_string_view{});
+                    }
+
+                    return _Arm(); // start again
+                }
+
+                if (_Bytes == 0) { // the buffer overflowed, any file might have changed
+                    _Func(unicode_string_view{});
+                } else {
+                    const byte_t* _Record = _Mybuf;
+                    for (;;) {
+                        const auto* const _Info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(_Record);
+                        _Func(unicode_string_view{_Info->FileName, _Info->FileNameLength / sizeof(wchar_t)});
+                        if (_Info->NextEntryOffset == 0) { // no more records, break
+                            break;
+                        }
+
+                        _Record += _Info->NextEntryOffset;
+                    }
+                }
+
+                return _Arm();
+            }
+
+            void _Close() noexcept {
+                if (_Mydir != INVALID_HANDLE_VALUE) {
+                    // Note: The pending read must complete before its buffer and event go away.
+                    DWORD _Bytes;
+                    if (::CancelIoEx(_Mydir, &_Myoverlapped) || ::GetLastError() != ERROR_NOT_FOUND) {
+                        ::GetOverlappedResult(_Mydir, &_Myoverlapped, &_Bytes, TRUE);
+                    }
+
+                    ::CloseHandle(_Mydir);
+                    _Mydir = INVALID_HANDLE_VALUE;
+                }
+
+                if (_Myoverlapped.hEvent) {
+                    ::CloseHandle(_Myoverlapped.hEvent);
+                    _Myoverlapped.hEvent = nullptr;
+                }
+            }
+
+        private:
+            static constexpr size_t _Buffer_size = 16384;
+
+            bool _Arm() noexcept {
+                ::ResetEvent(_Myoverlapped.hEvent);
+                return ::ReadDirectoryChangesW(_Mydir, _Mybuf, static_cast<DWORD>(_Buffer_size), FALSE,
+                    FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr,
+                    &_Myoverlapped, nullptr) != FALSE;
+            }
+
+            HANDLE _Mydir;
+            OVERLAPPED _Myoverlapped;
+            alignas(DWORD) byte_t _Mybuf[_Buffer_size]; // FILE_NOTIFY_INFORMATION records must be DWORD-aligned
+        };
+
+        class _Hot_reloader { // watches the settings file and the catalogs directory on a background thread
+        public:
+            using _Callback = void(*)(void*, _Hot_reload_target);
+
+            _Hot_reloader(const _Callback _Func, void* const _Arg) noexcept
+                : _Mystop(nullptr), _Mysettings(), _Mycatalogs(), _Mythread(), _Mytask(), _Myfunc(_Func),
+                _Myarg(_Arg) {}
+
+            ~_Hot_reloader() noexcept {
+                _Stop();
+            }
+
+            _Hot_reloader()                                = delete;
+            _Hot_reloader(const _Hot_reloader&)            = delete;
+            _Hot_reloader& operator=(const _Hot_reloader&) = delete;
+
+            bool _Start(const path& _Settings_dir, const path& _Catalogs_dir) {
+                _Mystop = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+                if (!_Mystop) { // failed to create the stop event, break
+                    return false;
+                }
+
+                // Note: The catalogs directory is optional, so the reloader still runs without it.
+                const bool _Watching_settings = _Mysettings._Open(_Settings_dir);
+                const bool _Watching_catalogs = _Mycatalogs._Open(_Catalogs_dir);
+                if (!_Watching_settings && !_Watching_catalogs) { // nothing to watch, break
+                    return false;
+                }
+
+                _Mythread = ::mjx::make_unique_smart_ptr<thread>();
+                _Mytask   = _Mythread->schedule_task(&_Hot_reloader::_Run, this, task_priority::below_normal);
+                return _Mytask.is_registered();
+            }
+
+            void _Stop() noexcept {
+                // Note: The thread is terminated with waiting, which returns at once if the process is
+                //       exiting and the thread is already gone.
+                if (_Mystop) {
+                    ::SetEvent(_Mystop);
+                }
+
+                if (_Mythread) {
+                    _Mythread->terminate(true);
+                    _Mythread.reset();
+                }
+
+                _Mysettings._Close();
+                _Mycatalogs._Close();
+                if (_Mystop) {
+                    ::CloseHandle(_Mystop);
+                    _Mystop = nullptr;
+                }
+            }
+
+        private:
+            static constexpr DWORD _Debounce_ms = 100;
+
+            static void _Run(void* const _Arg) noexcept {
+                static_cast<_Hot_reloader*>(_Arg)->_Watch();
+            }
+
+            _Hot_reload_target _Drain_changes(const HANDLE _Signaled) noexcept {
+                // Note: Only 'settings.uts' is of interest in its directory, other files are ignored.
+                _Hot_reload_target _Targets = _Hot_reload_target::_None;
+                if (_Signaled == _Mysettings._Event()) {
+                    _Mysettings._Drain([&_Targets](const unicode_string_view _Name) noexcept {
+                        if (_Name.empty() || _Name == L"settings.uts") {
+                            _Targets = _Targets | _Hot_reload_target::_Settings;
+                        }
+                    });
+                } else {
+                    _Mycatalogs._Drain([&_Targets](const unicode_string_view) noexcept {
+                        _Targets = _Targets | _Hot_reload_target::_Catalogs;
+                    });
+                }
+
+                return _Targets;
+            }
+
+            void _Watch() noexcept {
+                HANDLE _Handles[3];
+                DWORD _Count       = 0;
+                _Handles[_Count++] = _Mystop;
+                if (_Mysettings._Is_open()) {
+                    _Handles[_Count++] = _Mysettings._Event();
+                }
+
+                if (_Mycatalogs._Is_open()) {
+                    _Handles[_Count++] = _Mycatalogs._Event();
+                }
+
+                _Hot_reload_target _Pending = _Hot_reload_target::_None;
+                for (;;) {
+                    // Note: Editors usually write a file in several steps, so the reload is deferred until
+                    //       no change has been reported for _Debounce_ms.
+                    const DWORD _Timeout = _Pending == _Hot_reload_target::_None ? INFINITE : _Debounce_ms;
+                    const DWORD _Result  = ::WaitForMultipleObjects(_Count, _Handles, FALSE, _Timeout);
+                    if (_Result == WAIT_TIMEOUT) { // no more changes, reload
+                        _Myfunc(_Myarg, _Pending);
+                        _Pending = _Hot_reload_target::_None;
+                    } else if (_Result > WAIT_OBJECT_0 && _Result < WAIT_OBJECT_0 + _Count) {
+                        _Pending = _Pending | _Drain_changes(_Handles[_Result - WAIT_OBJECT_0]);
+                    } else { // stop requested or the wait failed, break
+                        break;
+                    }
+                }
+            }
+
+            HANDLE _Mystop;
+            _Directory_watcher _Mysettings;
+            _Directory_watcher _Mycatalogs;
+            unique_smart_ptr<thread> _Mythread;
+            task _Mytask;
+            _Callback _Myfunc;
+            void* _Myarg;
+        };
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_HOT_RELOAD_HPP_
\ No newline at end of file
@@ -0,0 +1,86 @@
+// mapped_file.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_MAPPED_FILE_HPP_
+#define _UMLS_IMPL_MAPPED_FILE_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjfs/file.hpp>
+#include <mjstr/char_traits.hpp>
+#include <umls/impl/tinywin.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        class _Mapped_file { // read-only view of an entire file
+        public:
+            _Mapped_file() noexcept : _Mymapping(nullptr), _Myview(nullptr), _Mysize(0) {}
+
+            ~_Mapped_file() noexcept {
+                _Unmap();
+            }
+
+            _Mapped_file(const _Mapped_file&)            = delete;
+            _Mapped_file& operator=(const _Mapped_file&) = delete;
+
+            bool _Is_mapped() const noexcept {
+                return _Myview != nullptr;
+            }
+
+            const byte_t* _Data() const noexcept {
+                return static_cast<const byte_t*>(_Myview);
+            }
+
+            size_t _Size() const noexcept {
+                return _Mysize;
+            }
+
+            bool _Map(const file& _File) noexcept {
+                _Unmap(); // unmap the previous file, if any
+                const uint64_t _File_size = _File.size();
+                if (_File_size == 0 || _File_size > static_cast<uint64_t>(static_cast<size_t>(-1))) {
+                    return false; // empty files cannot be mapped, and large ones won't fit in the address space
+                }
+
+                _Mymapping = ::CreateFileMappingW(_File.native_handle(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!_Mymapping) { // failed to create the mapping, break
+                    return false;
+                }
+
+                // Note: The view keeps the mapping object alive, and the mapping object keeps the file alive,
+                //       therefore the file can be closed as soon as this function returns.
+                _Myview = ::MapViewOfFile(_Mymapping, FILE_MAP_READ, 0, 0, 0);
+                if (!_Myview) { // failed to map the view, break
+                    ::CloseHandle(_Mymapping);
+                    _Mymapping = nullptr;
+                    return false;
+                }
+
+                _Mysize = static_cast<size_t>(_File_size);
+                return true;
+            }
+
+            void _Unmap() noexcept {
+                if (_Myview) {
+                    ::UnmapViewOfFile(_Myview);
+                    _Myview = nullptr;
+                    _Mysize = 0;
+                }
+
+                if (_Mymapping) {
+                    ::CloseHandle(_Mymapping);
+                    _Mymapping = nullptr;
+                }
+            }
+
+        private:
+            void* _Mymapping;
+            void* _Myview;
+            size_t _Mysize;
+        };
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_MAPPED_FILE_HPP_
\ No newline at end of file
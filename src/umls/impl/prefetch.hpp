@@ -0,0 +1,80 @@
+// prefetch.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_PREFETCH_HPP_
+#define _UMLS_IMPL_PREFETCH_HPP_
+#include <cstddef>
+#include <intrin.h>
+#include <mjstr/char_traits.hpp>
+#include <umls/impl/tinywin.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        inline constexpr size_t _Prefetch_page_size  = 4096;
+        inline constexpr size_t _Prefetch_line_size  = 64;
+        inline constexpr size_t _Prefetch_batch_size = 64;
+
+        class _Memory_prefetcher { // pages in and pre-touches memory ranges in batches
+        public:
+            _Memory_prefetcher() noexcept : _Myranges{}, _Mycount(0) {}
+
+            ~_Memory_prefetcher() noexcept {
+                _Flush();
+            }
+
+            _Memory_prefetcher(const _Memory_prefetcher&)            = delete;
+            _Memory_prefetcher& operator=(const _Memory_prefetcher&) = delete;
+
+            void _Add(const void* const _Data, const size_t _Size) noexcept {
+                if (_Size == 0) { // nothing to prefetch, break
+                    return;
+                }
+
+                WIN32_MEMORY_RANGE_ENTRY& _Range = _Myranges[_Mycount++];
+                _Range.VirtualAddress            = const_cast<void*>(_Data);
+                _Range.NumberOfBytes             = _Size;
+                if (_Mycount == _Prefetch_batch_size) { // batch is full, flush it
+                    _Flush();
+                }
+            }
+
+            void _Flush() noexcept {
+                if (_Mycount == 0) { // nothing to flush, break
+                    return;
+                }
+
+                // Note: PrefetchVirtualMemory() is only a hint that lets the memory manager read the pages
+                //       of a mapped catalog in large I/O requests. It is ignored for resident pages, therefore
+                //       the ranges are touched afterwards regardless of whether it succeeded.
+                ::PrefetchVirtualMemory(::GetCurrentProcess(), _Mycount, _Myranges, 0);
+                for (size_t _Idx = 0; _Idx < _Mycount; ++_Idx) {
+                    _Touch(static_cast<const byte_t*>(_Myranges[_Idx].VirtualAddress), _Myranges[_Idx].NumberOfBytes);
+                }
+
+                _Mycount = 0;
+            }
+
+        private:
+            static void _Touch(const byte_t* const _Data, const size_t _Size) noexcept {
+                // read one byte per page to fault it in, then prefetch every cache line of the range
+                const volatile byte_t* const _Bytes = _Data;
+                for (size_t _Off = 0; _Off < _Size; _Off += _Prefetch_page_size) {
+                    (void) _Bytes[_Off];
+                }
+
+                (void) _Bytes[_Size - 1]; // the last byte might be on a page that was skipped above
+                for (size_t _Off = 0; _Off < _Size; _Off += _Prefetch_line_size) {
+                    _mm_prefetch(reinterpret_cast<const char*>(_Data + _Off), _MM_HINT_T0);
+                }
+            }
+
+            WIN32_MEMORY_RANGE_ENTRY _Myranges[_Prefetch_batch_size];
+            size_t _Mycount;
+        };
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_PREFETCH_HPP_
\ No newline at end of file
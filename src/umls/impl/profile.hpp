@@ -0,0 +1,27 @@
+// profile.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_PROFILE_HPP_
+#define _UMLS_IMPL_PROFILE_HPP_
+#include <atomic>
+#include <cstdint>
+
+namespace mjx {
+    namespace umls_impl {
+        inline ::std::atomic<bool> _Profiling_enabled = false;
+
+        // records a single access to the message with the specified hash
+        void _Record_message_access(const uint64_t _Hash) noexcept;
+
+        inline void _Profile_message_access(const uint64_t _Hash) noexcept {
+            if (_Profiling_enabled.load(::std::memory_order_relaxed)) {
+                _Record_message_access(_Hash);
+            }
+        }
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_PROFILE_HPP_
\ No newline at end of file
@@ -0,0 +1,111 @@
+// statistics.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_STATISTICS_HPP_
+#define _UMLS_IMPL_STATISTICS_HPP_
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mjstr/string_view.hpp>
+#include <umls/statistics.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        inline ::std::atomic<bool> _Statistics_enabled = false;
+
+        // only every N-th miss is recorded in the count-min sketch to keep the hot path cheap
+        inline constexpr uint32_t _Missing_message_sampling_rate = 16;
+
+        // Note: Each thread updates its own counters on every lookup, while reset_catalog_statistics() clears
+        //       them from any thread. The counters start on their own cache line, so that the updates
+        //       of one thread do not invalidate the counters of another.
+        struct alignas(64) _Thread_counters { // statistics of a single thread
+            ::std::atomic<uint64_t> _Lookups            = 0;
+            ::std::atomic<uint64_t> _Hits               = 0;
+            ::std::atomic<uint64_t> _Formatted_messages = 0;
+            ::std::atomic<uint64_t> _Plain_messages     = 0;
+            ::std::atomic<uint64_t> _Transcoded_bytes   = 0;
+            ::std::atomic<uint64_t> _Latency_histogram[catalog_statistics::latency_bucket_count] = {};
+            uint32_t _Misses_until_sample = 0; // used only by the owning thread
+
+            void _Increment(::std::atomic<uint64_t>& _Counter, const uint64_t _Value = 1) noexcept {
+                // Note: The owning thread is the only writer, but reset_catalog_statistics() may clear
+                //       the counters from another thread, so the update must be a single read-modify-write.
+                _Counter.fetch_add(_Value, ::std::memory_order_relaxed);
+            }
+        };
+
+        // returns the counters of the calling thread, registers them on first use
+        _Thread_counters& _Get_thread_counters();
+
+        // records a sampled miss in the count-min sketch
+        void _Record_missing_message(const uint64_t _Hash, const utf8_string_view _Id) noexcept;
+
+        class _Lookup_recorder { // records a single message lookup, if statistics are enabled
+        public:
+            explicit _Lookup_recorder(const utf8_string_view _Id)
+                : _Mycounters(nullptr), _Myid(_Id), _Myhash(0), _Mystart(), _Myhit(false) {
+                if (_Statistics_enabled.load(::std::memory_order_relaxed)) { // statistics enabled, start measuring
+                    _Mycounters = &_Get_thread_counters();
+                    _Mystart    = _Clock::now();
+                }
+            }
+
+            ~_Lookup_recorder() noexcept {
+                if (_Mycounters) {
+                    _Record();
+                }
+            }
+
+            _Lookup_recorder()                                   = delete;
+            _Lookup_recorder(const _Lookup_recorder&)            = delete;
+            _Lookup_recorder& operator=(const _Lookup_recorder&) = delete;
+
+            void _Set_hash(const uint64_t _Hash) noexcept {
+                _Myhash = _Hash;
+            }
+
+            void _Hit(const size_t _Bytes, const bool _Formatted) noexcept {
+                if (_Mycounters) {
+                    _Myhit = true;
+                    _Mycounters->_Increment(_Mycounters->_Transcoded_bytes, _Bytes);
+                    _Mycounters->_Increment(
+                        _Formatted ? _Mycounters->_Formatted_messages : _Mycounters->_Plain_messages);
+                }
+            }
+
+        private:
+            using _Clock = ::std::chrono::steady_clock;
+
+            void _Record() noexcept {
+                const uint64_t _Elapsed = static_cast<uint64_t>(
+                    ::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Clock::now() - _Mystart).count());
+                constexpr size_t _Max_bucket = catalog_statistics::latency_bucket_count - 1;
+                const size_t _Bucket         = (::std::min)(static_cast<size_t>(::std::bit_width(_Elapsed)),
+                    _Max_bucket);
+                _Mycounters->_Increment(_Mycounters->_Latency_histogram[_Bucket]);
+                _Mycounters->_Increment(_Mycounters->_Lookups);
+                if (_Myhit) {
+                    _Mycounters->_Increment(_Mycounters->_Hits);
+                } else if (_Mycounters->_Misses_until_sample-- == 0) { // sample this miss
+                    _Mycounters->_Misses_until_sample = _Missing_message_sampling_rate - 1;
+                    _Record_missing_message(_Myhash, _Myid);
+                }
+            }
+
+            _Thread_counters* _Mycounters;
+            utf8_string_view _Myid;
+            uint64_t _Myhash;
+            _Clock::time_point _Mystart;
+            bool _Myhit;
+        };
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_STATISTICS_HPP_
\ No newline at end of file
@@ -0,0 +1,201 @@
+// trace.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_TRACE_HPP_
+#define _UMLS_IMPL_TRACE_HPP_
+#ifdef UMLS_ENABLE_TRACING
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mjfs/path.hpp>
+#include <mjmem/object_allocator.hpp>
+#include <mjmem/smart_pointer.hpp>
+#include <mjstr/string.hpp>
+#include <mjsync/srwlock.hpp>
+#include <umls/impl/file_writer.hpp>
+#include <vector>
+
+namespace mjx {
+    namespace umls_impl {
+        using _Trace_clock = ::std::chrono::steady_clock;
+
+        struct _Trace_event {
+            const char* _Name = nullptr; // must be a string literal
+            int64_t _Start    = 0; // in nanoseconds, relative to the registry epoch
+            int64_t _Duration = 0; // in nanoseconds
+        };
+
+        class _Trace_ring { // stores the most recent events of a single thread
+        public:
+            static constexpr size_t _Capacity = 4096;
+
+            explicit _Trace_ring(const uint32_t _Thread_id) noexcept
+                : _Myevents(), _Myhead(0), _Mythread_id(_Thread_id) {}
+
+            ~_Trace_ring() noexcept {}
+
+            _Trace_ring(const _Trace_ring&)            = delete;
+            _Trace_ring& operator=(const _Trace_ring&) = delete;
+
+            uint32_t _Thread_id() const noexcept {
+                return _Mythread_id;
+            }
+
+            void _Push(const _Trace_event& _Event) noexcept {
+                // only the owning thread pushes, so the head can be published without a lock
+                const uint64_t _Head         = _Myhead.load(::std::memory_order_relaxed);
+                _Myevents[_Head % _Capacity] = _Event;
+                _Myhead.store(_Head + 1, ::std::memory_order_release);
+            }
+
+            template <class _Fn>
+            void _For_each(_Fn&& _Func) const {
+                // Note: The oldest events may be overwritten while they are being read if the owning
+                //       thread is still tracing. Dump the events once the traced work is done.
+                const uint64_t _Head  = _Myhead.load(::std::memory_order_acquire);
+                const uint64_t _First = _Head > _Capacity ? _Head - _Capacity : 0;
+                for (uint64_t _Idx = _First; _Idx < _Head; ++_Idx) {
+                    _Func(_Myevents[_Idx % _Capacity]);
+                }
+            }
+
+        private:
+            _Trace_event _Myevents[_Capacity];
+            ::std::atomic<uint64_t> _Myhead;
+            uint32_t _Mythread_id;
+        };
+
+        class _Trace_registry { // owns the rings of all threads that have recorded any event
+        public:
+            ~_Trace_registry() noexcept {}
+
+            _Trace_registry(const _Trace_registry&)            = delete;
+            _Trace_registry& operator=(const _Trace_registry&) = delete;
+
+            static _Trace_registry& _Global() noexcept {
+                static _Trace_registry _Registry;
+                return _Registry;
+            }
+
+            int64_t _Now() const noexcept {
+                return ::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Trace_clock::now() - _Myepoch).count();
+            }
+
+            _Trace_ring& _Register() {
+                lock_guard _Guard(_Mylock);
+                _Myrings.push_back(::mjx::make_unique_smart_ptr<_Trace_ring>(static_cast<uint32_t>(_Myrings.size())));
+                return *_Myrings.back();
+            }
+
+            template <class _Fn>
+            void _For_each(_Fn&& _Func) const {
+                shared_lock_guard _Guard(_Mylock);
+                for (const unique_smart_ptr<_Trace_ring>& _Ring : _Myrings) {
+                    _Ring->_For_each([&](const _Trace_event& _Event) { _Func(*_Ring, _Event); });
+                }
+            }
+
+        private:
+            _Trace_registry() noexcept : _Myepoch(_Trace_clock::now()), _Mylock(), _Myrings() {}
+
+            _Trace_clock::time_point _Myepoch;
+            mutable shared_lock _Mylock;
+            ::std::vector<unique_smart_ptr<_Trace_ring>, object_allocator<unique_smart_ptr<_Trace_ring>>> _Myrings;
+        };
+
+        inline _Trace_ring* _Get_trace_ring() noexcept {
+            // Note: DllMain() disables thread notifications, so thread-local destructors cannot be relied on.
+            //       The rings are owned by the registry and outlive their threads.
+            thread_local _Trace_ring* _Ring = nullptr;
+            if (!_Ring) { // first event on this thread, register its ring
+                try {
+                    _Ring = &_Trace_registry::_Global()._Register();
+                } catch (...) { // failed to register the ring, drop the event
+                    return nullptr;
+                }
+            }
+
+            return _Ring;
+        }
+
+        class _Trace_span { // records a single complete event, from construction to destruction
+        public:
+            explicit _Trace_span(const char* const _Name) noexcept
+                : _Myname(_Name), _Mystart(_Trace_registry::_Global()._Now()) {}
+
+            ~_Trace_span() noexcept {
+                _Trace_ring* const _Ring = _Get_trace_ring();
+                if (_Ring) {
+                    _Ring->_Push(_Trace_event{_Myname, _Mystart, _Trace_registry::_Global()._Now() - _Mystart});
+                }
+            }
+
+            _Trace_span()                              = delete;
+            _Trace_span(const _Trace_span&)            = delete;
+            _Trace_span& operator=(const _Trace_span&) = delete;
+
+        private:
+            const char* _Myname;
+            int64_t _Mystart;
+        };
+
+        inline void _Append_trace_integer(utf8_string& _Str, uint64_t _Value) {
+            char _Buf[20];
+            size_t _Off = sizeof(_Buf);
+            do {
+                _Buf[--_Off] = static_cast<char>('0' + _Value % 10);
+                _Value      /= 10;
+            } while (_Value > 0);
+
+            _Str.append(_Buf + _Off, sizeof(_Buf) - _Off);
+        }
+
+        inline void _Append_trace_microseconds(utf8_string& _Str, const int64_t _Nanoseconds) {
+            // Chrome expects microseconds, keep the nanosecond precision as a fraction
+            const uint64_t _Value = _Nanoseconds > 0 ? static_cast<uint64_t>(_Nanoseconds) : 0;
+            _Append_trace_integer(_Str, _Value / 1000);
+            _Str.push_back('.');
+            const uint64_t _Fraction = _Value % 1000;
+            _Str.append(_Fraction < 10 ? "00" : _Fraction < 100 ? "0" : "");
+            _Append_trace_integer(_Str, _Fraction);
+        }
+
+        inline bool _Write_trace_events(const path& _Target) {
+            // writes the events in the Chrome trace event format, which is also understood by Perfetto
+            utf8_string _Json("{\"traceEvents\":[");
+            bool _First = true;
+            _Trace_registry::_Global()._For_each([&](const _Trace_ring& _Ring, const _Trace_event& _Event) {
+                _Json.append(_First ? "\n" : ",\n");
+                _Json.append("{\"name\":\"");
+                _Json.append(_Event._Name); // string literal, no escaping needed
+                _Json.append("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+                _Append_trace_integer(_Json, _Ring._Thread_id());
+                _Json.append(",\"ts\":");
+                _Append_trace_microseconds(_Json, _Event._Start);
+                _Json.append(",\"dur\":");
+                _Append_trace_microseconds(_Json, _Event._Duration);
+                _Json.push_back('}');
+                _First = false;
+            });
+            _Json.append("\n]}\n");
+
+            return _Write_whole_file(
+                _Target, byte_string_view{reinterpret_cast<const byte_t*>(_Json.data()), _Json.size()});
+        }
+    } // namespace umls_impl
+} // namespace mjx
+
+#define _UMLS_TRACE_CONCAT_IMPL(_Left, _Right) _Left##_Right
+#define _UMLS_TRACE_CONCAT(_Left, _Right)      _UMLS_TRACE_CONCAT_IMPL(_Left, _Right)
+
+// records the time spent between this point and the end of the enclosing scope
+#define _UMLS_TRACE_SPAN(_Name) \
+    const ::mjx::umls_impl::_Trace_span _UMLS_TRACE_CONCAT(_Trace_span_, __LINE__)(_Name)
+#else // ^^^ UMLS_ENABLE_TRACING ^^^ / vvv !UMLS_ENABLE_TRACING vvv
+#define _UMLS_TRACE_SPAN(_Name)
+#endif // UMLS_ENABLE_TRACING
+#endif // _UMLS_IMPL_TRACE_HPP_
\ No newline at end of file
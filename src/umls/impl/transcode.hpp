@@ -0,0 +1,305 @@
+// transcode.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_TRANSCODE_HPP_
+#define _UMLS_IMPL_TRANSCODE_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <intrin.h>
+#include <mjstr/char_traits.hpp>
+#include <mjstr/string.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        inline constexpr size_t _Invalid_utf8 = static_cast<size_t>(-1);
+
+        enum class _Simd_level : unsigned char {
+            _None,
+            _Sse2,
+            _Avx2
+        };
+
+        inline _Simd_level _Detect_simd_level() noexcept {
+            int _Regs[4];
+            __cpuid(_Regs, 0);
+            const int _Max_leaf = _Regs[0];
+            __cpuid(_Regs, 1);
+            const bool _Has_sse2    = (_Regs[3] & (1 << 26)) != 0;
+            const bool _Has_osxsave = (_Regs[2] & (1 << 27)) != 0;
+            const bool _Has_avx     = (_Regs[2] & (1 << 28)) != 0;
+            if (_Max_leaf >= 7 && _Has_osxsave && _Has_avx && (_xgetbv(0) & 0x6) == 0x6) {
+                // the OS saves the YMM registers, AVX2 can be used if supported
+                __cpuidex(_Regs, 7, 0);
+                if ((_Regs[1] & (1 << 5)) != 0) {
+                    return _Simd_level::_Avx2;
+                }
+            }
+
+            return _Has_sse2 ? _Simd_level::_Sse2 : _Simd_level::_None;
+        }
+
+        inline const _Simd_level _Active_simd_level = _Detect_simd_level();
+
+        template <class _Elem>
+        inline void _Store_widened_sse2(_Elem* const _Dest, const __m128i _Bytes) noexcept {
+            // widens 16 ASCII bytes to 16 code units
+            const __m128i _Zero = _mm_setzero_si128();
+            const __m128i _Lo   = _mm_unpacklo_epi8(_Bytes, _Zero);
+            const __m128i _Hi   = _mm_unpackhi_epi8(_Bytes, _Zero);
+            if constexpr (sizeof(_Elem) == 2) { // UTF-16
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(_Dest), _Lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(_Dest + 8), _Hi);
+            } else { // UTF-32
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(_Dest), _mm_unpacklo_epi16(_Lo, _Zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(_Dest + 4), _mm_unpackhi_epi16(_Lo, _Zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(_Dest + 8), _mm_unpacklo_epi16(_Hi, _Zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(_Dest + 12), _mm_unpackhi_epi16(_Hi, _Zero));
+            }
+        }
+
+        template <class _Elem>
+        inline size_t _Widen_ascii_sse2(const byte_t* const _Src, const size_t _Size, _Elem* const _Dest) noexcept {
+            // widens the leading ASCII bytes, 16 at a time, returns the number of widened bytes
+            size_t _Off = 0;
+            for (; _Off + 16 <= _Size; _Off += 16) {
+                const __m128i _Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_Src + _Off));
+                if (_mm_movemask_epi8(_Bytes) != 0) { // non-ASCII byte found, break
+                    break;
+                }
+
+                _Store_widened_sse2(_Dest + _Off, _Bytes);
+            }
+
+            return _Off;
+        }
+
+        template <class _Elem>
+        inline size_t _Widen_ascii_avx2(const byte_t* const _Src, const size_t _Size, _Elem* const _Dest) noexcept {
+            // widens the leading ASCII bytes, 32 at a time, returns the number of widened bytes
+            size_t _Off = 0;
+            for (; _Off + 32 <= _Size; _Off += 32) {
+                const __m256i _Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_Src + _Off));
+                if (_mm256_movemask_epi8(_Bytes) != 0) { // non-ASCII byte found, break
+                    break;
+                }
+
+                const __m128i _Lo = _mm256_castsi256_si128(_Bytes);
+                const __m128i _Hi = _mm256_extracti128_si256(_Bytes, 1);
+                __m256i* const _Out = reinterpret_cast<__m256i*>(_Dest + _Off);
+                if constexpr (sizeof(_Elem) == 2) { // UTF-16
+                    _mm256_storeu_si256(_Out, _mm256_cvtepu8_epi16(_Lo));
+                    _mm256_storeu_si256(_Out + 1, _mm256_cvtepu8_epi16(_Hi));
+                } else { // UTF-32
+                    _mm256_storeu_si256(_Out, _mm256_cvtepu8_epi32(_Lo));
+                    _mm256_storeu_si256(_Out + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(_Lo, 8)));
+                    _mm256_storeu_si256(_Out + 2, _mm256_cvtepu8_epi32(_Hi));
+                    _mm256_storeu_si256(_Out + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(_Hi, 8)));
+                }
+            }
+
+            return _Off + _Widen_ascii_sse2(_Src + _Off, _Size - _Off, _Dest + _Off);
+        }
+
+        inline size_t _Skip_ascii_sse2(const byte_t* const _Src, const size_t _Size) noexcept {
+            // returns the number of leading ASCII bytes, counted 16 at a time
+            size_t _Off = 0;
+            for (; _Off + 16 <= _Size; _Off += 16) {
+                if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_Src + _Off))) != 0) {
+                    break;
+                }
+            }
+
+            return _Off;
+        }
+
+        inline size_t _Skip_ascii_avx2(const byte_t* const _Src, const size_t _Size) noexcept {
+            // returns the number of leading ASCII bytes, counted 32 at a time
+            size_t _Off = 0;
+            for (; _Off + 32 <= _Size; _Off += 32) {
+                if (_mm256_movemask_epi8(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_Src + _Off))) != 0) {
+                    break;
+                }
+            }
+
+            return _Off + _Skip_ascii_sse2(_Src + _Off, _Size - _Off);
+        }
+
+        template <class _Elem>
+        inline size_t _Widen_ascii(const byte_t* const _Src, const size_t _Size, _Elem* const _Dest) noexcept {
+            switch (_Active_simd_level) {
+            case _Simd_level::_Avx2:
+                return _Widen_ascii_avx2(_Src, _Size, _Dest);
+            case _Simd_level::_Sse2:
+                return _Widen_ascii_sse2(_Src, _Size, _Dest);
+            default:
+                return 0; // no SIMD support, let the scalar loop handle it
+            }
+        }
+
+        inline size_t _Skip_ascii(const byte_t* const _Src, const size_t _Size) noexcept {
+            switch (_Active_simd_level) {
+            case _Simd_level::_Avx2:
+                return _Skip_ascii_avx2(_Src, _Size);
+            case _Simd_level::_Sse2:
+                return _Skip_ascii_sse2(_Src, _Size);
+            default:
+                return 0; // no SIMD support, let the scalar loop handle it
+            }
+        }
+
+        inline size_t _Utf8_sequence_length(const byte_t _Lead) noexcept {
+            if (_Lead < 0x80) {
+                return 1;
+            } else if (_Lead < 0xC2) { // continuation byte or overlong 2-byte sequence
+                return 0;
+            } else if (_Lead < 0xE0) {
+                return 2;
+            } else if (_Lead < 0xF0) {
+                return 3;
+            } else if (_Lead < 0xF5) {
+                return 4;
+            } else { // beyond U+10FFFF
+                return 0;
+            }
+        }
+
+        inline bool _Is_continuation_byte(const byte_t _Byte) noexcept {
+            return (_Byte & 0xC0) == 0x80;
+        }
+
+        template <bool _Validated>
+        inline bool _Decode_utf8_sequence(
+            const byte_t* const _Src, const size_t _Avail, size_t& _Len, uint32_t& _Code_point) noexcept {
+            // Note: Validated text has already been checked, so only the bounds are verified.
+            //       Unvalidated text is checked against overlong forms, surrogates and code points
+            //       beyond U+10FFFF, which are all rejected.
+            const byte_t _Lead = _Src[0];
+            _Len               = _Utf8_sequence_length(_Lead);
+            if (_Len == 0 || _Len > _Avail) { // invalid lead byte or truncated sequence, break
+                return false;
+            }
+
+            switch (_Len) {
+            case 2:
+                _Code_point = (static_cast<uint32_t>(_Lead & 0x1F) << 6) | (_Src[1] & 0x3F);
+                if constexpr (!_Validated) {
+                    return _Is_continuation_byte(_Src[1]);
+                }
+
+                return true;
+            case 3:
+                _Code_point = (static_cast<uint32_t>(_Lead & 0x0F) << 12)
+                            | (static_cast<uint32_t>(_Src[1] & 0x3F) << 6) | (_Src[2] & 0x3F);
+                if constexpr (!_Validated) {
+                    return _Is_continuation_byte(_Src[1]) && _Is_continuation_byte(_Src[2])
+                        && _Code_point >= 0x800 && (_Code_point < 0xD800 || _Code_point > 0xDFFF);
+                }
+
+                return true;
+            case 4:
+                _Code_point = (static_cast<uint32_t>(_Lead & 0x07) << 18)
+                            | (static_cast<uint32_t>(_Src[1] & 0x3F) << 12)
+                            | (static_cast<uint32_t>(_Src[2] & 0x3F) << 6) | (_Src[3] & 0x3F);
+                if constexpr (!_Validated) {
+                    return _Is_continuation_byte(_Src[1]) && _Is_continuation_byte(_Src[2])
+                        && _Is_continuation_byte(_Src[3]) && _Code_point >= 0x10000 && _Code_point <= 0x10FFFF;
+                }
+
+                return true;
+            default:
+                _Code_point = _Lead;
+                return true;
+            }
+        }
+
+        template <bool _Validated, class _Elem>
+        inline size_t _Transcode_utf8(const byte_t* const _Src, const size_t _Size, _Elem* const _Dest) noexcept {
+            // decodes UTF-8 to UTF-16 or UTF-32 (depending on the element size), returns the number of
+            // written code units or _Invalid_utf8 if the text is malformed
+            const byte_t* _First      = _Src;
+            const byte_t* const _Last = _Src + _Size;
+            _Elem* _Out               = _Dest;
+            size_t _Len;
+            uint32_t _Code_point;
+            while (_First != _Last) {
+                if (*_First < 0x80) { // ASCII, try to widen a whole run at once
+                    const size_t _Count = _Widen_ascii(_First, static_cast<size_t>(_Last - _First), _Out);
+                    if (_Count > 0) {
+                        _First += _Count;
+                        _Out   += _Count;
+                        continue;
+                    }
+
+                    *_Out++ = static_cast<_Elem>(*_First++);
+                    continue;
+                }
+
+                if (!_Decode_utf8_sequence<_Validated>(
+                    _First, static_cast<size_t>(_Last - _First), _Len, _Code_point)) { // malformed text, break
+                    return _Invalid_utf8;
+                }
+
+                if constexpr (sizeof(_Elem) == 2) { // UTF-16, code points beyond the BMP need a surrogate pair
+                    if (_Code_point >= 0x10000) {
+                        _Code_point -= 0x10000;
+                        *_Out++      = static_cast<_Elem>(0xD800 + (_Code_point >> 10));
+                        *_Out++      = static_cast<_Elem>(0xDC00 + (_Code_point & 0x3FF));
+                    } else {
+                        *_Out++ = static_cast<_Elem>(_Code_point);
+                    }
+                } else { // UTF-32
+                    *_Out++ = static_cast<_Elem>(_Code_point);
+                }
+
+                _First += _Len;
+            }
+
+            return static_cast<size_t>(_Out - _Dest);
+        }
+
+        inline bool _Validate_utf8(const byte_t* const _Src, const size_t _Size) noexcept {
+            const byte_t* _First      = _Src;
+            const byte_t* const _Last = _Src + _Size;
+            size_t _Len;
+            uint32_t _Code_point;
+            while (_First != _Last) {
+                if (*_First < 0x80) { // ASCII, try to skip a whole run at once
+                    const size_t _Count = _Skip_ascii(_First, static_cast<size_t>(_Last - _First));
+                    _First             += _Count > 0 ? _Count : 1;
+                    continue;
+                }
+
+                if (!_Decode_utf8_sequence<false>(_First, static_cast<size_t>(_Last - _First), _Len, _Code_point)) {
+                    return false;
+                }
+
+                _First += _Len;
+            }
+
+            return true;
+        }
+
+        inline bool _Transcode_utf8_to_unicode(
+            unicode_string& _Str, const byte_t* const _Src, const size_t _Size, const bool _Validated) {
+            // Note: Each code unit is produced by at least one byte, so the input size is an upper bound
+            //       for the output size. The string is sized once and trimmed afterwards, which replaces
+            //       the separate length pass.
+            _Str.resize(_Size);
+            const size_t _Count = _Validated ? _Transcode_utf8<true>(_Src, _Size, _Str.data())
+                                             : _Transcode_utf8<false>(_Src, _Size, _Str.data());
+            if (_Count == _Invalid_utf8) { // malformed text, break
+                _Str.clear();
+                return false;
+            }
+
+            _Str.resize(_Count);
+            return true;
+        }
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_TRANSCODE_HPP_
\ No newline at end of file
@@ -10,12 +10,15 @@
 #include <mjfs/path.hpp>
 #include <mjmem/smart_pointer.hpp>
 #include <mjstr/conversion.hpp>
+#include <umls/impl/uts_index.hpp>
 #include <umls/translator.hpp>
 
 namespace mjx {
     namespace umls_impl {
         inline constexpr size_t _Uts_signature_size                 = 4;
         inline constexpr byte_t _Uts_signature[_Uts_signature_size] = {'U', 'T', 'S', '\0'};
+        inline constexpr uint8_t _Uts_legacy_version                = 0; // stored in the last signature byte
+        inline constexpr uint8_t _Uts_indexed_version               = 2;
 
 #pragma pack(push)
 #pragma pack(2) // align to 2-byte boundaries to maintain a total structure size of 14 bytes
@@ -25,12 +28,30 @@ namespace mjx {
             uint32_t _Preferred_lcid;
             uint16_t _Catalog_count;
         };
+
+        // Note: Version 2 files store 0 in the 2-byte catalog count of the static data, followed by
+        //       the indexed data and the lookup tables described in <impl/uts_index.hpp>.
+        struct _Uts_indexed_data {
+            uint16_t _Reserved;
+            uint32_t _Catalog_count;
+            uint32_t _Slot_count;
+            uint32_t _String_table_size;
+        };
 #pragma pack(pop)
 
         inline bool _Verify_uts_signature(const _Uts_static_data& _Data) noexcept {
-            // compare the stored signature with the original
+            // compare the stored signature with the original, the last byte is the format version
             using _Traits = char_traits<byte_t>;
-            return _Traits::eq(_Data._Signature, _Uts_signature, _Uts_signature_size);
+            if (!_Traits::eq(_Data._Signature, _Uts_signature, _Uts_signature_size - 1)) {
+                return false;
+            }
+
+            const uint8_t _Version = _Data._Signature[_Uts_signature_size - 1];
+            return _Version == _Uts_legacy_version || _Version == _Uts_indexed_version;
+        }
+
+        inline uint8_t _Uts_version(const _Uts_static_data& _Data) noexcept {
+            return _Data._Signature[_Uts_signature_size - 1];
         }
 
         template <class _Integer>
@@ -52,6 +73,38 @@ namespace mjx {
                 return _Mystream.read_exactly(reinterpret_cast<byte_t*>(&_Data), sizeof(_Uts_static_data));
             }
 
+            bool _Load_indexed_data(_Uts_indexed_data& _Data) noexcept {
+                // load fixed-size data that follows the static data in version 2 files
+                static_assert(sizeof(_Uts_indexed_data) == 14, "_Uts_indexed_data's size must be 14 bytes");
+                return _Mystream.read_exactly(reinterpret_cast<byte_t*>(&_Data), sizeof(_Uts_indexed_data));
+            }
+
+            bool _Load_tables(_Uts_catalog_index& _Index, const _Uts_indexed_data& _Data) {
+                // load the lookup tables in a single read, the names are converted only when requested
+                size_t _Size;
+                if (!_Uts_tables_size(_Data._Catalog_count, _Data._Slot_count, _Data._String_table_size, _Size)) {
+                    return false; // the tables would not fit in memory
+                }
+
+                const file_stream::pos_type _Pos = _Mystream.tell();
+                if (!_Mystream.seek_to_end()) {
+                    return false;
+                }
+
+                const file_stream::pos_type _End = _Mystream.tell();
+                if (!_Mystream.seek(_Pos) || _End < _Pos || _End - _Pos < _Size) { // truncated tables, break
+                    return false;
+                }
+
+                byte_string _Tables(_Size, byte_t{0});
+                if (!_Mystream.read_exactly(_Tables.data(), _Size)) { // corrupted data or something went wrong
+                    return false;
+                }
+
+                return _Index._Assign(
+                    ::std::move(_Tables), _Data._Catalog_count, _Data._Slot_count, _Data._String_table_size);
+            }
+
             bool _Load_catalogs(translator_catalogs& _Catalogs, const size_t _Count) {
                 // load _Count fixed-size catalogs from the file
                 constexpr size_t _Catalog_name_size = 64;
@@ -91,9 +144,9 @@ namespace mjx {
             using reference         = const value_type&;
             using iterator_category = ::std::forward_iterator_tag;
 
-            explicit _Translator_init_lcids_iterator(const translator_settings& _Settings) noexcept
+            _Translator_init_lcids_iterator(const uint32_t _Preferred_lcid, const uint32_t _Default_lcid) noexcept
                 : _Myelems{0}, _Mycount(0), _Myoff(0) {
-                _Init(_Settings);
+                _Init(_Preferred_lcid, _Default_lcid);
             }
 
             ~_Translator_init_lcids_iterator() noexcept {}
@@ -138,12 +191,12 @@ namespace mjx {
                 _Insert_lcid(_Lcid); // the given LCID is unique, insert it
             }
 
-            void _Init(const translator_settings& _Settings) noexcept {
+            void _Init(const uint32_t _Preferred_lcid, const uint32_t _Default_lcid) noexcept {
                 // Note: The order of LCIDs is fixed and defined as follows: user-preferred, user-default,
                 //       system-preferred, and system-default. To prevent multiple attempts to load the same
                 //       catalog, the LCIDs are filtered to retain only unique ones.
-                _Insert_lcid(_Settings.preferred_lcid()); // always unique
-                _Insert_lcid_if_unique(_Settings.default_lcid());
+                _Insert_lcid(_Preferred_lcid); // always unique
+                _Insert_lcid_if_unique(_Default_lcid);
                 _Insert_lcid_if_unique(::mjx::system_preferred_lcid());
                 _Insert_lcid_if_unique(::mjx::system_default_lcid());
             }
@@ -0,0 +1,143 @@
+// translator_state.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_TRANSLATOR_STATE_HPP_
+#define _UMLS_IMPL_TRANSLATOR_STATE_HPP_
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mjmem/object_allocator.hpp>
+#include <mjmem/smart_pointer.hpp>
+#include <mjstr/string.hpp>
+#include <umls/catalog.hpp>
+#include <umls/impl/bundle.hpp>
+#include <umls/impl/trace.hpp>
+#include <umls/impl/translator.hpp>
+#include <umls/impl/uts_index.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        // Note: The translator publishes its state as immutable snapshots. A snapshot is never modified
+        //       once published, a writer builds a new one and swaps it in atomically. Readers keep the
+        //       snapshot they loaded alive for as long as they use it, so they neither block nor observe
+        //       a half-replaced state.
+        struct _Settings_snapshot {
+            uint32_t _Default_lcid   = 0;
+            uint32_t _Preferred_lcid = 0; // as stored, the user's choice is kept by translator_settings
+            _Uts_catalog_index _Index;
+            unique_smart_ptr<_Catalog_bundle> _Bundle; // null if the settings come from 'settings.uts'
+        };
+
+        struct _Catalog_chain {
+            ::std::shared_ptr<const _Settings_snapshot> _Settings; // keeps the bundle alive, destroyed last
+            message_catalog _Catalog; // includes the fallbacks and the overlay
+            unicode_string _Catalog_name;
+            unicode_string _Overlay_name; // empty if none
+        };
+
+        template <class _Ty, class... _Types>
+        inline ::std::shared_ptr<_Ty> _Make_snapshot(_Types&&... _Args) {
+            // the snapshot and its control block are allocated by the global allocator
+            return ::std::allocate_shared<_Ty>(object_allocator<_Ty>{}, ::std::forward<_Types>(_Args)...);
+        }
+
+        inline bool _Index_catalogs(_Settings_snapshot& _Settings, const translator_catalogs& _Catalogs) {
+            // Note: Version 1 files and bundles store neither the index nor the metadata, so the index
+            //       is built from the already converted catalogs, which are then dropped.
+            byte_string _Tables;
+            uint32_t _Slot_count;
+            uint32_t _String_table_size;
+            return _Make_uts_tables(_Catalogs.data(), _Catalogs.size(), _Tables, _Slot_count, _String_table_size)
+                && _Settings._Index._Assign(::std::move(_Tables), static_cast<uint32_t>(_Catalogs.size()),
+                    _Slot_count, _String_table_size);
+        }
+
+        inline uint32_t _Load_preferred_lcid(const uint32_t _Deployed_lcid) {
+            // returns the LCID from the preferences file, or the deployed one if the file is missing or invalid
+            file _File(_Get_preferences_file_path(), file_access::read, file_share::read);
+            file_stream _Stream(_File);
+            byte_t _Buf[_Upf_file_size];
+            if (!_Stream.is_open() || !_Stream.read_exactly(_Buf, _Upf_file_size)
+                || ::memcmp(_Buf, _Upf_signature, _Uts_signature_size) != 0) {
+                return _Deployed_lcid;
+            }
+
+            return _Load_integer<uint32_t>(_Buf + _Uts_signature_size);
+        }
+
+        inline bool _Load_settings_from_bundle(_Settings_snapshot& _Settings) {
+            // Note: The bundle stays mapped for the lifetime of the snapshot, the catalogs refer to its data.
+            auto _Bundle = ::mjx::make_unique_smart_ptr<_Catalog_bundle>();
+            if (!_Bundle->_Open(_Get_bundle_file_path())) { // no bundle or not recognized, break
+                return false;
+            }
+
+            translator_catalogs _Catalogs;
+            _Catalogs.reserve(_Bundle->_Catalog_count());
+            for (size_t _Idx = 0; _Idx < _Bundle->_Catalog_count(); ++_Idx) {
+                _Catalogs.push_back(_Bundle->_Catalog_at(_Idx));
+            }
+
+            if (!_Index_catalogs(_Settings, _Catalogs)) { // failed to index the catalogs, ignore the bundle
+                return false;
+            }
+
+            const _Uts_static_data& _Data = _Bundle->_Static_data();
+            _Settings._Default_lcid       = _Data._Default_lcid;
+            _Settings._Preferred_lcid     = _Load_preferred_lcid(_Data._Preferred_lcid);
+            _Settings._Bundle             = ::std::move(_Bundle);
+            return true;
+        }
+
+        inline bool _Load_settings_from_file(_Settings_snapshot& _Settings) {
+            // load the translator settings from the 'settings.uts' file
+            file _File(_Get_settings_file_path(), file_access::read, file_share::read);
+            file_stream _Stream(_File);
+            if (!_Stream.is_open()) { // no settings, break
+                return false;
+            }
+
+            _Uts_file_loader _Loader(_Stream);
+            _Uts_static_data _Data;
+            if (!_Loader._Load_static_data(_Data) || !_Verify_uts_signature(_Data)) {
+                return false;
+            }
+
+            bool _Loaded;
+            if (_Uts_version(_Data) == _Uts_indexed_version) { // the names are converted only when requested
+                _Uts_indexed_data _Indexed_data;
+                _Loaded = _Loader._Load_indexed_data(_Indexed_data)
+                    && _Loader._Load_tables(_Settings._Index, _Indexed_data);
+            } else {
+                translator_catalogs _Catalogs;
+                _Loaded = _Loader._Load_catalogs(_Catalogs, _Data._Catalog_count)
+                    && _Index_catalogs(_Settings, _Catalogs);
+            }
+
+            if (!_Loaded) { // something went wrong, leave the settings empty
+                _Settings._Index._Reset();
+                return false;
+            }
+
+            _Settings._Default_lcid   = _Data._Default_lcid;
+            _Settings._Preferred_lcid = _Data._Preferred_lcid;
+            return true;
+        }
+
+        inline ::std::shared_ptr<const _Settings_snapshot> _Load_settings() {
+            // a bundle replaces both 'settings.uts' and the catalogs directory
+            _UMLS_TRACE_SPAN("translator_settings::_Load");
+            ::std::shared_ptr<_Settings_snapshot> _Settings = _Make_snapshot<_Settings_snapshot>();
+            if (!_Load_settings_from_bundle(*_Settings)) {
+                _Load_settings_from_file(*_Settings);
+            }
+
+            return _Settings;
+        }
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_TRANSLATOR_STATE_HPP_
\ No newline at end of file
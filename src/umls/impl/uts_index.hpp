@@ -0,0 +1,271 @@
+// uts_index.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_IMPL_UTS_INDEX_HPP_
+#define _UMLS_IMPL_UTS_INDEX_HPP_
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mjstr/char_traits.hpp>
+#include <mjstr/string.hpp>
+#include <mjstr/string_view.hpp>
+#include <umls/translator.hpp>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    namespace umls_impl {
+#pragma pack(push)
+#pragma pack(4) // must match the layout of the version 2 UTS file
+        struct _Uts_catalog_record {
+            uint32_t _Name_offset; // in characters, relative to the string table
+            uint32_t _Name_length; // in characters
+            uint32_t _Lcid;
+            uint32_t _Message_count;
+            uint64_t _Size; // size of the catalog file in bytes
+            uint64_t _Checksum; // XXH3 hash of the catalog file
+        };
+
+        struct _Uts_name_slot {
+            uint32_t _Hash; // upper half of the name hash
+            uint32_t _Record; // record index plus one, zero if the slot is empty
+        };
+#pragma pack(pop)
+
+        inline uint64_t _Hash_catalog_name(const unicode_string_view _Name) noexcept {
+            return ::XXH3_64bits(_Name.data(), _Name.size() * sizeof(wchar_t));
+        }
+
+        inline uint32_t _Uts_name_slot_count(const size_t _Count) noexcept {
+            // the slot count is a power of 2 that keeps the load factor at or below 0.5
+            if (_Count == 0) { // no catalogs, no slots
+                return 0;
+            }
+
+            uint32_t _Slots = 1;
+            while (_Slots < 2 * _Count) {
+                _Slots <<= 1;
+            }
+
+            return _Slots;
+        }
+
+        inline bool _Uts_tables_size(const uint32_t _Count, const uint32_t _Slot_count,
+            const uint32_t _String_table_size, size_t& _Size) noexcept {
+            // the counts come from the file, so compute the size in 64 bits, it may not fit in size_t on x86
+            const uint64_t _Total = static_cast<uint64_t>(_Count) * (sizeof(_Uts_catalog_record) + sizeof(uint32_t))
+                                  + static_cast<uint64_t>(_Slot_count) * sizeof(_Uts_name_slot) + _String_table_size;
+            if (_Total > SIZE_MAX) { // the tables cannot be addressed, break
+                return false;
+            }
+
+            _Size = static_cast<size_t>(_Total);
+            return true;
+        }
+
+        class _Uts_catalog_index { // lookup tables of the installed catalogs
+        public:
+            // Note: The tables are stored one after another, in the following order: the catalog records
+            //       in installation order, the record indexes sorted by LCID, the name hash slots and
+            //       the string table with the names stored as raw wchar_t, which is UTF-16 on Windows.
+            //       The names are stored in the same form as the API takes them, so lookups never convert
+            //       them, but the tables are only readable on platforms with the same wchar_t size.
+            static constexpr size_t _Npos = static_cast<size_t>(-1);
+
+            _Uts_catalog_index() noexcept : _Mydata(), _Mycount(0), _Myslots(0) {}
+
+            ~_Uts_catalog_index() noexcept {}
+
+            _Uts_catalog_index(const _Uts_catalog_index&)            = delete;
+            _Uts_catalog_index& operator=(const _Uts_catalog_index&) = delete;
+
+            bool _Assign(byte_string&& _Data, const uint32_t _Count, const uint32_t _Slot_count,
+                const uint32_t _String_table_size) noexcept {
+                // takes the tables over if they are consistent, otherwise leaves the index unchanged
+                size_t _Size;
+                if (!_Uts_tables_size(_Count, _Slot_count, _String_table_size, _Size) || _Data.size() != _Size
+                    || _String_table_size % sizeof(wchar_t) != 0 || (_Slot_count & (_Slot_count - 1)) != 0
+                    || (_Count > 0 && _Slot_count <= _Count)) {
+                    return false;
+                }
+
+                const byte_t* const _First                = _Data.data();
+                const _Uts_catalog_record* const _Records = reinterpret_cast<const _Uts_catalog_record*>(_First);
+                const uint32_t* const _Lcids              = reinterpret_cast<const uint32_t*>(_Records + _Count);
+                const _Uts_name_slot* const _Slots        = reinterpret_cast<const _Uts_name_slot*>(_Lcids + _Count);
+                const uint64_t _Chars                     = _String_table_size / sizeof(wchar_t);
+                for (uint32_t _Idx = 0; _Idx < _Count; ++_Idx) {
+                    const _Uts_catalog_record& _Record = _Records[_Idx];
+                    if (static_cast<uint64_t>(_Record._Name_offset) + _Record._Name_length > _Chars
+                        || _Lcids[_Idx] >= _Count) { // name out of range or invalid LCID index, break
+                        return false;
+                    }
+                }
+
+                for (uint32_t _Idx = 0; _Idx < _Slot_count; ++_Idx) {
+                    if (_Slots[_Idx]._Record > _Count) { // invalid record index, break
+                        return false;
+                    }
+                }
+
+                _Mydata  = ::std::move(_Data);
+                _Mycount = _Count;
+                _Myslots = _Slot_count;
+                return true;
+            }
+
+            void _Reset() noexcept {
+                _Mydata.clear();
+                _Mydata.shrink_to_fit();
+                _Mycount = 0;
+                _Myslots = 0;
+            }
+
+            size_t _Size() const noexcept {
+                return _Mycount;
+            }
+
+            size_t _Memory_usage() const noexcept {
+                return _Mydata.capacity();
+            }
+
+            const _Uts_catalog_record& _Record(const size_t _Idx) const noexcept {
+                return _Records()[_Idx];
+            }
+
+            unicode_string_view _Name(const size_t _Idx) const noexcept {
+                const _Uts_catalog_record& _Rec = _Record(_Idx);
+                return unicode_string_view{_Strings() + _Rec._Name_offset, _Rec._Name_length};
+            }
+
+            translator_catalog _Catalog_at(const size_t _Idx) const {
+                const _Uts_catalog_record& _Rec = _Record(_Idx);
+                return translator_catalog{
+                    unicode_string{_Name(_Idx)}, _Rec._Lcid, _Rec._Message_count, _Rec._Size, _Rec._Checksum};
+            }
+
+            size_t _Find_lcid(const uint32_t _Lcid) const noexcept {
+                // returns the first installed catalog with the given LCID
+                const uint32_t* const _First = _Lcids();
+                const uint32_t* const _Last  = _First + _Mycount;
+                const uint32_t* const _Iter  = ::std::lower_bound(_First, _Last, _Lcid,
+                    [this](const uint32_t _Idx, const uint32_t _Value) noexcept {
+                        return _Record(_Idx)._Lcid < _Value;
+                    });
+                return _Iter != _Last && _Record(*_Iter)._Lcid == _Lcid ? *_Iter : _Npos;
+            }
+
+            size_t _Find_name(const unicode_string_view _Catalog) const noexcept {
+                // returns the first installed catalog with the given name
+                if (_Myslots == 0) { // no catalogs, break
+                    return _Npos;
+                }
+
+                using _Traits                      = char_traits<wchar_t>;
+                const uint64_t _Hash               = _Hash_catalog_name(_Catalog);
+                const uint32_t _Tag                = static_cast<uint32_t>(_Hash >> 32);
+                const _Uts_name_slot* const _Slots = _Name_slots();
+                const uint32_t _Mask               = _Myslots - 1;
+                for (uint32_t _Pos = static_cast<uint32_t>(_Hash) & _Mask, _Probes = 0; _Probes < _Myslots;
+                    _Pos = (_Pos + 1) & _Mask, ++_Probes) {
+                    const _Uts_name_slot& _Slot = _Slots[_Pos];
+                    if (_Slot._Record == 0) { // empty slot, the name is not installed
+                        break;
+                    }
+
+                    if (_Slot._Hash == _Tag) {
+                        const unicode_string_view _Stored = _Name(_Slot._Record - 1);
+                        if (_Stored.size() == _Catalog.size()
+                            && _Traits::eq(_Stored.data(), _Catalog.data(), _Catalog.size())) { // found, break
+                            return _Slot._Record - 1;
+                        }
+                    }
+                }
+
+                return _Npos; // not found
+            }
+
+        private:
+            const _Uts_catalog_record* _Records() const noexcept {
+                return reinterpret_cast<const _Uts_catalog_record*>(_Mydata.data());
+            }
+
+            const uint32_t* _Lcids() const noexcept {
+                return reinterpret_cast<const uint32_t*>(_Records() + _Mycount);
+            }
+
+            const _Uts_name_slot* _Name_slots() const noexcept {
+                return reinterpret_cast<const _Uts_name_slot*>(_Lcids() + _Mycount);
+            }
+
+            const wchar_t* _Strings() const noexcept {
+                return reinterpret_cast<const wchar_t*>(_Name_slots() + _Myslots);
+            }
+
+            byte_string _Mydata;
+            uint32_t _Mycount;
+            uint32_t _Myslots;
+        };
+
+        inline bool _Make_uts_tables(const translator_catalog* const _Catalogs, const size_t _Count,
+            byte_string& _Tables, uint32_t& _Slot_count, uint32_t& _String_table_size) {
+            // builds the lookup tables of the given catalogs, shared by mkuts and the legacy formats
+            size_t _Chars = 0;
+            for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+                _Chars += _Catalogs[_Idx].name.size();
+            }
+
+            // Note: The count is limited so that the slot count still fits in a 4-byte integer.
+            constexpr size_t _Max_count = 0x4000'0000;
+            if (_Count > _Max_count || _Chars > 0xFFFF'FFFF / sizeof(wchar_t)) { // the tables would be too large
+                return false;
+            }
+
+            const uint32_t _Short_count = static_cast<uint32_t>(_Count);
+            _Slot_count                 = _Uts_name_slot_count(_Count);
+            _String_table_size          = static_cast<uint32_t>(_Chars * sizeof(wchar_t));
+            size_t _Size;
+            if (!_Uts_tables_size(_Short_count, _Slot_count, _String_table_size, _Size)) { // too large, break
+                return false;
+            }
+
+            _Tables.assign(_Size, byte_t{0});
+
+            byte_t* const _First                = _Tables.data();
+            _Uts_catalog_record* const _Records = reinterpret_cast<_Uts_catalog_record*>(_First);
+            uint32_t* const _Lcids              = reinterpret_cast<uint32_t*>(_Records + _Count);
+            _Uts_name_slot* const _Slots        = reinterpret_cast<_Uts_name_slot*>(_Lcids + _Count);
+            wchar_t* const _Strings             = reinterpret_cast<wchar_t*>(_Slots + _Slot_count);
+            for (uint32_t _Idx = 0, _Off = 0; _Idx < _Short_count; ++_Idx) {
+                const translator_catalog& _Catalog = _Catalogs[_Idx];
+                const uint32_t _Length             = static_cast<uint32_t>(_Catalog.name.size());
+                _Records[_Idx]                     = _Uts_catalog_record{
+                    _Off, _Length, _Catalog.lcid, _Catalog.message_count, _Catalog.size, _Catalog.checksum};
+                ::memcpy(_Strings + _Off, _Catalog.name.data(), _Length * sizeof(wchar_t));
+                _Off += _Length;
+
+                // Note: The slots are filled in installation order, so when two catalogs share a name,
+                //       the probe reaches the first one before the other.
+                const uint64_t _Hash = _Hash_catalog_name(_Catalog.name);
+                uint32_t _Pos        = static_cast<uint32_t>(_Hash) & (_Slot_count - 1);
+                while (_Slots[_Pos]._Record != 0) {
+                    _Pos = (_Pos + 1) & (_Slot_count - 1);
+                }
+
+                _Slots[_Pos] = _Uts_name_slot{static_cast<uint32_t>(_Hash >> 32), _Idx + 1};
+                _Lcids[_Idx] = _Idx;
+            }
+
+            // a stable sort keeps catalogs with the same LCID in installation order
+            ::std::stable_sort(_Lcids, _Lcids + _Count, [_Records](const uint32_t _Left, const uint32_t _Right) {
+                return _Records[_Left]._Lcid < _Records[_Right]._Lcid;
+            });
+            return true;
+        }
+    } // namespace umls_impl
+} // namespace mjx
+
+#endif // _UMLS_IMPL_UTS_INDEX_HPP_
\ No newline at end of file
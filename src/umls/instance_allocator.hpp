@@ -0,0 +1,88 @@
+// instance_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_INSTANCE_ALLOCATOR_HPP_
+#define _UMLS_INSTANCE_ALLOCATOR_HPP_
+#include <mjmem/allocator.hpp>
+#include <type_traits>
+#include <umls/allocation_counter.hpp>
+
+namespace mjx {
+    template <class _Ty>
+    class instance_allocator { // type-specific wrapper around a particular allocator
+    public:
+        static_assert(!::std::is_const_v<_Ty>, "T cannot be const");
+        static_assert(!::std::is_reference_v<_Ty>, "T cannot be a reference");
+        static_assert(!::std::is_function_v<_Ty>, "T cannot be a function object");
+        static_assert(!::std::is_volatile_v<_Ty>, "T cannot be volatile");
+
+        using value_type      = _Ty;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = _Ty*;
+        using const_pointer   = const _Ty*;
+        using reference       = _Ty&;
+        using const_reference = const _Ty&;
+
+        template <class _Other>
+        struct rebind {
+            using other = instance_allocator<_Other>;
+        };
+
+        // Note: A default-constructed instance_allocator refers to the persistent allocator, which forwards
+        //       to the global allocator installed at the time of use. Requests made in an allocation_scope
+        //       are counted, yet the container does not refer to the scope's counter, so it may outlive it.
+        instance_allocator() noexcept : _Myal(&::mjx::persistent_allocator()) {}
+
+        instance_allocator(allocator& _Al) noexcept : _Myal(&_Al) {}
+
+        instance_allocator(const instance_allocator&) noexcept = default;
+        instance_allocator(instance_allocator&&) noexcept      = default;
+        ~instance_allocator() noexcept                         = default;
+
+        template <class _Other>
+        instance_allocator(const instance_allocator<_Other>& _Other_al) noexcept : _Myal(&_Other_al.resource()) {}
+
+        instance_allocator& operator=(const instance_allocator&) noexcept = default;
+        instance_allocator& operator=(instance_allocator&&) noexcept      = default;
+
+        pointer allocate(const size_type _Count) {
+            return static_cast<pointer>(_Myal->allocate(_Count * sizeof(_Ty)));
+        }
+
+        pointer allocate_aligned(const size_type _Count, const size_type _Align) {
+            return static_cast<pointer>(_Myal->allocate_aligned(_Count * sizeof(_Ty), _Align));
+        }
+
+        void deallocate(pointer _Ptr, const size_type _Count) noexcept {
+            _Myal->deallocate(_Ptr, _Count * sizeof(_Ty));
+        }
+
+        size_type max_size() const noexcept {
+            return _Myal->max_size() / sizeof(_Ty);
+        }
+
+        // returns the wrapped allocator
+        allocator& resource() const noexcept {
+            return *_Myal;
+        }
+
+        template <class _Other>
+        bool is_equal(const instance_allocator<_Other>& _Other_al) const noexcept {
+            return _Myal == &_Other_al.resource() || _Myal->is_equal(_Other_al.resource());
+        }
+
+    private:
+        allocator* _Myal;
+    };
+
+    template <class _Ty1, class _Ty2>
+    inline bool operator==(const instance_allocator<_Ty1>& _Left, const instance_allocator<_Ty2>& _Right) noexcept {
+        return _Left.is_equal(_Right);
+    }
+} // namespace mjx
+
+#endif // _UMLS_INSTANCE_ALLOCATOR_HPP_
\ No newline at end of file
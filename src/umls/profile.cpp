@@ -0,0 +1,132 @@
+// profile.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <mjmem/object_allocator.hpp>
+#include <mjstr/string.hpp>
+#include <umls/impl/file_writer.hpp>
+#include <umls/impl/profile.hpp>
+#include <umls/profile.hpp>
+#include <vector>
+
+namespace mjx {
+    namespace umls_impl {
+        struct _Profile_entry {
+            uint64_t _Hash;
+            uint64_t _Count;
+        };
+
+        class _Message_profile { // lock-free hash table of message access counts
+        public:
+            // Note: The table has a fixed capacity, so that recording never allocates. Accesses to
+            //       messages that do not fit are counted as dropped. Hash 0 marks an empty slot,
+            //       the one message whose hash is 0 is never recorded.
+            static constexpr size_t _Capacity  = size_t{1} << 16;
+            static constexpr size_t _Max_probe = 32;
+
+            void _Record(const uint64_t _Hash) noexcept {
+                if (_Hash == 0) { // reserved for empty slots, break
+                    return;
+                }
+
+                size_t _Idx = static_cast<size_t>((_Hash * 0x9E3779B97F4A7C15) >> 48); // Fibonacci hashing
+                for (size_t _Probe = 0; _Probe < _Max_probe; ++_Probe, _Idx = (_Idx + 1) % _Capacity) {
+                    _Slot& _Entry     = _Myslots[_Idx];
+                    uint64_t _Current = _Entry._Hash.load(::std::memory_order_relaxed);
+                    if (_Current == 0) { // empty slot, try to claim it
+                        if (_Entry._Hash.compare_exchange_strong(_Current, _Hash, ::std::memory_order_relaxed)) {
+                            _Current = _Hash;
+                        }
+                    }
+
+                    if (_Current == _Hash) { // slot of this message
+                        _Entry._Count.fetch_add(1, ::std::memory_order_relaxed);
+                        return;
+                    }
+                }
+
+                _Mydropped.fetch_add(1, ::std::memory_order_relaxed);
+            }
+
+            uint64_t _Dropped() const noexcept {
+                return _Mydropped.load(::std::memory_order_relaxed);
+            }
+
+            template <class _Vector>
+            void _Collect(_Vector& _Entries) const {
+                for (const _Slot& _Entry : _Myslots) {
+                    const uint64_t _Hash  = _Entry._Hash.load(::std::memory_order_relaxed);
+                    const uint64_t _Count = _Entry._Count.load(::std::memory_order_relaxed);
+                    if (_Hash != 0 && _Count > 0) {
+                        _Entries.push_back(_Profile_entry{_Hash, _Count});
+                    }
+                }
+            }
+
+            void _Reset() noexcept {
+                for (_Slot& _Entry : _Myslots) {
+                    _Entry._Count.store(0, ::std::memory_order_relaxed);
+                    _Entry._Hash.store(0, ::std::memory_order_relaxed);
+                }
+
+                _Mydropped.store(0, ::std::memory_order_relaxed);
+            }
+
+        private:
+            struct _Slot {
+                ::std::atomic<uint64_t> _Hash  = 0;
+                ::std::atomic<uint64_t> _Count = 0;
+            };
+
+            _Slot _Myslots[_Capacity];
+            ::std::atomic<uint64_t> _Mydropped = 0;
+        };
+
+        // zero-initialized, its pages are committed only once profiling touches them
+        _Message_profile _Profile;
+
+        void _Record_message_access(const uint64_t _Hash) noexcept {
+            _Profile._Record(_Hash);
+        }
+    } // namespace umls_impl
+
+    bool message_profiling_enabled() noexcept {
+        return umls_impl::_Profiling_enabled.load(::std::memory_order_relaxed);
+    }
+
+    void enable_message_profiling(const bool _Enable) noexcept {
+        umls_impl::_Profiling_enabled.store(_Enable, ::std::memory_order_relaxed);
+    }
+
+    uint64_t dropped_message_accesses() noexcept {
+        return umls_impl::_Profile._Dropped();
+    }
+
+    bool write_message_profile(const path& _Target) {
+        // Note: The UMP layout is the 4-byte signature, 4-byte entry count and the entries,
+        //       each made of the 8-byte message hash and 8-byte access count, hottest first.
+        using _Entry = umls_impl::_Profile_entry;
+        ::std::vector<_Entry, object_allocator<_Entry>> _Entries;
+        umls_impl::_Profile._Collect(_Entries);
+        ::std::sort(_Entries.begin(), _Entries.end(), [](const _Entry& _Left, const _Entry& _Right) noexcept {
+            return _Left._Count != _Right._Count ? _Left._Count > _Right._Count : _Left._Hash < _Right._Hash;
+        });
+
+        byte_string _Data;
+        _Data.reserve(8 + _Entries.size() * 16);
+        _Data.append(reinterpret_cast<const byte_t*>("UMP\0"), 4);
+        umls_impl::_Append_le_integer(_Data, _Entries.size(), 4);
+        for (const _Entry& _Item : _Entries) {
+            umls_impl::_Append_le_integer(_Data, _Item._Hash, 8);
+            umls_impl::_Append_le_integer(_Data, _Item._Count, 8);
+        }
+
+        return umls_impl::_Write_whole_file(_Target, _Data);
+    }
+
+    void reset_message_profile() noexcept {
+        umls_impl::_Profile._Reset();
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,30 @@
+// profile.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_PROFILE_HPP_
+#define _UMLS_PROFILE_HPP_
+#include <cstdint>
+#include <mjfs/path.hpp>
+#include <umls/api.hpp>
+
+namespace mjx {
+    // checks whether message accesses are recorded
+    _UMLS_API bool message_profiling_enabled() noexcept;
+
+    // enables or disables recording message accesses
+    _UMLS_API void enable_message_profiling(const bool _Enable) noexcept;
+
+    // returns the number of accesses that could not be recorded because the profile was full
+    _UMLS_API uint64_t dropped_message_accesses() noexcept;
+
+    // writes the recorded access counts to a profile file (UMP), which mkuts uses to reorder catalogs
+    _UMLS_API bool write_message_profile(const path& _Target);
+
+    // resets the recorded access counts
+    _UMLS_API void reset_message_profile() noexcept;
+} // namespace mjx
+
+#endif // _UMLS_PROFILE_HPP_
\ No newline at end of file
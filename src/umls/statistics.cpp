@@ -0,0 +1,190 @@
+// statistics.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <cstring>
+#include <mjmem/smart_pointer.hpp>
+#include <mjsync/srwlock.hpp>
+#include <umls/impl/statistics.hpp>
+#include <umls/statistics.hpp>
+
+namespace mjx {
+    namespace umls_impl {
+        class _Statistics_registry { // owns the counters of all threads and the missing messages sketch
+        public:
+            ~_Statistics_registry() noexcept {}
+
+            _Statistics_registry(const _Statistics_registry&)            = delete;
+            _Statistics_registry& operator=(const _Statistics_registry&) = delete;
+
+            static _Statistics_registry& _Global() noexcept {
+                static _Statistics_registry _Registry;
+                return _Registry;
+            }
+
+            _Thread_counters& _Register() {
+                object_allocator<_Thread_counters> _Al;
+                unique_smart_ptr<_Thread_counters> _Counters(::new (static_cast<void*>(
+                    _Al.allocate_aligned(1, alignof(_Thread_counters)))) _Thread_counters); // own cache line
+                _Thread_counters& _Result                    = *_Counters;
+                lock_guard _Guard(_Mylock);
+                _Mycounters.push_back(::std::move(_Counters));
+                return _Result;
+            }
+
+            void _Record_missing_message(const uint64_t _Hash, const utf8_string_view _Id) noexcept {
+                uint32_t _Estimate = static_cast<uint32_t>(-1);
+                for (size_t _Row = 0; _Row < _Sketch_rows; ++_Row) { // count-min, take the smallest counter
+                    const size_t _Column = static_cast<size_t>(_Hash >> (_Row * 16)) % _Sketch_columns;
+                    _Estimate            = (::std::min)(_Estimate,
+                        _Mysketch[_Row][_Column].fetch_add(1, ::std::memory_order_relaxed) + 1);
+                }
+
+                lock_guard _Guard(_Mytop_lock);
+                _Candidate* _Slot = nullptr;
+                for (size_t _Idx = 0; _Idx < _Mytop_count; ++_Idx) {
+                    if (_Mytop[_Idx]._Hash == _Hash) { // already tracked, update the estimate
+                        _Mytop[_Idx]._Count = _Estimate;
+                        return;
+                    }
+
+                    if (!_Slot || _Mytop[_Idx]._Count < _Slot->_Count) { // remember the least missed message
+                        _Slot = &_Mytop[_Idx];
+                    }
+                }
+
+                if (_Mytop_count < _Max_candidates) { // free slot available
+                    _Slot = &_Mytop[_Mytop_count++];
+                } else if (_Slot->_Count >= _Estimate) { // not missed often enough to be tracked
+                    return;
+                }
+
+                _Slot->_Hash    = _Hash;
+                _Slot->_Count   = _Estimate;
+                _Slot->_Id_size = (::std::min)(_Id.size(), sizeof(_Slot->_Id));
+                ::memcpy(_Slot->_Id, _Id.data(), _Slot->_Id_size);
+            }
+
+            void _Collect(catalog_statistics& _Stats) const {
+                { // sum the counters of all threads
+                    shared_lock_guard _Guard(_Mylock);
+                    for (const unique_smart_ptr<_Thread_counters>& _Counters : _Mycounters) {
+                        _Stats.lookups += _Counters->_Lookups.load(::std::memory_order_relaxed);
+                        _Stats.hits += _Counters->_Hits.load(::std::memory_order_relaxed);
+                        _Stats.formatted_messages += _Counters->_Formatted_messages.load(::std::memory_order_relaxed);
+                        _Stats.plain_messages += _Counters->_Plain_messages.load(::std::memory_order_relaxed);
+                        _Stats.transcoded_bytes += _Counters->_Transcoded_bytes.load(::std::memory_order_relaxed);
+                        for (size_t _Idx = 0; _Idx < catalog_statistics::latency_bucket_count; ++_Idx) {
+                            _Stats.latency_histogram[_Idx] +=
+                                _Counters->_Latency_histogram[_Idx].load(::std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                // Note: The counters are read one by one while other threads keep updating them,
+                //       so the number of hits may momentarily exceed the number of lookups.
+                _Stats.misses = _Stats.lookups > _Stats.hits ? _Stats.lookups - _Stats.hits : 0;
+
+                shared_lock_guard _Guard(_Mytop_lock);
+                _Stats.top_missing_messages.reserve(_Mytop_count);
+                for (size_t _Idx = 0; _Idx < _Mytop_count; ++_Idx) {
+                    const _Candidate& _Cand = _Mytop[_Idx];
+                    _Stats.top_missing_messages.push_back(missing_message{_Cand._Hash,
+                        utf8_string{_Cand._Id, _Cand._Id_size},
+                            static_cast<uint64_t>(_Cand._Count) * _Missing_message_sampling_rate});
+                }
+
+                ::std::sort(_Stats.top_missing_messages.begin(), _Stats.top_missing_messages.end(),
+                    [](const missing_message& _Left, const missing_message& _Right) noexcept {
+                        return _Left.estimated_count > _Right.estimated_count;
+                    });
+            }
+
+            void _Reset() noexcept {
+                {
+                    shared_lock_guard _Guard(_Mylock);
+                    for (const unique_smart_ptr<_Thread_counters>& _Counters : _Mycounters) {
+                        _Counters->_Lookups.store(0, ::std::memory_order_relaxed);
+                        _Counters->_Hits.store(0, ::std::memory_order_relaxed);
+                        _Counters->_Formatted_messages.store(0, ::std::memory_order_relaxed);
+                        _Counters->_Plain_messages.store(0, ::std::memory_order_relaxed);
+                        _Counters->_Transcoded_bytes.store(0, ::std::memory_order_relaxed);
+                        for (::std::atomic<uint64_t>& _Bucket : _Counters->_Latency_histogram) {
+                            _Bucket.store(0, ::std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                lock_guard _Guard(_Mytop_lock);
+                for (auto& _Row : _Mysketch) {
+                    for (::std::atomic<uint32_t>& _Counter : _Row) {
+                        _Counter.store(0, ::std::memory_order_relaxed);
+                    }
+                }
+
+                _Mytop_count = 0;
+            }
+
+        private:
+            static constexpr size_t _Sketch_rows    = 4;
+            static constexpr size_t _Sketch_columns = 1024;
+            static constexpr size_t _Max_candidates = 8;
+            static constexpr size_t _Max_id_size    = 64;
+
+            struct _Candidate {
+                uint64_t _Hash;
+                uint32_t _Count;
+                size_t _Id_size;
+                char _Id[_Max_id_size];
+            };
+
+            _Statistics_registry() noexcept
+                : _Mylock(), _Mycounters(), _Mysketch{}, _Mytop_lock(), _Mytop{}, _Mytop_count(0) {}
+
+            mutable shared_lock _Mylock;
+#pragma warning(suppress : 4251) // C4251: std::vector needs to have dll-interface
+            ::std::vector<unique_smart_ptr<_Thread_counters>,
+                object_allocator<unique_smart_ptr<_Thread_counters>>> _Mycounters;
+            ::std::atomic<uint32_t> _Mysketch[_Sketch_rows][_Sketch_columns];
+            mutable shared_lock _Mytop_lock;
+            _Candidate _Mytop[_Max_candidates];
+            size_t _Mytop_count;
+        };
+
+        _Thread_counters& _Get_thread_counters() {
+            // Note: DllMain() disables thread notifications, so thread-local destructors cannot be relied on.
+            //       The counters are owned by the registry and outlive their threads, which also preserves
+            //       the statistics of threads that have already exited.
+            thread_local _Thread_counters* _Counters = nullptr;
+            if (!_Counters) { // first lookup on this thread, register its counters
+                _Counters = &_Statistics_registry::_Global()._Register();
+            }
+
+            return *_Counters;
+        }
+
+        void _Record_missing_message(const uint64_t _Hash, const utf8_string_view _Id) noexcept {
+            _Statistics_registry::_Global()._Record_missing_message(_Hash, _Id);
+        }
+    } // namespace umls_impl
+
+    bool catalog_statistics_enabled() noexcept {
+        return umls_impl::_Statistics_enabled.load(::std::memory_order_relaxed);
+    }
+
+    void enable_catalog_statistics(const bool _Enable) noexcept {
+        umls_impl::_Statistics_enabled.store(_Enable, ::std::memory_order_relaxed);
+    }
+
+    catalog_statistics collect_catalog_statistics() {
+        catalog_statistics _Stats;
+        umls_impl::_Statistics_registry::_Global()._Collect(_Stats);
+        return _Stats;
+    }
+
+    void reset_catalog_statistics() noexcept {
+        umls_impl::_Statistics_registry::_Global()._Reset();
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,51 @@
+// statistics.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_STATISTICS_HPP_
+#define _UMLS_STATISTICS_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjmem/object_allocator.hpp>
+#include <mjstr/string.hpp>
+#include <umls/api.hpp>
+#include <vector>
+
+namespace mjx {
+    struct missing_message {
+        uint64_t hash; // hash of the message ID
+        utf8_string id; // message ID, truncated if it is too long
+        uint64_t estimated_count; // estimated number of misses, based on sampling
+    };
+
+    struct catalog_statistics {
+        // bucket 0 counts lookups that took less than 1 ns, bucket N counts lookups that took
+        // at least 2^(N-1) ns and less than 2^N ns, the last bucket also counts all slower lookups
+        static constexpr size_t latency_bucket_count = 32;
+
+        uint64_t lookups            = 0;
+        uint64_t hits               = 0;
+        uint64_t misses             = 0;
+        uint64_t formatted_messages = 0;
+        uint64_t plain_messages     = 0;
+        uint64_t transcoded_bytes   = 0;
+        uint64_t latency_histogram[latency_bucket_count] = {0};
+        ::std::vector<missing_message, object_allocator<missing_message>> top_missing_messages;
+    };
+
+    // checks whether the catalog statistics are collected
+    _UMLS_API bool catalog_statistics_enabled() noexcept;
+
+    // enables or disables collecting the catalog statistics
+    _UMLS_API void enable_catalog_statistics(const bool _Enable) noexcept;
+
+    // aggregates the catalog statistics of all threads
+    _UMLS_API catalog_statistics collect_catalog_statistics();
+
+    // resets the catalog statistics
+    _UMLS_API void reset_catalog_statistics() noexcept;
+} // namespace mjx
+
+#endif // _UMLS_STATISTICS_HPP_
\ No newline at end of file
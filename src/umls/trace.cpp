@@ -0,0 +1,26 @@
+// trace.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <umls/impl/trace.hpp>
+#include <umls/trace.hpp>
+
+namespace mjx {
+    bool tracing_available() noexcept {
+#ifdef UMLS_ENABLE_TRACING
+        return true;
+#else // ^^^ UMLS_ENABLE_TRACING ^^^ / vvv !UMLS_ENABLE_TRACING vvv
+        return false;
+#endif // UMLS_ENABLE_TRACING
+    }
+
+    bool write_trace_events(const path& _Target) {
+#ifdef UMLS_ENABLE_TRACING
+        return umls_impl::_Write_trace_events(_Target);
+#else // ^^^ UMLS_ENABLE_TRACING ^^^ / vvv !UMLS_ENABLE_TRACING vvv
+        static_cast<void>(_Target);
+        return false;
+#endif // UMLS_ENABLE_TRACING
+    }
+} // namespace mjx
\ No newline at end of file
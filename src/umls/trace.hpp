@@ -0,0 +1,20 @@
+// trace.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _UMLS_TRACE_HPP_
+#define _UMLS_TRACE_HPP_
+#include <mjfs/path.hpp>
+#include <umls/api.hpp>
+
+namespace mjx {
+    // checks whether the library was built with tracing support (UMLS_ENABLE_TRACING)
+    _UMLS_API bool tracing_available() noexcept;
+
+    // writes the recorded trace events to a Chrome trace (JSON) file, fails if tracing is not available
+    _UMLS_API bool write_trace_events(const path& _Target);
+} // namespace mjx
+
+#endif // _UMLS_TRACE_HPP_
\ No newline at end of file
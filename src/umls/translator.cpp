@@ -3,8 +3,15 @@
 // Copyright (c) Mateusz Jandura. All rights reserved.
 // SPDX-License-Identifier: Apache-2.0
 
+#include <umls/allocation_counter.hpp>
+#include <umls/impl/bundle.hpp>
+#include <umls/impl/file_writer.hpp>
+#include <umls/impl/format.hpp>
+#include <umls/impl/hot_reload.hpp>
 #include <umls/impl/tinywin.hpp>
+#include <umls/impl/trace.hpp>
 #include <umls/impl/translator.hpp>
+#include <umls/impl/translator_state.hpp>
 #include <umls/translator.hpp>
 
 namespace mjx {
@@ -16,60 +23,63 @@ namespace mjx {
         return ::GetUserDefaultLCID();
     }
 
-    translator_settings::translator_settings() : _Myloc(), _Mycats() {
-        _Load();
-    }
+    translator_settings::translator_settings() : _Mysnapshot(umls_impl::_Load_settings()), _Mypreferred(0) {}
 
     translator_settings::~translator_settings() noexcept {
-        if (_Myloc._Changed()) { // something has been changed, save it
+        if (_Changed()) { // something has been changed, save it
             _Save();
         }
     }
 
-    bool translator_settings::_Locale::_Changed() const noexcept {
-        // Note: Only the preferred LCID can be changed at runtime, so we must compare
-        //       the current preferred LCID with the original one.
-        return _Preferred_lcid.load(::std::memory_order_relaxed) != _Originally_preferred_lcid;
+    translator_settings::_Snapshot_ptr translator_settings::_Current() const noexcept {
+        return _Mysnapshot.load(::std::memory_order_acquire);
     }
 
-    void translator_settings::_Locale::_Revert_changes() noexcept {
-        _Preferred_lcid.store(_Originally_preferred_lcid, ::std::memory_order_relaxed);
+    uint32_t translator_settings::_Preferred_lcid(const umls_impl::_Settings_snapshot& _Snapshot) const noexcept {
+        const uint32_t _Lcid = _Mypreferred.load(::std::memory_order_relaxed);
+        return _Lcid != 0 ? _Lcid : _Snapshot._Preferred_lcid;
     }
 
-    void translator_settings::_Locale::_Reset() noexcept {
-        _Default_lcid              = 0;
-        _Originally_preferred_lcid = 0;
-        _Preferred_lcid.store(0, ::std::memory_order_relaxed);
+    bool translator_settings::_Changed() const noexcept {
+        // Note: Only the preferred LCID can be changed at runtime, so we must compare
+        //       the current preferred LCID with the stored one.
+        const uint32_t _Lcid = _Mypreferred.load(::std::memory_order_relaxed);
+        return _Lcid != 0 && _Lcid != _Current()->_Preferred_lcid;
     }
 
-    void translator_settings::_Load() {
-        // load the translator settings from the 'settings.uts' file
-        file _File(umls_impl::_Get_settings_file_path(), file_access::read, file_share::read);
-        file_stream _Stream(_File);
-        if (_Stream.is_open()) { // valid stream, try to load the settings
-            umls_impl::_Uts_file_loader _Loader(_Stream);
-            umls_impl::_Uts_static_data _Data;
-            if (!_Loader._Load_static_data(_Data) || !umls_impl::_Verify_uts_signature(_Data)) {
-                return;
-            }
-
-            _Myloc._Default_lcid              = _Data._Default_lcid;
-            _Myloc._Originally_preferred_lcid = _Data._Preferred_lcid;
-            _Myloc._Preferred_lcid.store(_Data._Preferred_lcid, ::std::memory_order_relaxed);
-            if (!_Loader._Load_catalogs(_Mycats, _Data._Catalog_count)) { // something went wrong, reset the locale
-                _Myloc._Reset();
-            }
+    void translator_settings::_Reload() {
+        // Note: The new settings are loaded aside and swapped in, readers that still hold the previous
+        //       snapshot keep using it. A bundle is never remapped, as the file cannot be replaced while
+        //       it is mapped.
+        if (_Current()->_Bundle) {
+            return;
         }
+
+        _Mysnapshot.store(umls_impl::_Load_settings(), ::std::memory_order_release);
     }
 
     void translator_settings::_Save() const noexcept {
-        // save the translator settings to the 'settings.uts' file
+        // Note: The bundle is deployed read-only, so its preferred LCID is stored in a separate preferences file,
+        //       the 'settings.uts' file is patched in place.
+        const _Snapshot_ptr& _Snapshot = _Current();
+        const uint32_t _Lcid           = _Preferred_lcid(*_Snapshot);
+        if (_Snapshot->_Bundle) {
+            try {
+                byte_string _Data(umls_impl::_Upf_signature, umls_impl::_Uts_signature_size);
+                umls_impl::_Append_le_integer(_Data, _Lcid, sizeof(uint32_t));
+                umls_impl::_Write_whole_file(umls_impl::_Get_preferences_file_path(), _Data);
+            } catch (...) {
+                // ignore the thrown exception, the preference is not saved
+            }
+
+            return;
+        }
+
         file _File(umls_impl::_Get_settings_file_path(), file_access::write);
         file_stream _Stream(_File);
         if (_Stream.is_open()) { // valid stream, try to save the settings
             constexpr file_stream::pos_type _Preferred_lcid_offset = 8;
             if (_Stream.seek(_Preferred_lcid_offset)) {
-                const uint32_t _Lcid = _Myloc._Preferred_lcid.load(::std::memory_order_relaxed);
                 _Stream.write(reinterpret_cast<const byte_t*>(&_Lcid), sizeof(uint32_t));
             }
         }
@@ -82,38 +92,96 @@ namespace mjx {
     }
 
     uint32_t translator_settings::default_lcid() const noexcept {
-        return _Myloc._Default_lcid;
+        return _Current()->_Default_lcid;
     }
 
     uint32_t translator_settings::preferred_lcid() const noexcept {
-        return _Myloc._Preferred_lcid.load(::std::memory_order_relaxed);
+        return _Preferred_lcid(*_Current());
     }
 
     void translator_settings::preferred_lcid(const uint32_t _New_lcid) noexcept {
-        _Myloc._Preferred_lcid.store(_New_lcid, ::std::memory_order_relaxed);
+        _Mypreferred.store(_New_lcid, ::std::memory_order_relaxed);
     }
 
-    const translator_catalogs& translator_settings::installed_catalogs() const noexcept {
-        return _Mycats;
+    translator_catalogs translator_settings::installed_catalogs() const {
+        // the list is created from the index of a single snapshot, so a concurrent reload cannot tear it
+        const _Snapshot_ptr& _Snapshot = _Current();
+        translator_catalogs _Catalogs;
+        _Catalogs.reserve(_Snapshot->_Index._Size());
+        for (size_t _Idx = 0; _Idx < _Snapshot->_Index._Size(); ++_Idx) {
+            _Catalogs.push_back(_Snapshot->_Index._Catalog_at(_Idx));
+        }
+
+        return _Catalogs;
     }
 
     bool translator_settings::is_catalog_installed(const unicode_string_view _Catalog) const noexcept {
-        for (const translator_catalog& _Cat : _Mycats) {
-            if (_Cat.name == _Catalog) { // searched catalog found, break
-                return true;
-            }
+        return _Current()->_Index._Find_name(_Catalog) != umls_impl::_Uts_catalog_index::_Npos;
+    }
+
+    translator_settings::catalog_lookup_result translator_settings::find_catalog(
+        const unicode_string_view _Catalog) const {
+        const _Snapshot_ptr& _Snapshot = _Current();
+        const size_t _Idx              = _Snapshot->_Index._Find_name(_Catalog);
+        if (_Idx == umls_impl::_Uts_catalog_index::_Npos) { // not installed, break
+            return catalog_lookup_result{translator_catalog{}, false};
         }
 
-        return false; // not found
+        return catalog_lookup_result{_Snapshot->_Index._Catalog_at(_Idx), true};
     }
 
-    void translator_settings::discard_changes() noexcept {
-        if (_Myloc._Changed()) { // something has been changed, revert it
-            _Myloc._Revert_changes();
+    translator_settings::catalog_lookup_result translator_settings::find_catalog(const uint32_t _Lcid) const {
+        const _Snapshot_ptr& _Snapshot = _Current();
+        const size_t _Idx              = _Snapshot->_Index._Find_lcid(_Lcid);
+        if (_Idx == umls_impl::_Uts_catalog_index::_Npos) { // not installed, break
+            return catalog_lookup_result{translator_catalog{}, false};
         }
+
+        return catalog_lookup_result{_Snapshot->_Index._Catalog_at(_Idx), true};
     }
 
-    translator::translator() noexcept : _Mylock(), _Myset(), _Mycat(), _Myfbmsg(L"???") {
+    bool translator_settings::bundled() const noexcept {
+        return _Current()->_Bundle != nullptr;
+    }
+
+    size_t translator_settings::memory_usage() const noexcept {
+        return _Current()->_Index._Memory_usage();
+    }
+
+    void translator_settings::discard_changes() noexcept {
+        _Mypreferred.store(0, ::std::memory_order_relaxed);
+    }
+
+    catalog_snapshot::catalog_snapshot() noexcept : _Mychain(nullptr) {}
+
+    catalog_snapshot::catalog_snapshot(const catalog_snapshot& _Other) noexcept : _Mychain(_Other._Mychain) {}
+
+    catalog_snapshot::catalog_snapshot(::std::shared_ptr<const umls_impl::_Catalog_chain>&& _Chain) noexcept
+        : _Mychain(::std::move(_Chain)) {}
+
+    catalog_snapshot::~catalog_snapshot() noexcept {}
+
+    catalog_snapshot& catalog_snapshot::operator=(const catalog_snapshot& _Other) noexcept {
+        _Mychain = _Other._Mychain;
+        return *this;
+    }
+
+    const message_catalog& catalog_snapshot::get() const noexcept {
+        static const message_catalog _Empty;
+        return _Mychain ? _Mychain->_Catalog : _Empty;
+    }
+
+    const message_catalog& catalog_snapshot::operator*() const noexcept {
+        return get();
+    }
+
+    const message_catalog* catalog_snapshot::operator->() const noexcept {
+        return ::std::addressof(get());
+    }
+
+    translator::translator() noexcept
+        : _Mylock(), _Myset(), _Mychain(nullptr), _Myfbmsg(nullptr), _Myal(&::mjx::persistent_allocator()),
+        _Mystartup(), _Mywarmer(nullptr), _Mywarmup(), _Mygen(0), _Myreloader(nullptr) {
         // invoke _Init() within a try-catch block to preserve the noexcept specification of the constructor
         try {
             _Init();
@@ -122,25 +190,196 @@ namespace mjx {
         }
     }
 
-    translator::~translator() noexcept {}
+    translator::~translator() noexcept {
+        _Myreloader.reset(); // stop reloading before anything else is destroyed
+        // Note: The warm-up thread is not waited for here, as the global translator might be destroyed
+        //       while the process is exiting, when the thread is already gone. Dropping the pending tasks
+        //       is enough, a running warm-up keeps its own reference to the catalog chain.
+        if (_Mywarmer) {
+            _Mywarmer->cancel_all_pending_tasks();
+        }
+    }
+
+    unicode_string_view translator::_Select_catalog(const umls_impl::_Settings_snapshot& _Settings) const noexcept {
+        // the name refers to the index, no catalog list has to be created
+        umls_impl::_Translator_init_lcids_iterator _Iter(_Myset._Preferred_lcid(_Settings), _Settings._Default_lcid);
+        for (const uint32_t _Lcid : _Iter) {
+            const size_t _Idx = _Settings._Index._Find_lcid(_Lcid);
+            if (_Idx != umls_impl::_Uts_catalog_index::_Npos) { // found the most preferred installed catalog
+                return _Settings._Index._Name(_Idx);
+            }
+        }
+
+        return unicode_string_view{};
+    }
+
+    void translator::_Attach_fallback_catalogs(
+        const umls_impl::_Settings_snapshot& _Settings, message_catalog& _Catalog) const {
+        // attach catalogs in order of preference, skipping the language of the primary catalog
+        umls_impl::_Translator_init_lcids_iterator _Iter(_Myset._Preferred_lcid(_Settings), _Settings._Default_lcid);
+        for (const uint32_t _Lcid : _Iter) {
+            if (_Lcid == _Catalog.lcid()) { // already used as the primary catalog
+                continue;
+            }
+
+            const size_t _Idx = _Settings._Index._Find_lcid(_Lcid);
+            if (_Idx != umls_impl::_Uts_catalog_index::_Npos) {
+                _Catalog.attach_fallback(_Open_catalog(_Settings, _Settings._Index._Name(_Idx)));
+            }
+        }
+    }
+
+    message_catalog translator::_Open_catalog(
+        const umls_impl::_Settings_snapshot& _Settings, const unicode_string_view _Catalog) const {
+        if (_Settings._Bundle) { // refer to the mapped bundle, the index lists its catalogs in the same order
+            const size_t _Idx = _Settings._Index._Find_name(_Catalog);
+            return message_catalog{_Idx != umls_impl::_Uts_catalog_index::_Npos
+                ? _Settings._Bundle->_Catalog_data(_Idx) : byte_string_view{}, catalog_buffer_mode::borrow, *_Myal};
+        }
+
+        return message_catalog{translator_settings::catalogs_directory() / _Catalog, catalog_load_mode::read, *_Myal};
+    }
+
+    translator::_Chain_ptr translator::_Load_catalog_chain(
+        _Settings_ptr _Settings, const unicode_string_view _Catalog, const unicode_string_view _Overlay) const {
+        // Note: The chain is built privately and published only once it is complete, it is never
+        //       modified afterwards.
+        ::std::shared_ptr<umls_impl::_Catalog_chain> _Chain = umls_impl::_Make_snapshot<umls_impl::_Catalog_chain>();
+        _Chain->_Catalog = _Open_catalog(*_Settings, _Catalog);
+        if (!_Chain->_Catalog.is_open()) { // failed to open the catalog, break
+            return nullptr;
+        }
+
+        _Attach_fallback_catalogs(*_Settings, _Chain->_Catalog);
+        if (!_Overlay.empty() && !_Chain->_Catalog.attach_overlay(_Open_catalog(*_Settings, _Overlay))) {
+            return nullptr; // failed to open the overlay
+        }
+
+        _Chain->_Settings     = ::std::move(_Settings);
+        _Chain->_Catalog_name = _Catalog;
+        _Chain->_Overlay_name = _Overlay;
+        return _Chain;
+    }
+
+    void translator::_Publish(_Chain_ptr&& _Chain) noexcept {
+        // Note: The previous chain is destroyed by whoever releases it last, which might be a reader
+        //       that loaded it before the swap.
+        _Mychain.store(::std::move(_Chain), ::std::memory_order_release);
+        _Schedule_warm_up();
+    }
 
-    unicode_string_view translator::_Find_catalog_name_by_lcid(const uint32_t _Lcid) const noexcept {
-        for (const translator_catalog& _Catalog : _Myset.installed_catalogs()) {
-            if (_Catalog.lcid == _Lcid) { // searched catalog found, break
-                return _Catalog.name;
+    void translator::_Hot_reload_callback(void* const _Arg, const umls_impl::_Hot_reload_target _Targets) noexcept {
+        try {
+            static_cast<translator*>(_Arg)->_Hot_reload(_Targets);
+        } catch (...) {
+            // ignore the thrown exception, the current catalog stays in use
+        }
+    }
+
+    void translator::_Hot_reload(const umls_impl::_Hot_reload_target _Targets) {
+        _UMLS_TRACE_SPAN("translator::_Hot_reload");
+        const bool _Reload_settings =
+            umls_impl::_Has_hot_reload_target(_Targets, umls_impl::_Hot_reload_target::_Settings);
+        if (_Reload_settings) { // publishes the new settings at once, the catalogs follow below
+            _Myset._Reload();
+        }
+
+        const _Settings_ptr _Settings = _Myset._Current();
+        unicode_string _Catalog;
+        unicode_string _Overlay;
+        size_t _Gen;
+        {
+            lock_guard _Guard(_Mylock);
+            if (_Reload_settings) {
+                // Note: The settings decide which catalog is used, so the preferred catalog is selected again.
+                //       The overlay belongs to the previous selection, therefore it is not carried over.
+                _Catalog = _Select_catalog(*_Settings);
+            } else if (const _Chain_ptr& _Current = _Mychain.load(::std::memory_order_acquire); _Current) {
+                _Catalog = _Current->_Catalog_name;
+                _Overlay = _Current->_Overlay_name;
             }
+
+            _Gen = _Mygen;
         }
 
-        return unicode_string_view{}; // not found
+        if (_Catalog.empty()) { // nothing to reload, break
+            return;
+        }
+
+        // Note: The new chain is loaded without holding the lock, readers are never blocked anyway,
+        //       and the caller can still switch the catalog in the meantime.
+        _Chain_ptr _New = _Load_catalog_chain(_Settings, _Catalog, _Overlay);
+        if (!_New) { // the file might still be written, keep the current catalog
+            return;
+        }
+
+        lock_guard _Guard(_Mylock);
+        if (_Gen == _Mygen) { // the caller did not switch the catalog in the meantime
+            _Publish(::std::move(_New));
+        }
+    }
+
+    void translator::_Schedule_warm_up() noexcept {
+        if (_Mystartup.empty() || !_Mychain.load(::std::memory_order_relaxed)) { // nothing to warm up, break
+            return;
+        }
+
+        try {
+            if (!_Mywarmer) { // first warm-up, create the thread
+                _Mywarmer = ::mjx::make_unique_smart_ptr<thread>();
+            }
+
+            // Note: The previous warm-up refers to a catalog that is no longer in use, so drop it if it
+            //       has not started yet. The new one runs once the caller releases the lock.
+            _Mywarmer->cancel_all_pending_tasks();
+            _Mywarmup = _Mywarmer->schedule_task(&translator::_Warm_up_task, this, task_priority::below_normal);
+        } catch (...) {
+            // ignore the thrown exception, warming up is only a hint
+        }
+    }
+
+    void translator::_Warm_up_task(void* const _Arg) noexcept {
+        static_cast<const translator*>(_Arg)->_Warm_up();
+    }
+
+    void translator::_Warm_up() const noexcept {
+        // Note: The chain is held for the whole warm-up, so it stays valid even if it is replaced meanwhile.
+        //       The lock is held only to copy the message IDs.
+        try {
+            const _Chain_ptr& _Chain = _Mychain.load(::std::memory_order_acquire);
+            if (!_Chain) { // nothing to warm up, break
+                return;
+            }
+
+            startup_message_set _Startup;
+            {
+                shared_lock_guard _Guard(_Mylock);
+                _Startup = _Mystartup;
+            }
+
+            ::std::vector<utf8_string_view, object_allocator<utf8_string_view>> _Ids;
+            _Ids.reserve(_Startup.size());
+            for (const utf8_string& _Id : _Startup) {
+                _Ids.push_back(_Id);
+            }
+
+            _Chain->_Catalog.warm_up(_Ids.data(), _Ids.size());
+        } catch (...) {
+            // ignore the thrown exception, warming up is only a hint
+        }
     }
 
     void translator::_Init() {
+        _UMLS_TRACE_SPAN("translator::_Init");
+        _Myfbmsg.store(umls_impl::_Make_snapshot<unicode_string>(L"???"), ::std::memory_order_relaxed);
+
         // load a catalog based on user preferrence
-        umls_impl::_Translator_init_lcids_iterator _Iter(_Myset);
-        for (unicode_string_view _Catalog; const uint32_t _Lcid : _Iter) {
-            _Catalog = _Find_catalog_name_by_lcid(_Lcid);
-            if (!_Catalog.empty() && use_catalog(_Catalog)) { // loaded a catalog, break
-                break;
+        const _Settings_ptr _Settings = _Myset._Current();
+        umls_impl::_Translator_init_lcids_iterator _Iter(_Myset._Preferred_lcid(*_Settings), _Settings->_Default_lcid);
+        for (const uint32_t _Lcid : _Iter) {
+            const size_t _Idx = _Settings->_Index._Find_lcid(_Lcid);
+            if (_Idx != umls_impl::_Uts_catalog_index::_Npos && use_catalog(_Settings->_Index._Name(_Idx))) {
+                break; // loaded a catalog, break
             }
         }
     }
@@ -158,29 +397,185 @@ namespace mjx {
         return _Myset;
     }
 
-    const unicode_string& translator::fallback_message() const noexcept {
-        shared_lock_guard _Guard(_Mylock);
-        return _Myfbmsg;
+    unicode_string translator::fallback_message() const {
+        const ::std::shared_ptr<const unicode_string>& _Message = _Myfbmsg.load(::std::memory_order_acquire);
+        return _Message ? *_Message : unicode_string{};
     }
 
     void translator::fallback_message(const unicode_string_view _New_message) {
         lock_guard _Guard(_Mylock);
-        if (_Myfbmsg != _New_message) {
-            _Myfbmsg = _New_message;
-        }
+        _Myfbmsg.store(umls_impl::_Make_snapshot<unicode_string>(_New_message), ::std::memory_order_release);
     }
 
-    const message_catalog& translator::catalog() const noexcept {
+    allocator& translator::catalog_allocator() const noexcept {
         shared_lock_guard _Guard(_Mylock);
-        return _Mycat;
+        return *_Myal;
+    }
+
+    void translator::catalog_allocator(allocator& _New_al) noexcept {
+        // Note: Catalogs that are already loaded keep using the previous allocator until they are
+        //       replaced, so the previous allocator must outlive them.
+        lock_guard _Guard(_Mylock);
+        _Myal = ::std::addressof(_New_al);
+    }
+
+    catalog_snapshot translator::catalog() const noexcept {
+        return catalog_snapshot{_Mychain.load(::std::memory_order_acquire)};
+    }
+
+    startup_message_set translator::startup_messages() const {
+        shared_lock_guard _Guard(_Mylock);
+        return _Mystartup;
+    }
+
+    void translator::startup_messages(const utf8_string_view* const _Ids, const size_t _Count) {
+        lock_guard _Guard(_Mylock);
+        _Mystartup.clear();
+        _Mystartup.reserve(_Count);
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            _Mystartup.emplace_back(_Ids[_Idx]);
+        }
+
+        _Schedule_warm_up(); // warm up the current catalog as well
+    }
+
+    void translator::startup_messages(const ::std::initializer_list<utf8_string_view> _Ids) {
+        startup_messages(_Ids.begin(), _Ids.size());
+    }
+
+    void translator::wait_for_warm_up() noexcept {
+        // Note: The task is moved out under the lock, so that waiting does not block catalog switches.
+        task _Pending;
+        {
+            lock_guard _Guard(_Mylock);
+            _Pending = ::std::move(_Mywarmup);
+        }
+
+        if (_Pending.is_registered()) {
+            _Pending.wait_until_done();
+        }
+    }
+
+    translator_memory_usage translator::memory_usage() const noexcept {
+        const _Chain_ptr& _Chain                                = _Mychain.load(::std::memory_order_acquire);
+        const ::std::shared_ptr<const unicode_string>& _Message = _Myfbmsg.load(::std::memory_order_acquire);
+        translator_memory_usage _Usage;
+        if (_Chain) {
+            _Usage.catalog = _Chain->_Catalog.memory_usage();
+        }
+
+        _Usage.settings_bytes         = _Myset.memory_usage();
+        _Usage.fallback_message_bytes = _Message ? _Message->capacity() * sizeof(wchar_t) : 0;
+        return _Usage;
+    }
+
+    unicode_string translator::get_message(const utf8_string_view _Id, const format_args& _Args) const {
+        // Note: The loaded chain stays valid for the whole lookup, even if use_catalog() or a hot reload
+        //       replaces it in the meantime, so no lock is needed.
+        if (const _Chain_ptr& _Chain = _Mychain.load(::std::memory_order_acquire); _Chain) {
+            auto [_Message, _Retrieved] = _Chain->_Catalog.get_message(_Id, _Args);
+            if (_Retrieved) {
+                return ::std::move(_Message);
+            }
+        }
+
+        return fallback_message();
+    }
+
+    unicode_string_view translator::get_message(
+        const utf8_string_view _Id, const format_args& _Args, format_arena& _Arena) const {
+        if (const _Chain_ptr& _Chain = _Mychain.load(::std::memory_order_acquire); _Chain) {
+            const auto [_Message, _Retrieved] = _Chain->_Catalog.get_message(_Id, _Args, _Arena);
+            if (_Retrieved) {
+                return _Message;
+            }
+        }
+
+        // copy the fallback message into the arena, it may be replaced before the arena is released
+        const ::std::shared_ptr<const unicode_string>& _Message = _Myfbmsg.load(::std::memory_order_acquire);
+        return _Message ? umls_impl::_Copy_to_arena(_Arena, unicode_string_view{*_Message}) : unicode_string_view{};
     }
 
     bool translator::use_catalog(const unicode_string_view _Catalog) {
+        _UMLS_TRACE_SPAN("translator::use_catalog");
+        lock_guard _Guard(_Mylock);
+        ++_Mygen;
+        _Chain_ptr _Chain = _Load_catalog_chain(_Myset._Current(), _Catalog, unicode_string_view{});
+        const bool _Loaded = _Chain != nullptr;
+        _Publish(::std::move(_Chain)); // a failed load leaves no catalog, as before
+        return _Loaded;
+    }
+
+    void translator::restore_catalog(const catalog_snapshot& _Snapshot) noexcept {
+        // the snapshot's chain was published before and is immutable, so it can be published again
         lock_guard _Guard(_Mylock);
-        if (_Mycat.is_open()) { // some catalog is already open, close it
-            _Mycat.close();
+        ++_Mygen;
+        _Publish(_Chain_ptr{_Snapshot._Mychain});
+    }
+
+    bool translator::use_overlay(const unicode_string_view _Catalog) {
+        // Note: Published chains are immutable, so the current catalog is loaded again with the overlay.
+        lock_guard _Guard(_Mylock);
+        const _Chain_ptr& _Current = _Mychain.load(::std::memory_order_acquire);
+        if (!_Current) { // no catalog to attach the overlay to, break
+            return false;
+        }
+
+        _Chain_ptr _Chain = _Load_catalog_chain(_Current->_Settings, _Current->_Catalog_name, _Catalog);
+        if (!_Chain) { // failed to open the overlay, keep the current catalog
+            return false;
+        }
+
+        ++_Mygen;
+        _Publish(::std::move(_Chain));
+        return true;
+    }
+
+    void translator::discard_overlay() noexcept {
+        lock_guard _Guard(_Mylock);
+        const _Chain_ptr& _Current = _Mychain.load(::std::memory_order_acquire);
+        if (!_Current || _Current->_Overlay_name.empty()) { // no overlay attached, break
+            return;
+        }
+
+        try {
+            _Chain_ptr _Chain =
+                _Load_catalog_chain(_Current->_Settings, _Current->_Catalog_name, unicode_string_view{});
+            if (_Chain) {
+                ++_Mygen;
+                _Publish(::std::move(_Chain));
+            }
+        } catch (...) {
+            // ignore the thrown exception, the overlay stays attached
+        }
+    }
+
+    bool translator::hot_reload_enabled() const noexcept {
+        shared_lock_guard _Guard(_Mylock);
+        return _Myreloader != nullptr;
+    }
+
+    bool translator::enable_hot_reload(const bool _Enable) {
+        // Note: The reloader is stopped without holding the lock, as it might be waiting for the lock
+        //       to swap a reloaded catalog in.
+        unique_smart_ptr<umls_impl::_Hot_reloader> _Reloader;
+        {
+            lock_guard _Guard(_Mylock);
+            if (_Enable == (_Myreloader != nullptr)) { // already in the requested state, break
+                return true;
+            }
+
+            _Reloader = ::std::move(_Myreloader);
+            if (_Enable) {
+                _Myreloader = ::mjx::make_unique_smart_ptr<umls_impl::_Hot_reloader>(&_Hot_reload_callback, this);
+                if (!_Myreloader->_Start(
+                    umls_impl::_Get_settings_file_path().parent_path(), translator_settings::catalogs_directory())) {
+                    _Myreloader.reset();
+                    return false;
+                }
+            }
         }
 
-        return _Mycat.open(_Myset.catalogs_directory() / _Catalog);
+        return true;
     }
 } // namespace mjx
\ No newline at end of file
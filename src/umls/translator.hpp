@@ -8,28 +8,56 @@
 #define _UMLS_TRANSLATOR_HPP_
 #include <atomic>
 #include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <mjmem/object_allocator.hpp>
+#include <mjmem/smart_pointer.hpp>
 #include <mjstr/string.hpp>
 #include <mjstr/string_view.hpp>
 #include <mjsync/srwlock.hpp>
+#include <mjsync/task.hpp>
+#include <mjsync/thread.hpp>
 #include <type_traits>
 #include <umls/api.hpp>
 #include <umls/catalog.hpp>
 #include <vector>
 
 namespace mjx {
+    namespace umls_impl {
+        class _Hot_reloader;
+        struct _Catalog_chain;
+        struct _Settings_snapshot;
+        enum class _Hot_reload_target : uint8_t;
+    } // namespace umls_impl
+
     _UMLS_API uint32_t system_default_lcid() noexcept;
     _UMLS_API uint32_t system_preferred_lcid() noexcept;
 
     struct translator_catalog {
         unicode_string name;
         uint32_t lcid;
+
+        // stored only by version 2 settings, zero otherwise
+        uint32_t message_count = 0;
+        uint64_t size          = 0; // size of the catalog file in bytes
+        uint64_t checksum      = 0; // XXH3 hash of the catalog file
     };
 
     using translator_catalogs = ::std::vector<translator_catalog, object_allocator<translator_catalog>>;
 
+    struct translator_memory_usage { // memory used by the translator
+        catalog_memory_usage catalog; // current catalog, including its overlay and fallbacks
+        size_t settings_bytes         = 0; // installed catalogs
+        size_t fallback_message_bytes = 0;
+    };
+
+    using startup_message_set = ::std::vector<utf8_string, object_allocator<utf8_string>>;
+
     class _UMLS_API translator_settings { // stores settings used by the translator
     public:
+        // Note: The settings may be used from any thread. They are kept as an immutable snapshot that
+        //       a reload replaces atomically, so every query sees either the old or the new settings.
+        //       The preferred LCID changed by the user is kept across reloads until it is discarded.
         translator_settings();
         ~translator_settings() noexcept;
 
@@ -47,40 +75,75 @@ namespace mjx {
         void preferred_lcid(const uint32_t _New_lcid) noexcept;
     
         // returns the installed catalogs
-        const translator_catalogs& installed_catalogs() const noexcept;
+        translator_catalogs installed_catalogs() const;
 
         // checks if a catalog is installed
         bool is_catalog_installed(const unicode_string_view _Catalog) const noexcept;
+
+        struct catalog_lookup_result {
+            translator_catalog catalog;
+            bool found;
+        };
+
+        // returns the installed catalog with the given name or the first one with the given LCID,
+        // without opening it
+        catalog_lookup_result find_catalog(const unicode_string_view _Catalog) const;
+        catalog_lookup_result find_catalog(const uint32_t _Lcid) const;
+
+        // checks whether the settings and catalogs are loaded from a bundle
+        bool bundled() const noexcept;
+
+        // returns the memory used by the installed catalogs index
+        size_t memory_usage() const noexcept;
     
         // discards all changes that have been made
         void discard_changes() noexcept;
 
     private:
-        class _Locale {
-        public:
-            uint32_t _Default_lcid                  = 0;
-            uint32_t _Originally_preferred_lcid     = 0;
-            ::std::atomic<uint32_t> _Preferred_lcid = 0;
+        friend class translator;
 
-            // checks if any changes have been made
-            bool _Changed() const noexcept;
+        using _Snapshot_ptr = ::std::shared_ptr<const umls_impl::_Settings_snapshot>;
 
-            // reverts all changes that have been made
-            void _Revert_changes() noexcept;
+        // returns the current snapshot
+        _Snapshot_ptr _Current() const noexcept;
 
-            // resets the locale
-            void _Reset() noexcept;
-        };
+        // returns the preferred LCID, either the one changed by the user or the stored one
+        uint32_t _Preferred_lcid(const umls_impl::_Settings_snapshot& _Snapshot) const noexcept;
+
+        // checks if the preferred LCID has been changed
+        bool _Changed() const noexcept;
 
-        // loads the settings from the file
-        void _Load();
+        // loads the settings from the file again, keeps the preferred LCID if it has been changed
+        void _Reload();
 
         // saves the settings to the file
         void _Save() const noexcept;
 
-        _Locale _Myloc;
-#pragma warning(suppress : 4251) // C4251: translator_catalogs needs to have dll-interface
-        translator_catalogs _Mycats;
+#pragma warning(suppress : 4251) // C4251: std::atomic<_Snapshot_ptr> needs to have dll-interface
+        ::std::atomic<_Snapshot_ptr> _Mysnapshot; // smart_ptr cannot be swapped atomically
+        ::std::atomic<uint32_t> _Mypreferred; // zero unless the user changed the preferred LCID
+    };
+
+    class _UMLS_API catalog_snapshot { // keeps the catalog that was current when it was taken alive
+    public:
+        catalog_snapshot() noexcept;
+        catalog_snapshot(const catalog_snapshot& _Other) noexcept;
+        ~catalog_snapshot() noexcept;
+
+        catalog_snapshot& operator=(const catalog_snapshot& _Other) noexcept;
+
+        // returns the catalog, an empty one if no catalog was loaded
+        const message_catalog& get() const noexcept;
+        const message_catalog& operator*() const noexcept;
+        const message_catalog* operator->() const noexcept;
+
+    private:
+        friend class translator;
+
+        explicit catalog_snapshot(::std::shared_ptr<const umls_impl::_Catalog_chain>&& _Chain) noexcept;
+
+#pragma warning(suppress : 4251) // C4251: std::shared_ptr needs to have dll-interface
+        ::std::shared_ptr<const umls_impl::_Catalog_chain> _Mychain;
     };
 
     class _UMLS_API translator { // manages multi-language support
@@ -98,41 +161,113 @@ namespace mjx {
         const translator_settings& settings() const noexcept;
 
         // returns or changes the fallback message
-        const unicode_string& fallback_message() const noexcept;
+        unicode_string fallback_message() const;
         void fallback_message(const unicode_string_view _New_message);
 
-        // returns the current catalog
-        const message_catalog& catalog() const noexcept;
+        // returns or changes the allocator used by catalogs that are loaded from now on
+        allocator& catalog_allocator() const noexcept;
+        void catalog_allocator(allocator& _New_al) noexcept;
+
+        // returns the current catalog, it stays valid even if the catalog is replaced in the meantime
+        catalog_snapshot catalog() const noexcept;
+
+        // returns or changes the messages that are warmed up in the background whenever a catalog is loaded
+        startup_message_set startup_messages() const;
+        void startup_messages(const utf8_string_view* const _Ids, const size_t _Count);
+        void startup_messages(const ::std::initializer_list<utf8_string_view> _Ids);
+
+        // waits until the pending warm-up, if any, finishes
+        void wait_for_warm_up() noexcept;
+
+        // retrieves a message from the current catalog, returns the fallback message on failure
+        unicode_string get_message(const utf8_string_view _Id, const format_args& _Args = {}) const;
+
+        // same as above, but the message is allocated by _Arena and is valid until the arena is released
+        unicode_string_view get_message(
+            const utf8_string_view _Id, const format_args& _Args, format_arena& _Arena) const;
+
+        // returns the memory used by the translator
+        translator_memory_usage memory_usage() const noexcept;
 
         // loads a catalog
         bool use_catalog(const unicode_string_view _Catalog);
 
+        // makes the catalog of the snapshot current again, along with its fallbacks and overlay,
+        // an empty snapshot leaves no catalog loaded
+        void restore_catalog(const catalog_snapshot& _Snapshot) noexcept;
+
+        // loads an overlay and attaches it to the current catalog
+        bool use_overlay(const unicode_string_view _Catalog);
+
+        // detaches the overlay from the current catalog
+        void discard_overlay() noexcept;
+
+        // checks whether catalogs and settings are reloaded when their files change
+        bool hot_reload_enabled() const noexcept;
+
+        // starts or stops reloading catalogs and settings when their files change
+        bool enable_hot_reload(const bool _Enable);
+
     private:
+        // Note: Readers never take _Mylock, they load the current catalog chain and fallback message
+        //       atomically and keep them alive while in use. _Mylock only serializes the writers, which
+        //       build a new chain aside and publish it with a single atomic store.
+        using _Chain_ptr    = ::std::shared_ptr<const umls_impl::_Catalog_chain>;
+        using _Settings_ptr = ::std::shared_ptr<const umls_impl::_Settings_snapshot>;
+
         translator() noexcept;
 
-        // returns a catalog name associated with the given LCID
-        unicode_string_view _Find_catalog_name_by_lcid(const uint32_t _Lcid) const noexcept;
+        // returns the name of the most preferred installed catalog, or an empty string if none is installed
+        unicode_string_view _Select_catalog(const umls_impl::_Settings_snapshot& _Settings) const noexcept;
+
+        // attaches catalogs of the remaining preferred languages as fallbacks
+        void _Attach_fallback_catalogs(const umls_impl::_Settings_snapshot& _Settings, message_catalog& _Catalog) const;
+
+        // opens an installed catalog, either from the bundle or from the catalogs directory
+        message_catalog _Open_catalog(
+            const umls_impl::_Settings_snapshot& _Settings, const unicode_string_view _Catalog) const;
+
+        // loads a catalog along with its fallbacks and overlay, returns null if either one cannot be opened
+        _Chain_ptr _Load_catalog_chain(
+            _Settings_ptr _Settings, const unicode_string_view _Catalog, const unicode_string_view _Overlay) const;
+
+        // publishes a new catalog chain, _Mylock must be held exclusively
+        void _Publish(_Chain_ptr&& _Chain) noexcept;
+
+        // reloads the changed files, called from the hot reload thread
+        static void _Hot_reload_callback(void* const _Arg, const umls_impl::_Hot_reload_target _Targets) noexcept;
+        void _Hot_reload(const umls_impl::_Hot_reload_target _Targets);
 
         // initializes the translator
         void _Init();
 
+        // schedules a background warm-up of the startup messages, _Mylock must be held exclusively
+        void _Schedule_warm_up() noexcept;
+
+        // warms up the startup messages in the current catalog
+        static void _Warm_up_task(void* const _Arg) noexcept;
+        void _Warm_up() const noexcept;
+
         mutable shared_lock _Mylock;
         translator_settings _Myset;
-        message_catalog _Mycat;
-        unicode_string _Myfbmsg;
+#pragma warning(suppress : 4251) // C4251: std::atomic<_Chain_ptr> needs to have dll-interface
+        ::std::atomic<_Chain_ptr> _Mychain; // null if no catalog is loaded
+#pragma warning(suppress : 4251) // C4251: std::atomic<std::shared_ptr> needs to have dll-interface
+        ::std::atomic<::std::shared_ptr<const unicode_string>> _Myfbmsg;
+        allocator* _Myal;
+#pragma warning(suppress : 4251) // C4251: startup_message_set needs to have dll-interface
+        startup_message_set _Mystartup;
+#pragma warning(suppress : 4251) // C4251: unique_smart_ptr needs to have dll-interface
+        unique_smart_ptr<thread> _Mywarmer; // created on first use
+        task _Mywarmup;
+        size_t _Mygen; // incremented whenever the catalog is replaced by the caller
+#pragma warning(suppress : 4251) // C4251: unique_smart_ptr needs to have dll-interface
+        unique_smart_ptr<umls_impl::_Hot_reloader> _Myreloader; // must be destroyed first
     };
 
     template <class... _Types>
     inline unicode_string get_message(const utf8_string_view _Id, _Types&&... _Args) {
-        translator& _Tr                 = translator::global();
-        const message_catalog& _Catalog = _Tr.catalog();
-        if (!_Catalog.is_open()) { // no catalog is open, return the fallback message
-            return _Tr.fallback_message();
-        }
-
-        const auto& [_Message, _Retrieved] = _Catalog.get_message(
-            _Id, ::mjx::make_format_args(::std::forward<_Types>(_Args)...));
-        return _Retrieved ? _Message : _Tr.fallback_message();
+        return translator::global().get_message(_Id, ::mjx::make_format_args(::std::forward<_Types>(_Args)...));
     }
 } // namespace mjx
 
@@ -3,10 +3,24 @@
 // Copyright (c) Mateusz Jandura. All rights reserved.
 // SPDX-License-Identifier: Apache-2.0
 
+#include <unit/umls/allocation_budget.hpp>
+#include <unit/umls/bundle.hpp>
+#include <unit/umls/catalog_format.hpp>
+#include <unit/umls/catalog_layers.hpp>
+#include <unit/umls/hot_reload.hpp>
+#include <unit/umls/message_ids.hpp>
+#include <unit/umls/profile.hpp>
+#include <unit/umls/settings_index.hpp>
+#include <unit/umls/statistics.hpp>
 #include <unit/umls/string_fmt.hpp>
+#include <unit/umls/transcode.hpp>
+#include <unit/umls/umc_builder.hpp>
 #include <unit/ure/color_cvt.hpp>
 
 int main() {
     ::testing::InitGoogleTest();
+    // Note: The settings, the bundle and the catalogs directory are resolved against the working directory
+    //       on first use, so running in a temporary one keeps the tests away from the real files.
+    const ::mjx::test::_Scoped_working_directory _Dir;
     return RUN_ALL_TESTS();
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+// allocation_budget.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_ALLOCATION_BUDGET_HPP_
+#define _TEST_UNIT_UMLS_ALLOCATION_BUDGET_HPP_
+#include <gtest/gtest.h>
+#include <mjstr/string.hpp>
+#include <umls/allocation_counter.hpp>
+#include <umls/catalog.hpp>
+#include <umls/format.hpp>
+#include <umls/format_arena.hpp>
+#include <umls/instance_allocator.hpp>
+#include <umls/translator.hpp>
+#include <unit/umls/umc_builder.hpp>
+#include <vector>
+
+namespace mjx {
+    namespace test {
+        inline byte_string _Make_budget_catalog() {
+            // builds a UMC image with one plain and one formattable message
+            return _Umc_builder{}
+                ._Message("budget.plain", "The catalog could not be opened because the file does not exist.")
+                ._Message("budget.formatted",
+                    "The catalog {%0} could not be opened because the file {%1} does not exist.")
+                ._Build();
+        }
+
+        class _Scoped_fallback_message { // replaces the global fallback message and restores it afterwards
+        public:
+            explicit _Scoped_fallback_message(const unicode_string_view _Message)
+                : _Myold(translator::global().fallback_message()) {
+                translator::global().fallback_message(_Message);
+            }
+
+            ~_Scoped_fallback_message() noexcept {
+                translator::global().fallback_message(_Myold);
+            }
+
+            _Scoped_fallback_message(const _Scoped_fallback_message&)            = delete;
+            _Scoped_fallback_message& operator=(const _Scoped_fallback_message&) = delete;
+
+        private:
+            unicode_string _Myold;
+        };
+
+        // Note: The budgets below are upper bounds on the number of allocations made through
+        //       the global allocator. A test fails if a change makes the path allocate more.
+
+        TEST(allocation_budget, is_formattable) {
+            allocation_scope _Scope;
+            EXPECT_TRUE(::mjx::is_formattable(L"The catalog {%0} could not be opened."));
+            EXPECT_FALSE(::mjx::is_formattable(L"The catalog could not be opened."));
+            EXPECT_EQ(_Scope.statistics().allocations, 0u);
+        }
+
+        TEST(allocation_budget, make_format_args) {
+            allocation_scope _Scope;
+            {
+                const format_args& _Args = ::mjx::make_format_args(L"first", L"second", L"third");
+                EXPECT_EQ(_Args.count(), 3u);
+            }
+
+            EXPECT_EQ(_Scope.statistics().allocations, 1u); // a single reservation for all arguments
+            EXPECT_EQ(_Scope.statistics().allocations, _Scope.statistics().deallocations);
+        }
+
+        TEST(allocation_budget, format_string) {
+            const format_args& _Args = ::mjx::make_format_args(L"settings.uts", L"C:\\locale\\settings.uts");
+            allocation_scope _Scope;
+            {
+                const unicode_string& _Str = ::mjx::format_string(
+                    L"The catalog {%0} could not be opened because the file {%1} does not exist.", _Args);
+                EXPECT_FALSE(_Str.empty());
+            }
+
+            EXPECT_LE(_Scope.statistics().allocations, 2u); // reservation and shrinking
+            EXPECT_EQ(_Scope.statistics().allocations, _Scope.statistics().deallocations);
+        }
+
+        TEST(allocation_budget, catalog_has_message) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            allocation_scope _Scope;
+            EXPECT_TRUE(_Catalog.has_message("budget.plain"));
+            EXPECT_FALSE(_Catalog.has_message("budget.missing"));
+            EXPECT_EQ(_Scope.statistics().allocations, 0u);
+        }
+
+        TEST(allocation_budget, catalog_warm_up) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            allocation_scope _Scope;
+            EXPECT_EQ(_Catalog.warm_up({"budget.plain", "budget.missing", "budget.formatted"}), 2u);
+            EXPECT_EQ(_Scope.statistics().allocations, 0u);
+        }
+
+        TEST(allocation_budget, catalog_get_message_miss) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            allocation_scope _Scope;
+            EXPECT_FALSE(_Catalog.get_message("budget.missing").retrieved);
+            EXPECT_EQ(_Scope.statistics().allocations, 0u);
+        }
+
+        TEST(allocation_budget, catalog_get_message_plain) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            allocation_scope _Scope;
+            EXPECT_TRUE(_Catalog.get_message("budget.plain").retrieved);
+            EXPECT_LE(_Scope.statistics().allocations, 1u); // decoded message only
+        }
+
+        TEST(allocation_budget, catalog_get_message_formatted) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            const format_args& _Args = ::mjx::make_format_args(L"settings.uts", L"C:\\locale\\settings.uts");
+            ASSERT_TRUE(_Catalog.is_open());
+            allocation_scope _Scope;
+            EXPECT_TRUE(_Catalog.get_message("budget.formatted", _Args).retrieved);
+            EXPECT_LE(_Scope.statistics().allocations, 3u); // decoded message and formatting
+        }
+
+        TEST(allocation_budget, catalog_get_utf8_message) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            const utf8_format_args& _Args = ::mjx::make_utf8_format_args("settings.uts", "C:\\locale\\settings.uts");
+            ASSERT_TRUE(_Catalog.is_open());
+            allocation_scope _Scope;
+            EXPECT_TRUE(_Catalog.get_utf8_message("budget.plain").retrieved);
+            EXPECT_LE(_Scope.statistics().allocations, 1u); // copied message only
+            _Scope.reset();
+            const auto& _Result = _Catalog.get_utf8_message("budget.formatted", _Args);
+            EXPECT_TRUE(_Result.retrieved);
+            EXPECT_EQ(_Result.message, "The catalog settings.uts could not be opened because the file "
+                "C:\\locale\\settings.uts does not exist.");
+            EXPECT_LE(_Scope.statistics().allocations, 2u); // formatted straight from the blob
+        }
+
+        TEST(allocation_budget, translator_get_message_miss) {
+            allocation_scope _Scope; // the translator may be created in the scope, it must not keep the counter
+            const _Scoped_fallback_message _Fallback(
+                L"The message is not available at the moment, please try again later.");
+            _Scope.reset();
+            EXPECT_FALSE(::mjx::get_message("budget.missing", L"first", L"second").empty());
+            EXPECT_LE(_Scope.statistics().allocations, 2u); // arguments and fallback message copy
+        }
+
+        TEST(allocation_budget, format_args_using_allocator) {
+            allocation_counter _Counter(::mjx::get_allocator());
+            allocation_scope _Scope;
+            {
+                const format_args& _Args = ::mjx::make_format_args_using_allocator(_Counter, L"first", L"second");
+                EXPECT_EQ(_Args.count(), 2u);
+            }
+
+            EXPECT_EQ(_Counter.statistics().allocations, 1u);
+            EXPECT_EQ(_Scope.statistics().allocations, 0u); // nothing allocated from the global allocator
+        }
+
+        TEST(allocation_budget, catalog_using_allocator) {
+            const byte_string& _Data = _Make_budget_catalog();
+            allocation_counter _Counter(::mjx::get_allocator());
+            {
+                const message_catalog _Catalog(_Data, catalog_buffer_mode::copy, _Counter);
+                ASSERT_TRUE(_Catalog.is_open());
+                EXPECT_EQ(_Counter.statistics().allocations, 1u); // table and blob share a single block
+            }
+
+            EXPECT_EQ(_Counter.statistics().deallocations, 1u);
+        }
+
+        TEST(allocation_budget, format_arena_burst) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            const format_args& _Args = ::mjx::make_format_args(L"settings.uts", L"C:\\locale\\settings.uts");
+            ASSERT_TRUE(_Catalog.is_open());
+            format_arena _Arena;
+            const size_t _Reserved = _Arena.reserved();
+            allocation_scope _Scope;
+            for (size_t _Iter = 0; _Iter < 64; ++_Iter) {
+                const auto& _Result = _Catalog.get_message("budget.formatted", _Args, _Arena);
+                EXPECT_TRUE(_Result.retrieved);
+                EXPECT_EQ(_Result.message, L"The catalog settings.uts could not be opened because the file "
+                    L"C:\\locale\\settings.uts does not exist.");
+            }
+
+            EXPECT_EQ(_Scope.statistics().allocations, 0u); // the messages are allocated by the arena
+            EXPECT_GT(_Arena.used(), 0u);
+            EXPECT_EQ(_Arena.reserved(), _Reserved); // the whole burst fits in the first block
+            _Arena.release();
+            EXPECT_EQ(_Arena.used(), 0u);
+        }
+
+        TEST(allocation_budget, instance_allocator_outlives_scope) {
+            ::std::vector<int, instance_allocator<int>> _Vec;
+            {
+                allocation_scope _Scope;
+                _Vec.reserve(4);
+                EXPECT_EQ(_Scope.statistics().allocations, 1u); // counted by the scope
+            }
+
+            _Vec.assign(8, 1); // the vector does not refer to the destroyed counter
+            EXPECT_EQ(_Vec.size(), 8u);
+            EXPECT_EQ(&_Vec.get_allocator().resource(), &::mjx::persistent_allocator());
+        }
+
+        TEST(allocation_budget, format_arena_results) {
+            const format_args& _Args           = ::mjx::make_format_args(L"result");
+            const utf8_format_args& _Utf8_args = ::mjx::make_utf8_format_args("first", "second");
+            format_arena _Arena;
+            allocation_scope _Scope;
+            const unicode_string_view _Str     = ::mjx::format_string(L"{%0} and {%0}", _Args, _Arena);
+            const utf8_string_view _Utf8_str   = ::mjx::format_string("{%0} and {%1}", _Utf8_args, _Arena);
+            EXPECT_EQ(_Str, L"result and result");
+            EXPECT_EQ(_Utf8_str, "first and second");
+            EXPECT_TRUE(::mjx::format_string(L"{%1}", _Args, _Arena).empty()); // missing argument
+            EXPECT_GE(_Arena.used(), _Str.size() * sizeof(wchar_t) + _Utf8_str.size());
+            EXPECT_EQ(_Scope.statistics().allocations, 0u); // the results are allocated by the arena
+            _Arena.release(); // the results are reclaimed at once
+            EXPECT_EQ(_Arena.used(), 0u);
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_ALLOCATION_BUDGET_HPP_
\ No newline at end of file
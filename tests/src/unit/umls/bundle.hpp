@@ -0,0 +1,89 @@
+// bundle.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_BUNDLE_HPP_
+#define _TEST_UNIT_UMLS_BUNDLE_HPP_
+#include <cstring>
+#include <gtest/gtest.h>
+#include <mjfs/path.hpp>
+#include <mjstr/string.hpp>
+#include <umls/catalog.hpp>
+#include <umls/impl/bundle.hpp>
+#include <umls/impl/translator_state.hpp>
+#include <unit/umls/umc_builder.hpp>
+
+namespace mjx {
+    namespace test {
+        inline byte_string _Make_test_bundle(const char* const* const _Names, const uint32_t* const _Lcids,
+            const byte_string* const _Images, const size_t _Count) {
+            // lays the catalogs out the way mkuts does, each lookup table starts at a 16-byte boundary
+            constexpr size_t _Header_size = sizeof(umls_impl::_Uts_static_data);
+            constexpr size_t _Entry_size  = umls_impl::_Catalog_bundle::_Entry_size;
+            byte_string _Bundle;
+            _Bundle.append(reinterpret_cast<const byte_t*>("UMB\0"), 4);
+            _Append_le_integer(_Bundle, 0x0409, 4);
+            _Append_le_integer(_Bundle, 0x0409, 4);
+            _Append_le_integer(_Bundle, _Count, 2);
+
+            byte_string _Data;
+            size_t _End = _Header_size + _Count * _Entry_size;
+            for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+                const byte_string& _Image = _Images[_Idx];
+                const size_t _Table_off   = _Image[3] == 0 ? 5 + _Image[4] + 8 : 6 + _Image[5] + 8;
+                const size_t _Off         = ((_End + _Table_off + 15) & ~size_t{15}) - _Table_off;
+                byte_t _Name[umls_impl::_Catalog_bundle::_Name_size] = {};
+                ::memcpy(_Name, _Names[_Idx], ::strlen(_Names[_Idx]));
+                _Bundle.append(_Name, sizeof(_Name));
+                _Append_le_integer(_Bundle, _Lcids[_Idx], 4);
+                _Append_le_integer(_Bundle, _Off, 8);
+                _Append_le_integer(_Bundle, _Image.size(), 8);
+                _Data.resize(_Off - _Header_size - _Count * _Entry_size, byte_t{0});
+                _Data.append(_Image);
+                _End = _Off + _Image.size();
+            }
+
+            _Bundle.append(_Data);
+            return _Bundle;
+        }
+
+        TEST(bundle, lookup_matches_standalone_catalog) {
+            const byte_string _Images[] = {
+                _Umc_builder{"pl-PL", 0x0415}._Message("bundle.text", "Tekst")._Build(),
+                _Umc_builder{"en-US", 0x0409}._Version(1, 0)._Message("bundle.text", "Text")
+                    ._Message("bundle.other", "Other")._Build()
+            };
+            const char* const _Names[] = {"pl-PL.umc", "en-US.umc"};
+            const uint32_t _Lcids[]    = {0x0415, 0x0409};
+            const _Scoped_test_file _File(::mjx::current_path() / L"umls_test.umb");
+            ASSERT_TRUE(_File._Write(_Make_test_bundle(_Names, _Lcids, _Images, 2)));
+
+            umls_impl::_Catalog_bundle _Bundle;
+            ASSERT_TRUE(_Bundle._Open(_File._Path()));
+            ASSERT_EQ(_Bundle._Catalog_count(), 2u);
+            translator_catalogs _Catalogs;
+            for (size_t _Idx = 0; _Idx < _Bundle._Catalog_count(); ++_Idx) {
+                _Catalogs.push_back(_Bundle._Catalog_at(_Idx));
+            }
+
+            umls_impl::_Settings_snapshot _Settings;
+            ASSERT_TRUE(umls_impl::_Index_catalogs(_Settings, _Catalogs));
+            EXPECT_EQ(_Settings._Index._Find_name(L"de-DE.umc"), umls_impl::_Uts_catalog_index::_Npos);
+            const size_t _Idx = _Settings._Index._Find_name(L"en-US.umc");
+            ASSERT_EQ(_Idx, 1u);
+
+            // the bundled catalog is borrowed straight from the mapping
+            const message_catalog _Bundled(_Bundle._Catalog_data(_Idx), catalog_buffer_mode::borrow);
+            const message_catalog _Standalone(_Images[1]);
+            ASSERT_TRUE(_Bundled.is_open());
+            ASSERT_TRUE(_Standalone.is_open());
+            EXPECT_EQ(_Bundled.lcid(), _Standalone.lcid());
+            EXPECT_EQ(_Bundled.get_message("bundle.text").message, _Standalone.get_message("bundle.text").message);
+            EXPECT_EQ(_Bundled.get_message("bundle.other").message, L"Other");
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_BUNDLE_HPP_
\ No newline at end of file
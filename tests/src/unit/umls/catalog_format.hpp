@@ -0,0 +1,120 @@
+// catalog_format.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_CATALOG_FORMAT_HPP_
+#define _TEST_UNIT_UMLS_CATALOG_FORMAT_HPP_
+#include <gtest/gtest.h>
+#include <mjstr/string.hpp>
+#include <umls/catalog.hpp>
+#include <unit/umls/umc_builder.hpp>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    namespace test {
+        inline byte_string _Make_wide_catalog(const byte_t _Version, const byte_t _Encoding) {
+            // builds a UMC image with the text stored as wchar_t
+            return _Umc_builder{}
+                ._Version(_Version, _Encoding)
+                ._Message("wide.plain", L"The catalog could not be opened.")
+                ._Message("wide.formatted", L"The catalog {%0} could not be opened.")
+                ._Build();
+        }
+
+        inline constexpr byte_t _Native_encoding  = sizeof(wchar_t) == 2 ? 1 : 2;
+        inline constexpr byte_t _Foreign_encoding = sizeof(wchar_t) == 2 ? 2 : 1;
+
+        TEST(catalog_format, native_text) {
+            for (const catalog_buffer_mode _Mode : {catalog_buffer_mode::copy, catalog_buffer_mode::borrow}) {
+                const byte_string& _Data = _Make_wide_catalog(1, _Native_encoding);
+                const message_catalog _Catalog(_Data, _Mode);
+                ASSERT_TRUE(_Catalog.is_open());
+                EXPECT_EQ(_Catalog.language(), L"en-US");
+                EXPECT_EQ(_Catalog.get_message("wide.plain").message, L"The catalog could not be opened.");
+                EXPECT_EQ(_Catalog.get_message("wide.formatted", ::mjx::make_format_args(L"en-US.umc")).message,
+                    L"The catalog en-US.umc could not be opened.");
+                EXPECT_EQ(_Catalog.get_utf8_message("wide.plain").message, "The catalog could not be opened.");
+            }
+        }
+
+        TEST(catalog_format, utf8_text_with_version) {
+            const message_catalog _Catalog(_Umc_builder{}._Version(1, 0)._Message("utf8.plain", "Plain")._Build());
+            ASSERT_TRUE(_Catalog.is_open()); // version 1, UTF-8 text
+            EXPECT_EQ(_Catalog.get_message("utf8.plain").message, L"Plain");
+        }
+
+        TEST(catalog_format, rejected_headers) {
+            EXPECT_FALSE(message_catalog(_Make_wide_catalog(1, _Foreign_encoding)).is_open()); // other width
+            EXPECT_FALSE(message_catalog(_Make_wide_catalog(1, 3)).is_open()); // unknown encoding
+            EXPECT_FALSE(message_catalog(_Make_wide_catalog(2, _Native_encoding)).is_open()); // unknown version
+        }
+
+        TEST(catalog_format, untrusted_sizes) {
+            const utf8_string _Long_language(255, 'x'); // the largest length the header can store
+            byte_string _Data = _Umc_builder{_Long_language.c_str(), 0x0409}._Message("size.plain", "Text")._Build();
+            for (const catalog_buffer_mode _Mode : {catalog_buffer_mode::copy, catalog_buffer_mode::borrow}) {
+                const message_catalog _Catalog(_Data, _Mode);
+                ASSERT_TRUE(_Catalog.is_open());
+                EXPECT_EQ(_Catalog.language().size(), 255u);
+                EXPECT_EQ(_Catalog.lcid(), 0x0409u);
+            }
+
+            // a message count whose table size would wrap around must be rejected, not trusted
+            const size_t _Count_off = 4 + 1 + _Long_language.size() + 4;
+            for (size_t _Idx = 0; _Idx < 4; ++_Idx) {
+                _Data[_Count_off + _Idx] = byte_t{0xFF};
+            }
+
+            EXPECT_FALSE(message_catalog(_Data, catalog_buffer_mode::copy).is_open());
+            EXPECT_FALSE(message_catalog(_Data, catalog_buffer_mode::borrow).is_open());
+        }
+
+        TEST(catalog_format, borrowed_equals_copied) {
+            const byte_string& _Data = _Umc_builder{"pl-PL", 0x0415}._Version(1, 0)._With_ids()
+                ._Message("buffer.plain", "Tekst")._Message("buffer.formatted", "Plik {%0} jest pusty.")._Build();
+            const message_catalog _Copied(_Data, catalog_buffer_mode::copy);
+            const message_catalog _Borrowed(_Data, catalog_buffer_mode::borrow);
+            ASSERT_TRUE(_Copied.is_open());
+            ASSERT_TRUE(_Borrowed.is_open());
+            EXPECT_EQ(_Borrowed.language(), _Copied.language());
+            EXPECT_EQ(_Borrowed.lcid(), _Copied.lcid());
+            EXPECT_EQ(_Borrowed.has_message_ids(), _Copied.has_message_ids());
+            EXPECT_EQ(_Borrowed.get_message("buffer.plain").message, _Copied.get_message("buffer.plain").message);
+            const format_args& _Args = ::mjx::make_format_args(L"settings.uts");
+            EXPECT_EQ(_Borrowed.get_message("buffer.formatted", _Args).message,
+                _Copied.get_message("buffer.formatted", _Args).message);
+            EXPECT_FALSE(_Borrowed.get_message("buffer.missing").retrieved);
+
+            // only the borrowed catalog refers to the caller's buffer
+            EXPECT_EQ(_Copied.memory_usage().borrowed_bytes, 0u);
+            EXPECT_GT(_Borrowed.memory_usage().borrowed_bytes, 0u);
+        }
+
+        TEST(catalog_format, static_catalog) {
+            // builds the data the way mkuts embeds it, the entries sorted by hash and the blob stored as UTF-8
+            static constexpr byte_t _Blob[] = {'F', 'i', 'r', 's', 't', 'S', 'e', 'c', 'o', 'n', 'd'};
+            static_catalog_entry _Entries[2] = {{::XXH3_64bits("static.first", 12), 0, 5},
+                {::XXH3_64bits("static.second", 13), 5, 6}};
+            if (_Entries[0].hash > _Entries[1].hash) {
+                ::std::swap(_Entries[0], _Entries[1]);
+            }
+
+            const static_catalog _Data = {L"pl-PL", 0x0415, _Entries, 2, _Blob, sizeof(_Blob)};
+            message_catalog _Constructed(_Data);
+            message_catalog _Opened;
+            ASSERT_TRUE(_Opened.open(_Data));
+            for (const message_catalog* const _Catalog : {&_Constructed, &_Opened}) {
+                ASSERT_TRUE(_Catalog->is_open());
+                EXPECT_EQ(_Catalog->language(), L"pl-PL");
+                EXPECT_EQ(_Catalog->lcid(), 0x0415u);
+                EXPECT_EQ(_Catalog->get_message("static.first").message, L"First");
+                EXPECT_EQ(_Catalog->get_message("static.second").message, L"Second");
+                EXPECT_FALSE(_Catalog->get_message("static.missing").retrieved);
+            }
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_CATALOG_FORMAT_HPP_
\ No newline at end of file
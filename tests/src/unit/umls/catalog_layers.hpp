@@ -0,0 +1,47 @@
+// catalog_layers.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_CATALOG_LAYERS_HPP_
+#define _TEST_UNIT_UMLS_CATALOG_LAYERS_HPP_
+#include <gtest/gtest.h>
+#include <umls/catalog.hpp>
+#include <unit/umls/umc_builder.hpp>
+
+namespace mjx {
+    namespace test {
+        TEST(catalog_layers, overlay_beats_base) {
+            message_catalog _Catalog(_Umc_builder{}
+                ._Message("layers.fixed", "Base text")._Message("layers.kept", "Kept text")._Build());
+            ASSERT_TRUE(_Catalog.is_open());
+            ASSERT_TRUE(_Catalog.attach_overlay(message_catalog{
+                _Umc_builder{}._Message("layers.fixed", "Hotfix text")._Build()}));
+            EXPECT_TRUE(_Catalog.has_overlay());
+            EXPECT_EQ(_Catalog.get_message("layers.fixed").message, L"Hotfix text");
+            EXPECT_EQ(_Catalog.get_message("layers.kept").message, L"Kept text"); // missing in the overlay
+
+            _Catalog.detach_overlay();
+            EXPECT_EQ(_Catalog.get_message("layers.fixed").message, L"Base text");
+        }
+
+        TEST(catalog_layers, fallback_hit_for_missing_id) {
+            message_catalog _Catalog(_Umc_builder{"en-US", 0x0409}._Message("layers.own", "Own text")._Build());
+            ASSERT_TRUE(_Catalog.is_open());
+            EXPECT_FALSE(_Catalog.get_message("layers.missing").retrieved);
+            ASSERT_TRUE(_Catalog.attach_fallback(message_catalog{_Umc_builder{"pl-PL", 0x0415}
+                ._Message("layers.own", "Tekst")._Message("layers.missing", "Tekst zapasowy")._Build()}));
+            EXPECT_EQ(_Catalog.fallback_count(), 1u);
+
+            const message_catalog::message_retrieval_result& _Result = _Catalog.get_message("layers.missing");
+            EXPECT_TRUE(_Result.retrieved);
+            EXPECT_EQ(_Result.message, L"Tekst zapasowy");
+            EXPECT_EQ(_Catalog.get_message("layers.own").message, L"Own text"); // the catalog comes first
+            EXPECT_FALSE(_Catalog.get_message("layers.nowhere").retrieved);
+            EXPECT_EQ(_Catalog.lcid(), 0x0409u);
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_CATALOG_LAYERS_HPP_
\ No newline at end of file
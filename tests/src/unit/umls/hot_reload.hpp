@@ -0,0 +1,70 @@
+// hot_reload.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_HOT_RELOAD_HPP_
+#define _TEST_UNIT_UMLS_HOT_RELOAD_HPP_
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <umls/translator.hpp>
+#include <unit/umls/umc_builder.hpp>
+
+namespace mjx {
+    namespace test {
+        class _Scoped_translator_state { // restores the catalog and hot reload state of the translator
+        public:
+            explicit _Scoped_translator_state(translator& _Tr)
+                : _Mytr(_Tr), _Mycatalog(_Tr.catalog()), _Myhot_reload(_Tr.hot_reload_enabled()) {}
+
+            ~_Scoped_translator_state() noexcept {
+                try {
+                    _Mytr.enable_hot_reload(_Myhot_reload);
+                } catch (...) {
+                    // ignore the thrown exception, the catalog is restored regardless
+                }
+
+                _Mytr.restore_catalog(_Mycatalog);
+            }
+
+            _Scoped_translator_state(const _Scoped_translator_state&)            = delete;
+            _Scoped_translator_state& operator=(const _Scoped_translator_state&) = delete;
+
+        private:
+            translator& _Mytr;
+            catalog_snapshot _Mycatalog;
+            bool _Myhot_reload;
+        };
+
+        TEST(hot_reload, serves_rewritten_catalog) {
+            // Note: The tests run in a temporary working directory, so the catalogs directory is temporary too.
+            const _Scoped_test_file _File(translator_settings::catalogs_directory() / L"umls_hot_reload.umc");
+            ASSERT_TRUE(_File._Write(_Umc_builder{}._Message("reload.text", "Old text")._Build()));
+            translator& _Tr = translator::global();
+            const _Scoped_translator_state _State(_Tr); // destroyed before the file is deleted
+            ASSERT_TRUE(_Tr.use_catalog(L"umls_hot_reload.umc"));
+            EXPECT_EQ(_Tr.get_message("reload.text"), L"Old text");
+
+            const catalog_snapshot& _Old = _Tr.catalog();
+            ASSERT_TRUE(_Tr.enable_hot_reload(true));
+            ASSERT_TRUE(_File._Write(_Umc_builder{}._Message("reload.text", "New text")._Build()));
+            unicode_string _Text;
+            for (size_t _Attempt = 0; _Attempt < 100; ++_Attempt) { // the reload is debounced, wait up to 5s
+                _Text = _Tr.get_message("reload.text");
+                if (_Text == L"New text") {
+                    break;
+                }
+
+                ::std::this_thread::sleep_for(::std::chrono::milliseconds(50));
+            }
+
+            EXPECT_TRUE(_Tr.enable_hot_reload(false));
+            EXPECT_EQ(_Text, L"New text");
+            EXPECT_EQ(_Old->get_message("reload.text").message, L"Old text"); // the old snapshot stays valid
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_HOT_RELOAD_HPP_
\ No newline at end of file
@@ -0,0 +1,71 @@
+// message_ids.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_MESSAGE_IDS_HPP_
+#define _TEST_UNIT_UMLS_MESSAGE_IDS_HPP_
+#include <gtest/gtest.h>
+#include <mjstr/string.hpp>
+#include <umls/catalog.hpp>
+#include <unit/umls/umc_builder.hpp>
+
+namespace mjx {
+    namespace test {
+        inline byte_string _Make_id_catalog() {
+            // builds a UMC image with the ID section, "menu.hidden" is stored under the hash of "menu.alias"
+            // to simulate a hash collision
+            return _Umc_builder{}
+                ._Message("settings.video", "Video")
+                ._Message("menu.hidden", "menu.alias", "Hidden", 6)
+                ._Message("settings.audio", "Audio")
+                ._With_ids()
+                ._Build();
+        }
+
+        TEST(message_ids, prefix_enumeration) {
+            const byte_string& _Data = _Make_id_catalog();
+            for (const catalog_buffer_mode _Mode : {catalog_buffer_mode::copy, catalog_buffer_mode::borrow}) {
+                const message_catalog _Catalog(_Data, _Mode);
+                ASSERT_TRUE(_Catalog.is_open());
+                ASSERT_TRUE(_Catalog.has_message_ids());
+                EXPECT_EQ(_Catalog.message_ids().size(), 3u);
+
+                const message_id_list& _Ids = _Catalog.message_ids("settings.");
+                ASSERT_EQ(_Ids.size(), 2u);
+                EXPECT_EQ(_Ids[0], "settings.audio");
+                EXPECT_EQ(_Ids[1], "settings.video");
+                EXPECT_TRUE(_Catalog.message_ids("settings.z").empty());
+            }
+
+            EXPECT_FALSE(message_catalog(_Umc_builder{}._Message("menu.plain", "Plain")._Build()).has_message_ids());
+        }
+
+        TEST(message_ids, namespace_retrieval) {
+            const message_catalog _Catalog(_Make_id_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            const auto& _Result = _Catalog.get_namespace("settings.");
+            ASSERT_EQ(_Result.messages.size(), 2u);
+            EXPECT_EQ(_Result.text, L"AudioVideo");
+            EXPECT_EQ(_Result.messages[0].id, "settings.audio");
+            EXPECT_EQ(_Result.message(0), L"Audio");
+            EXPECT_EQ(_Result.message(1), L"Video");
+        }
+
+        TEST(message_ids, strict_lookup) {
+            message_catalog _Catalog(_Make_id_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            EXPECT_TRUE(_Catalog.get_message("menu.alias").retrieved); // hash hit, accepted by default
+
+            _Catalog.strict_lookup(true);
+            EXPECT_TRUE(_Catalog.strict_lookup());
+            EXPECT_FALSE(_Catalog.get_message("menu.alias").retrieved); // the stored ID does not match
+            EXPECT_FALSE(_Catalog.has_message("menu.alias"));
+            EXPECT_TRUE(_Catalog.get_message("settings.audio").retrieved);
+            EXPECT_TRUE(_Catalog.get_utf8_message("settings.video").retrieved);
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_MESSAGE_IDS_HPP_
\ No newline at end of file
@@ -0,0 +1,63 @@
+// profile.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_PROFILE_HPP_
+#define _TEST_UNIT_UMLS_PROFILE_HPP_
+#include <gtest/gtest.h>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <umls/catalog.hpp>
+#include <umls/profile.hpp>
+#include <unit/umls/allocation_budget.hpp>
+#include <unit/umls/umc_builder.hpp>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    namespace test {
+        TEST(profile, hottest_message_first) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            reset_message_profile();
+            enable_message_profiling(true);
+            for (size_t _Iter = 0; _Iter < 8; ++_Iter) {
+                EXPECT_TRUE(_Catalog.get_message("budget.formatted", ::mjx::make_format_args(L"a", L"b")).retrieved);
+            }
+
+            EXPECT_TRUE(_Catalog.get_message("budget.plain").retrieved);
+            EXPECT_FALSE(_Catalog.get_message("budget.missing").retrieved); // misses are not recorded
+            enable_message_profiling(false);
+            EXPECT_TRUE(_Catalog.get_message("budget.plain").retrieved); // not recorded either
+
+            const _Scoped_test_file _Target(L"umls_test.ump"); // deleted even if an assertion fails
+            ASSERT_TRUE(write_message_profile(_Target._Path()));
+            reset_message_profile();
+
+            byte_t _Data[40]; // header and two entries
+            {
+                file _File(_Target._Path(), file_access::read, file_share::read);
+                file_stream _Stream(_File);
+                ASSERT_TRUE(_Stream.is_open());
+                ASSERT_EQ(_File.size(), sizeof(_Data));
+                ASSERT_TRUE(_Stream.read_exactly(_Data, sizeof(_Data)));
+            }
+
+            uint32_t _Count;
+            uint64_t _Hottest[2];
+            uint64_t _Coldest[2];
+            ::memcpy(&_Count, _Data + 4, sizeof(_Count));
+            ::memcpy(_Hottest, _Data + 8, sizeof(_Hottest));
+            ::memcpy(_Coldest, _Data + 24, sizeof(_Coldest));
+            EXPECT_EQ(::memcmp(_Data, "UMP\0", 4), 0);
+            EXPECT_EQ(_Count, 2u);
+            EXPECT_EQ(_Hottest[0], ::XXH3_64bits("budget.formatted", 16));
+            EXPECT_EQ(_Hottest[1], 8u);
+            EXPECT_EQ(_Coldest[0], ::XXH3_64bits("budget.plain", 12));
+            EXPECT_EQ(_Coldest[1], 1u);
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_PROFILE_HPP_
\ No newline at end of file
@@ -0,0 +1,83 @@
+// settings_index.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_SETTINGS_INDEX_HPP_
+#define _TEST_UNIT_UMLS_SETTINGS_INDEX_HPP_
+#include <gtest/gtest.h>
+#include <mjstr/string.hpp>
+#include <umls/impl/uts_index.hpp>
+#include <umls/translator.hpp>
+
+namespace mjx {
+    namespace test {
+        inline bool _Make_settings_index(umls_impl::_Uts_catalog_index& _Index) {
+            // "pl-PL.umc" and "en-GB.umc" share an LCID on purpose, the first installed one must win
+            const translator_catalog _Catalogs[] = {
+                {L"pl-PL.umc", 0x0415, 120, 4096, 0x1111},
+                {L"en-US.umc", 0x0409, 100, 2048, 0x2222},
+                {L"de-DE.umc", 0x0407, 110, 3072, 0x3333},
+                {L"pl-PL-alt.umc", 0x0415, 90, 1024, 0x4444}
+            };
+
+            byte_string _Tables;
+            uint32_t _Slot_count;
+            uint32_t _String_table_size;
+            if (!umls_impl::_Make_uts_tables(_Catalogs, 4, _Tables, _Slot_count, _String_table_size)) {
+                return false;
+            }
+
+            return _Index._Assign(::std::move(_Tables), 4, _Slot_count, _String_table_size);
+        }
+
+        TEST(settings_index, lcid_lookup) {
+            umls_impl::_Uts_catalog_index _Index;
+            ASSERT_TRUE(_Make_settings_index(_Index));
+            EXPECT_EQ(_Index._Name(_Index._Find_lcid(0x0409)), L"en-US.umc");
+            EXPECT_EQ(_Index._Name(_Index._Find_lcid(0x0407)), L"de-DE.umc");
+            EXPECT_EQ(_Index._Name(_Index._Find_lcid(0x0415)), L"pl-PL.umc");
+            EXPECT_EQ(_Index._Find_lcid(0x0411), umls_impl::_Uts_catalog_index::_Npos);
+        }
+
+        TEST(settings_index, name_lookup) {
+            umls_impl::_Uts_catalog_index _Index;
+            ASSERT_TRUE(_Make_settings_index(_Index));
+            EXPECT_EQ(_Index._Find_name(L"pl-PL-alt.umc"), 3u);
+            EXPECT_EQ(_Index._Find_name(L"en-US.umc"), 1u);
+            EXPECT_EQ(_Index._Find_name(L"en-US"), umls_impl::_Uts_catalog_index::_Npos);
+            EXPECT_EQ(_Index._Find_name(L""), umls_impl::_Uts_catalog_index::_Npos);
+
+            const translator_catalog& _Catalog = _Index._Catalog_at(_Index._Find_name(L"de-DE.umc"));
+            EXPECT_EQ(_Catalog.name, L"de-DE.umc");
+            EXPECT_EQ(_Catalog.lcid, 0x0407u);
+            EXPECT_EQ(_Catalog.message_count, 110u);
+            EXPECT_EQ(_Catalog.size, 3072u);
+            EXPECT_EQ(_Catalog.checksum, 0x3333u);
+        }
+
+        TEST(settings_index, corrupted_tables) {
+            const translator_catalog _Catalog = {L"en-US.umc", 0x0409};
+            byte_string _Tables;
+            uint32_t _Slot_count;
+            uint32_t _String_table_size;
+            ASSERT_TRUE(umls_impl::_Make_uts_tables(&_Catalog, 1, _Tables, _Slot_count, _String_table_size));
+
+            umls_impl::_Uts_catalog_index _Index;
+            byte_string _Truncated = _Tables.substr(0, _Tables.size() - 2);
+            EXPECT_FALSE(_Index._Assign(::std::move(_Truncated), 1, _Slot_count, _String_table_size));
+
+            byte_string _Bad_name = _Tables;
+            _Bad_name[0]          = byte_t{0xFF}; // the name offset exceeds the string table
+            EXPECT_FALSE(_Index._Assign(::std::move(_Bad_name), 1, _Slot_count, _String_table_size));
+            EXPECT_EQ(_Index._Size(), 0u);
+            EXPECT_EQ(_Index._Find_name(L"en-US.umc"), umls_impl::_Uts_catalog_index::_Npos);
+
+            EXPECT_TRUE(_Index._Assign(::std::move(_Tables), 1, _Slot_count, _String_table_size));
+            EXPECT_EQ(_Index._Find_name(L"en-US.umc"), 0u);
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_SETTINGS_INDEX_HPP_
\ No newline at end of file
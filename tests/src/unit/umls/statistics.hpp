@@ -0,0 +1,57 @@
+// statistics.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_STATISTICS_HPP_
+#define _TEST_UNIT_UMLS_STATISTICS_HPP_
+#include <gtest/gtest.h>
+#include <umls/catalog.hpp>
+#include <umls/statistics.hpp>
+#include <unit/umls/allocation_budget.hpp>
+
+namespace mjx {
+    namespace test {
+        TEST(statistics, counts_and_reset) {
+            const message_catalog _Catalog(_Make_budget_catalog());
+            ASSERT_TRUE(_Catalog.is_open());
+            reset_catalog_statistics();
+            enable_catalog_statistics(true);
+            EXPECT_TRUE(catalog_statistics_enabled());
+            EXPECT_TRUE(_Catalog.get_message("budget.plain").retrieved);
+            EXPECT_TRUE(_Catalog.get_message("budget.formatted", ::mjx::make_format_args(L"a", L"b")).retrieved);
+            EXPECT_TRUE(_Catalog.get_utf8_message("budget.plain").retrieved); // UTF-8 text, nothing transcoded
+            EXPECT_FALSE(_Catalog.get_message("budget.missing").retrieved);
+            enable_catalog_statistics(false);
+            EXPECT_TRUE(_Catalog.get_message("budget.plain").retrieved); // not recorded
+
+            const size_t _Plain_size = ::strlen("The catalog could not be opened because the file does not exist.");
+            const size_t _Formatted_size =
+                ::strlen("The catalog {%0} could not be opened because the file {%1} does not exist.");
+            catalog_statistics _Stats = collect_catalog_statistics();
+            uint64_t _Latencies       = 0;
+            for (const uint64_t _Bucket : _Stats.latency_histogram) {
+                _Latencies += _Bucket;
+            }
+
+            EXPECT_EQ(_Stats.lookups, 4u);
+            EXPECT_EQ(_Stats.hits, 3u);
+            EXPECT_EQ(_Stats.misses, 1u);
+            EXPECT_EQ(_Stats.plain_messages, 2u);
+            EXPECT_EQ(_Stats.formatted_messages, 1u);
+            EXPECT_EQ(_Stats.transcoded_bytes, _Plain_size + _Formatted_size);
+            EXPECT_EQ(_Latencies, 4u);
+
+            reset_catalog_statistics();
+            _Stats = collect_catalog_statistics();
+            EXPECT_EQ(_Stats.lookups, 0u);
+            EXPECT_EQ(_Stats.hits, 0u);
+            EXPECT_EQ(_Stats.misses, 0u);
+            EXPECT_EQ(_Stats.transcoded_bytes, 0u);
+            EXPECT_TRUE(_Stats.top_missing_messages.empty());
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_STATISTICS_HPP_
\ No newline at end of file
@@ -215,6 +215,29 @@ namespace mjx {
                 L"3 volunteers dedicated 50 hours to clean up 6 local parks, making a positive impact."
             );
         }
+
+        TEST(string_fmt, utf8_formattable) {
+            EXPECT_FALSE(::mjx::is_formattable(""));
+            EXPECT_FALSE(::mjx::is_formattable("The {% 1} fox jumped over the lazy {% x} in the {% } moonlight."));
+            EXPECT_FALSE(::mjx::is_formattable("Der Fuchs sprang \xC3\xBC" "ber den faulen Hund."));
+            EXPECT_TRUE(::mjx::is_formattable("The {%2} friends shared {%4} pizzas at the {%10} gathering."));
+            EXPECT_TRUE(::mjx::is_formattable("\xD0\x9A\xD0\xB0\xD1\x82\xD0\xB0\xD0\xBB\xD0\xBE\xD0\xB3 {%0}."));
+        }
+
+        TEST(string_fmt, utf8_format) {
+            EXPECT_TRUE(::mjx::format_string("", ::mjx::make_utf8_format_args("first")).empty());
+            EXPECT_TRUE(::mjx::format_string("The {%0} and {%1}.", ::mjx::make_utf8_format_args("first")).empty());
+            EXPECT_EQ(::mjx::format_string(
+                "{%0} volunteers dedicated {%1} hours to clean up {%2} local parks.",
+                ::mjx::make_utf8_format_args("3", "50", "6")),
+                "3 volunteers dedicated 50 hours to clean up 6 local parks."
+            );
+            EXPECT_EQ(::mjx::format_string( // multi-byte arguments are copied byte for byte
+                "\xE3\x82\xAB\xE3\x82\xBF\xE3\x83\xAD\xE3\x82\xB0 {%0}",
+                ::mjx::make_utf8_format_args("\xE8\xA8\xAD\xE5\xAE\x9A.uts")),
+                "\xE3\x82\xAB\xE3\x82\xBF\xE3\x83\xAD\xE3\x82\xB0 \xE8\xA8\xAD\xE5\xAE\x9A.uts"
+            );
+        }
     } // namespace test
 } // namespace mjx
 
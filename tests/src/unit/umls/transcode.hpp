@@ -0,0 +1,63 @@
+// transcode.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_TRANSCODE_HPP_
+#define _TEST_UNIT_UMLS_TRANSCODE_HPP_
+#include <gtest/gtest.h>
+#include <mjstr/conversion.hpp>
+#include <umls/impl/transcode.hpp>
+
+namespace mjx {
+    namespace test {
+        inline unicode_string _Transcode(const char* const _Str, const bool _Validated) {
+            unicode_string _Result;
+            const size_t _Size = ::strlen(_Str);
+            if (!umls_impl::_Transcode_utf8_to_unicode(
+                _Result, reinterpret_cast<const byte_t*>(_Str), _Size, _Validated)) {
+                _Result.assign(L"<invalid>");
+            }
+
+            return _Result;
+        }
+
+        inline void _Expect_same_as_mjstr(const char* const _Str) {
+            const unicode_string& _Expected = ::mjx::to_unicode_string(utf8_string_view{_Str});
+            EXPECT_EQ(_Transcode(_Str, false), _Expected);
+            EXPECT_EQ(_Transcode(_Str, true), _Expected);
+            EXPECT_TRUE(umls_impl::_Validate_utf8(reinterpret_cast<const byte_t*>(_Str), ::strlen(_Str)));
+        }
+
+        TEST(transcode, ascii) {
+            _Expect_same_as_mjstr("");
+            _Expect_same_as_mjstr("short");
+            _Expect_same_as_mjstr("The catalog could not be opened because the file does not exist, try again later.");
+        }
+
+        TEST(transcode, multi_byte) {
+            // Cyrillic (2 bytes), CJK (3 bytes) and an emoji (4 bytes), mixed with ASCII runs
+            _Expect_same_as_mjstr("\xD0\x9A\xD0\xB0\xD1\x82\xD0\xB0\xD0\xBB\xD0\xBE\xD0\xB3 settings.uts");
+            _Expect_same_as_mjstr("\xE3\x82\xAB\xE3\x82\xBF\xE3\x83\xAD\xE3\x82\xB0 {%0} the file could not be opened");
+            _Expect_same_as_mjstr("The catalog could not be opened because the file does not exist \xF0\x9F\x98\x80.");
+        }
+
+        TEST(transcode, invalid) {
+            static constexpr const char* _Invalid[] = {
+                "The catalog could not be opened because \x80", // stray continuation byte
+                "The catalog could not be opened because \xC0\x80", // overlong encoding
+                "The catalog could not be opened because \xED\xA0\x80", // surrogate
+                "The catalog could not be opened because \xF4\x90\x80\x80", // beyond U+10FFFF
+                "The catalog could not be opened because \xE3\x82" // truncated sequence
+            };
+
+            for (const char* const _Str : _Invalid) {
+                EXPECT_EQ(_Transcode(_Str, false), L"<invalid>");
+                EXPECT_FALSE(umls_impl::_Validate_utf8(reinterpret_cast<const byte_t*>(_Str), ::strlen(_Str)));
+            }
+        }
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_TRANSCODE_HPP_
\ No newline at end of file
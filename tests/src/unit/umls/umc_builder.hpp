@@ -0,0 +1,223 @@
+// umc_builder.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _TEST_UNIT_UMLS_UMC_BUILDER_HPP_
+#define _TEST_UNIT_UMLS_UMC_BUILDER_HPP_
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+#include <mjfs/directory.hpp>
+#include <mjfs/file.hpp>
+#include <mjfs/file_stream.hpp>
+#include <mjfs/path.hpp>
+#include <mjfs/status.hpp>
+#include <mjstr/string.hpp>
+#include <mjstr/string_view.hpp>
+#include <umls/impl/tinywin.hpp>
+#include <vector>
+#include <xxhash/xxhash.h>
+
+namespace mjx {
+    namespace test {
+        inline void _Append_le_integer(byte_string& _Str, uint64_t _Value, const size_t _Size) {
+            for (size_t _Idx = 0; _Idx < _Size; ++_Idx) {
+                _Str.push_back(static_cast<byte_t>(_Value & 0xFF));
+                _Value >>= 8;
+            }
+        }
+
+        class _Umc_builder { // builds UMC images for the tests
+        public:
+            explicit _Umc_builder(const char* const _Language = "en-US", const uint32_t _Lcid = 0x0409)
+                : _Mylanguage(_Language), _Mylcid(_Lcid), _Myversioned(false), _Myversion(0), _Myencoding(0),
+                _Myids(false), _Mymessages() {}
+
+            _Umc_builder& _Version(const byte_t _Version, const byte_t _Encoding) {
+                // writes the version and the text encoding, the legacy header has neither
+                _Myversioned = true;
+                _Myversion   = _Version;
+                _Myencoding  = _Encoding;
+                return *this;
+            }
+
+            _Umc_builder& _Message(const char* const _Id, const char* const _Text) {
+                return _Message(_Id, _Id, _Text, ::strlen(_Text));
+            }
+
+            _Umc_builder& _Message(const char* const _Id, const wchar_t* const _Text) {
+                // the text is stored as wchar_t, as the native-width encodings require
+                return _Message(_Id, _Id, _Text, ::wcslen(_Text) * sizeof(wchar_t));
+            }
+
+            _Umc_builder& _Message(
+                const char* const _Id, const char* const _Hashed_id, const void* const _Text, const size_t _Size) {
+                // stores the message under the hash of _Hashed_id, which differs from _Id to simulate collisions
+                _Mymessages.push_back(_Umc_message{_Id, _Hashed_id,
+                    byte_string{static_cast<const byte_t*>(_Text), _Size}});
+                return *this;
+            }
+
+            _Umc_builder& _With_ids() {
+                // appends the UMI section with the original IDs
+                _Myids = true;
+                return *this;
+            }
+
+            byte_string _Build() const {
+                byte_string _Data;
+                byte_string _Blob;
+                if (_Myversioned) {
+                    _Data.append(reinterpret_cast<const byte_t*>("UMC"), 3);
+                    _Data.push_back(_Myversion);
+                    _Data.push_back(_Myencoding);
+                } else {
+                    _Data.append(reinterpret_cast<const byte_t*>("UMC\0"), 4);
+                }
+
+                const size_t _Language_size = ::strlen(_Mylanguage);
+                _Data.push_back(static_cast<byte_t>(_Language_size));
+                _Data.append(reinterpret_cast<const byte_t*>(_Mylanguage), _Language_size);
+                _Append_le_integer(_Data, _Mylcid, 4);
+                _Append_le_integer(_Data, _Mymessages.size(), 4);
+                for (const _Umc_message& _Msg : _Mymessages) {
+                    _Append_le_integer(_Data, ::XXH3_64bits(_Msg._Hashed_id, ::strlen(_Msg._Hashed_id)), 8);
+                    _Append_le_integer(_Data, _Blob.size(), 8);
+                    _Append_le_integer(_Data, _Msg._Text.size(), 4);
+                    _Blob.append(_Msg._Text);
+                }
+
+                _Data.append(_Blob);
+                if (_Myids) {
+                    _Append_id_section(_Data);
+                }
+
+                return _Data;
+            }
+
+        private:
+            struct _Umc_message {
+                const char* _Id;
+                const char* _Hashed_id;
+                byte_string _Text;
+            };
+
+            void _Append_id_section(byte_string& _Data) const {
+                // the records are sorted by the IDs in byte order
+                ::std::vector<const char*> _Ids;
+                for (const _Umc_message& _Msg : _Mymessages) {
+                    _Ids.push_back(_Msg._Id);
+                }
+
+                ::std::sort(_Ids.begin(), _Ids.end(), [](const char* const _Left, const char* const _Right) noexcept {
+                    return ::strcmp(_Left, _Right) < 0;
+                });
+
+                utf8_string _Pool;
+                byte_string _Records;
+                for (const char* const _Id : _Ids) {
+                    const size_t _Id_size = ::strlen(_Id);
+                    _Append_le_integer(_Records, ::XXH3_64bits(_Id, _Id_size), 8);
+                    _Append_le_integer(_Records, _Pool.size(), 4);
+                    _Append_le_integer(_Records, _Id_size, 4);
+                    _Pool.append(_Id, _Id_size);
+                }
+
+                _Data.append(reinterpret_cast<const byte_t*>("UMI\0"), 4);
+                _Append_le_integer(_Data, _Ids.size(), 4);
+                _Append_le_integer(_Data, _Pool.size(), 4);
+                _Data.append(_Records);
+                _Data.append(reinterpret_cast<const byte_t*>(_Pool.data()), _Pool.size());
+            }
+
+            const char* _Mylanguage;
+            uint32_t _Mylcid;
+            bool _Myversioned;
+            byte_t _Myversion;
+            byte_t _Myencoding;
+            bool _Myids;
+            ::std::vector<_Umc_message> _Mymessages;
+        };
+
+        class _Scoped_test_file { // writes a file used by a single test and deletes it afterwards
+        public:
+            explicit _Scoped_test_file(const path& _Target) : _Mytarget(_Target), _Mydir_created(false) {
+                const path& _Dir = _Target.parent_path();
+                if (!_Dir.empty() && !::mjx::exists(_Dir)) { // create the directory, remove it afterwards
+                    _Mydir_created = ::mjx::create_directory(_Dir);
+                }
+            }
+
+            ~_Scoped_test_file() noexcept {
+                ::mjx::delete_file(_Mytarget);
+                if (_Mydir_created) {
+                    ::mjx::remove_directory(_Mytarget.parent_path());
+                }
+            }
+
+            _Scoped_test_file()                                    = delete;
+            _Scoped_test_file(const _Scoped_test_file&)            = delete;
+            _Scoped_test_file& operator=(const _Scoped_test_file&) = delete;
+
+            const path& _Path() const noexcept {
+                return _Mytarget;
+            }
+
+            bool _Write(const byte_string_view _Data) const {
+                // creates the file or replaces its contents
+                file _File;
+                if (::mjx::exists(_Mytarget)) {
+                    if (!_File.open(_Mytarget, file_access::write) || !_File.resize(0)) {
+                        return false;
+                    }
+                } else if (!::mjx::create_file(_Mytarget, ::std::addressof(_File))) {
+                    return false;
+                }
+
+                file_stream _Stream(_File);
+                return _Stream.is_open() && _Stream.write(_Data.data(), _Data.size());
+            }
+
+        private:
+            path _Mytarget;
+            bool _Mydir_created;
+        };
+
+        class _Scoped_working_directory { // switches to a new temporary directory and back afterwards
+        public:
+            _Scoped_working_directory() : _Myold(::mjx::current_path()), _Mydir(), _Myswitched(false) {
+                wchar_t _Temp[MAX_PATH + 1];
+                const DWORD _Len = ::GetTempPathW(MAX_PATH + 1, _Temp);
+                if (_Len == 0 || _Len > MAX_PATH) { // no temporary directory, stay in the current one
+                    return;
+                }
+
+                wchar_t _Name[32];
+                ::swprintf(_Name, 32, L"umls_tests_%lu", static_cast<unsigned long>(::GetCurrentProcessId()));
+                _Mydir = path{_Temp} / _Name;
+                if (::mjx::exists(_Mydir) || ::mjx::create_directory(_Mydir)) {
+                    _Myswitched = ::mjx::current_path(_Mydir);
+                }
+            }
+
+            ~_Scoped_working_directory() noexcept {
+                if (_Myswitched) { // the directory is removed only if the tests left nothing behind
+                    ::mjx::current_path(_Myold);
+                    ::mjx::remove_directory(_Mydir);
+                }
+            }
+
+            _Scoped_working_directory(const _Scoped_working_directory&)            = delete;
+            _Scoped_working_directory& operator=(const _Scoped_working_directory&) = delete;
+
+        private:
+            path _Myold;
+            path _Mydir;
+            bool _Myswitched;
+        };
+    } // namespace test
+} // namespace mjx
+
+#endif // _TEST_UNIT_UMLS_UMC_BUILDER_HPP_
\ No newline at end of file